@@ -0,0 +1,88 @@
+require 'orocos'
+
+# Measures the computation time per cycle of the real RMLPositionTask (computation_time port), i.e. the complete cycle incl. port I/O and
+# debug outputs, on random point-to-point motions within the position limits of the default configuration. If the task supports cycle
+# tracing (cycle_tracing property), the time of the OTG stage is reported as well. The remainder is the overhead of the cycle around the
+# OTG algorithm (RMLTask::runSingleCycle()).
+#
+# Apart from cycle tracing, only ports and properties are used that exist since the first version of the task. To compare the cycle with
+# an older version (e.g. the former virtual hooks), run this script with the same seed against an installation of that version.
+#
+# Usage: ruby benchmark_cycle_overhead.rb [number of targets] [seed]
+
+Orocos.initialize
+Orocos.conf.load_dir('config')
+
+N_TARGETS = (ARGV[0] || 100).to_i
+SEED = (ARGV[1] || 1).to_i
+CYCLES_PER_TARGET = 300
+BUFFER_SIZE = 2 * CYCLES_PER_TARGET
+
+def print_stats(name, values)
+    if values.empty?
+        puts "#{name}: no samples"
+        return
+    end
+    mean = values.inject(:+) / values.size
+    puts format("%-26s mean %8.2f us   max %8.2f us   (%d cycles)", name, mean * 1e6, values.max * 1e6, values.size)
+end
+
+def joint_state(position)
+    state = Types.base.JointState.new
+    [:position, :speed, :effort, :raw, :acceleration].each { |f| state.send("#{f}=", Float::NAN) }
+    state.position = position
+    state
+end
+
+Orocos.run "trajectory_generation::RMLPositionTask" => "cycle_benchmark" do
+
+    task = Orocos::TaskContext.get "cycle_benchmark"
+    Orocos.conf.apply(task, ["default"], true)
+    tracing = task.has_property?("cycle_tracing")
+    task.cycle_tracing = true if tracing
+    task.configure
+    task.start
+
+    constraints = task.motion_constraints
+    computation_time_reader = task.computation_time.reader(:type => :buffer, :size => BUFFER_SIZE)
+    trace_reader = task.cycle_trace.reader(:type => :buffer, :size => BUFFER_SIZE) if tracing
+
+    current = Types.base.samples.Joints.new
+    current.names = constraints.names
+    constraints.elements.each { |c| current.elements << joint_state(0.5 * (c.min.position + c.max.position)) }
+    current.time = Types.base.Time.now
+    task.joint_state.writer.write(current)
+
+    target_writer = task.target.writer
+    rng = Random.new(SEED)
+    cycle_times = []
+    otg_times = []
+    remaining_times = []
+    N_TARGETS.times do
+        target = Types.base.commands.Joints.new
+        target.names = constraints.names
+        constraints.elements.each { |c| target.elements << joint_state(c.min.position + rng.rand * (c.max.position - c.min.position)) }
+        target.time = Types.base.Time.now
+        target_writer.write(target)
+
+        sleep CYCLES_PER_TARGET * task.cycle_time
+        while t = computation_time_reader.read_new
+            cycle_times << t
+        end
+        next if !tracing
+        while trace = trace_reader.read_new
+            otg = trace.stages.find { |s| s.name == "otg" }
+            next if !otg || otg.start.nan?
+            otg_times << otg.duration
+            remaining_times << trace.duration - otg.duration
+        end
+    end
+    task.stop
+
+    puts "RMLPositionTask, #{constraints.names.size} joints, cycle time #{task.cycle_time} s, #{N_TARGETS} targets (seed #{SEED})"
+    print_stats("cycle (computation_time)", cycle_times)
+    if tracing
+        print_stats("OTG stage", otg_times)
+        print_stats("cycle without OTG stage", remaining_times)
+    end
+end
@@ -0,0 +1,38 @@
+require 'pocolog'
+require 'json'
+
+# Converts the cycle traces in a pocolog log file (cycle_trace port, see cycle_tracing property) to the Chrome trace event format, which
+# can be viewed in chrome://tracing or Perfetto (https://ui.perfetto.dev). Each task becomes a thread, each cycle and each stage of a cycle
+# a complete event. Stages that have not been run in a cycle are skipped.
+#
+# Usage: ruby export_chrome_trace.rb <logfile> [output.json]
+
+if ARGV.empty?
+    puts "Usage: ruby export_chrome_trace.rb <logfile> [output.json]"
+    exit 1
+end
+
+output = ARGV[1] || File.basename(ARGV[0], ".log") + ".json"
+logfile = Pocolog::Logfiles.open(ARGV[0])
+
+events = []
+tid = 0
+logfile.streams.each do |stream|
+    next if stream.type.name != "/trajectory_generation/CycleTrace"
+    tid += 1
+    events << {"name" => "thread_name", "ph" => "M", "pid" => 1, "tid" => tid, "args" => {"name" => stream.name}}
+    stream.samples.each do |_, _, trace|
+        # Event time stamps are in microseconds
+        start = trace.start_time.tv_sec * 1e6 + trace.start_time.tv_usec
+        events << {"name" => "cycle", "ph" => "X", "pid" => 1, "tid" => tid, "ts" => start, "dur" => trace.duration * 1e6,
+                   "args" => {"time" => trace.time.to_f}}
+        trace.stages.each do |stage|
+            next if stage.start.nan?
+            events << {"name" => stage.name, "ph" => "X", "pid" => 1, "tid" => tid,
+                       "ts" => start + stage.start * 1e6, "dur" => stage.duration * 1e6}
+        end
+    end
+end
+
+File.write(output, JSON.generate("traceEvents" => events, "displayTimeUnit" => "ns"))
+puts "Wrote #{events.size} events of #{tid} tasks to #{output}"
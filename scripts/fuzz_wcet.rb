@@ -0,0 +1,232 @@
+require 'orocos'
+require 'yaml'
+require 'fileutils'
+
+# Randomized worst-case execution time (WCET) test of the trajectory generators. Each task runs on the simulated clock with wcet_tracking
+# enabled and receives random, edge-case heavy current states, targets and motion constraints (at, near and beyond the position limits,
+# tiny jerk, huge speeds, invalid values, near-singular orientations). The configuration (OTG backend, positional limits behavior, fallback)
+# is drawn at random as well. All random values are derived from one seed per run, so that a run can be repeated.
+#
+# After each run, the worst case of every code path (see wcet_stats port) is compared with the saved seeds. New worst cases are saved
+# to SEED_DIR together with the seed, the configuration and the OTG input that produced them.
+#
+# Usage: ruby fuzz_wcet.rb [runs]    Fuzz all tasks with the given number of random seeds (default 20)
+#        ruby fuzz_wcet.rb --replay  Replay the saved OTG inputs with the wcet_replay program (test/wcet_replay.cpp, path can be given
+#                                    in the environment variable WCET_REPLAY) and compare the computation times with the recorded ones.
+#                                    The inputs are not regenerated, so the replay does not depend on the task state or timing
+
+Orocos.initialize
+Orocos.conf.load_dir('config')
+
+SEED_DIR = "wcet_seeds"
+TARGETS_PER_RUN = 200
+MAX_CYCLES_PER_TARGET = 20
+CYCLE_TIMEOUT = 10.0
+WCET_REPLAY = ENV["WCET_REPLAY"] || "wcet_replay"
+REPLAY_REPETITIONS = 100
+SYNC_BEHAVIORS = [:PHASE_SYNCHRONIZATION_IF_POSSIBLE, :ONLY_TIME_SYNCHRONIZATION, :ONLY_PHASE_SYNCHRONIZATION, :NO_SYNCHRONIZATION]
+TASKS = {"position"           => "trajectory_generation::RMLPositionTask",
+         "velocity"           => "trajectory_generation::RMLVelocityTask",
+         "cartesian_position" => "trajectory_generation::RMLCartesianPositionTask",
+         "cartesian_velocity" => "trajectory_generation::RMLCartesianVelocityTask"}
+
+def joint_state(fields)
+    state = Types.base.JointState.new
+    [:position, :speed, :effort, :raw, :acceleration].each { |f| state.send("#{f}=", fields[f] || Float::NAN) }
+    state
+end
+
+# Random value that is concentrated on the edge cases of the interval [min,max]
+def edge_value(rng, min, max)
+    case rng.rand(10)
+    when 0 then max
+    when 1 then min
+    when 2 then max - 1e-9
+    when 3 then min + 1e-9
+    when 4 then max + 1e-3
+    when 5 then min - 1e3
+    when 6 then Float::NAN
+    else min + rng.rand * (max - min)
+    end
+end
+
+# Random scaling of a limit over 15 orders of magnitude, i.e. from tiny jerks to huge speeds
+def edge_scale(rng)
+    10.0 ** rng.rand(-9.0..6.0)
+end
+
+def edge_constraint(rng, default)
+    c = Types.joint_control_base.MotionConstraint.new
+    c.max = joint_state(:position => default.max.position, :speed => default.max.speed * edge_scale(rng),
+                        :acceleration => default.max.acceleration * edge_scale(rng))
+    c.min = joint_state(:position => default.min.position)
+    c.max_jerk = rng.rand(10) == 0 ? 0.0 : default.max_jerk * edge_scale(rng)
+    c
+end
+
+def joint_target(rng, constraints, velocity_based)
+    target = Types.joint_control_base.ConstrainedJointsCmd.new
+    target.names = constraints.names
+    target.motion_constraints.names = constraints.names
+    constraints.elements.each do |c|
+        if velocity_based
+            target.elements << joint_state(:speed => edge_value(rng, -c.max.speed, c.max.speed) * (rng.rand(5) == 0 ? 1e6 : 1))
+        else
+            target.elements << joint_state(:position => edge_value(rng, c.min.position, c.max.position),
+                                           :speed => rng.rand(3) == 0 ? edge_value(rng, -c.max.speed, c.max.speed) : 0.0)
+        end
+        target.motion_constraints.elements << (rng.rand(2) == 0 ? edge_constraint(rng, c) : c)
+    end
+    target.time = Types.base.Time.at(0)
+    target
+end
+
+def cartesian_target(rng, constraints, velocity_based)
+    c = constraints.elements
+    target = Types.base.samples.RigidBodyState.new
+    target.zero!
+    target.sourceFrame = "target"
+    target.targetFrame = "root"
+    if velocity_based
+        target.velocity         = Types.base.Vector3d.new(*(0..2).map { |i| edge_value(rng, -c[i].max.speed, c[i].max.speed) })
+        target.angular_velocity = Types.base.Vector3d.new(*(3..5).map { |i| edge_value(rng, -c[i].max.speed, c[i].max.speed) })
+    else
+        target.position = Types.base.Vector3d.new(*(0..2).map { |i| edge_value(rng, c[i].min.position, c[i].max.position) })
+        # Pitch close to +-90 degrees is the singularity of the internal euler angle representation
+        pitch = rng.rand(3) == 0 ? (Math::PI / 2 - 10.0 ** rng.rand(-9.0..-1.0)) * (rng.rand(2) == 0 ? 1 : -1) : edge_value(rng, -Math::PI, Math::PI)
+        target.orientation = Types.base.Quaterniond.from_euler(Types.base.Vector3d.new(edge_value(rng, -Math::PI, Math::PI), pitch,
+                                                                                        edge_value(rng, -Math::PI, Math::PI)), 2, 1, 0)
+    end
+    target.time = Types.base.Time.at(0)
+    target
+end
+
+def current_state(rng, task, cartesian)
+    c = task.motion_constraints.elements
+    if cartesian
+        state = Types.base.samples.RigidBodyStateSE3.new
+        state.zero!
+        state.pose.position = Types.base.Vector3d.new(*(0..2).map { |i| c[i].min.position + rng.rand * (c[i].max.position - c[i].min.position) })
+        state.pose.orientation = Types.base.Quaterniond.from_euler(Types.base.Vector3d.new(*(0..2).map { rng.rand(-1.0..1.0) }), 2, 1, 0)
+    else
+        state = Types.base.samples.Joints.new
+        state.names = task.motion_constraints.names
+        c.each { |e| state.elements << joint_state(:position => [e.max.position, e.min.position, e.min.position + rng.rand * (e.max.position - e.min.position)][rng.rand(3)]) }
+    end
+    state.time = Types.base.Time.at(0)
+    state
+end
+
+# Run one randomized sequence with the given seed on task and return the WCET statistics and the configuration of the OTG backend.
+# Returns nil if the task did not run all cycles in time
+def fuzz(task, type, seed)
+    rng = Random.new(seed)
+    cartesian = type.start_with?("cartesian")
+    velocity_based = type.end_with?("velocity")
+
+    Orocos.conf.apply(task, ["default"], true)
+    task.simulated_clock = true
+    task.wcet_tracking = true
+    task.otg_backend = [:OTG_BACKEND_REFLEXXES, :OTG_BACKEND_SCURVE][rng.rand(2)]
+    task.positional_limits_behavior = [:POSITIONAL_LIMITS_IGNORE, :POSITIONAL_LIMITS_ACTIVELY_PREVENT][rng.rand(2)]
+    task.otg_fallback = [:OTG_FALLBACK_NONE, :OTG_FALLBACK_INDEPENDENT, :OTG_FALLBACK_STOP][rng.rand(3)]
+    task.configure
+    task.start
+    config = {"otg_backend" => task.otg_backend.to_s, "positional_limits_behavior" => task.positional_limits_behavior.to_s,
+              "synchronization_behavior" => task.synchronization_behavior.to_s, "cycle_time" => task.getPeriod}
+
+    state_writer  = (cartesian ? task.cartesian_state : task.joint_state).writer
+    target_writer = (cartesian ? task.target : task.constrained_target).writer
+    cycle_reader  = task.actual_cycle_time.reader(:type => :buffer, :size => MAX_CYCLES_PER_TARGET + 1)
+    wcet_reader   = task.wcet_stats.reader
+
+    # The first cycle does not write the actual cycle time
+    task.step(1)
+    sleep 0.1
+    state_writer.write(current_state(rng, task, cartesian))
+
+    TARGETS_PER_RUN.times do
+        target_writer.write(cartesian ? cartesian_target(rng, task.motion_constraints, velocity_based) :
+                                        joint_target(rng, task.motion_constraints, velocity_based))
+        cycles = 1 + rng.rand(MAX_CYCLES_PER_TARGET)
+        task.step(cycles)
+        # Wait until all cycles have been run, so that the next target is not dropped. Errors without fallback stop the cycle, the
+        # remaining cycles of this target are not run then
+        timeout = Time.now + CYCLE_TIMEOUT
+        done = 0
+        while done < cycles && task.state != :RML_ERROR
+            done += 1 while cycle_reader.read_new
+            if Time.now > timeout
+                warn "#{type}: only #{done} of #{cycles} cycles have been run within #{CYCLE_TIMEOUT} s, discarding the run with seed #{seed}"
+                task.stop if task.running?
+                task.cleanup
+                return nil
+            end
+            sleep 0.001
+        end
+        # Continue with the next target
+        task.recover if task.state == :RML_ERROR
+    end
+
+    stats = wcet_reader.read
+    task.stop if task.running?
+    task.cleanup
+    stats && [stats, config]
+end
+
+def seed_file(type, path)
+    File.join(SEED_DIR, "#{type}_#{path}.yml")
+end
+
+def load_seed(file)
+    File.exist?(file) ? YAML.load_file(file) : nil
+end
+
+# Replay the OTG input of a saved seed with the wcet_replay program and return its output line ("result <r> mean <t> ms max <t> ms")
+def replay(seed)
+    input_file = File.join(SEED_DIR, "replay_input.txt")
+    File.open(input_file, "w") do |f|
+        seed["input"].each { |name, value| f.puts "#{name} #{Array(value).map { |v| v.to_f }.join(" ")}" }
+    end
+    mode = seed["task"].end_with?("velocity") ? "velocity" : "position"
+    backend = seed["otg_backend"] == "OTG_BACKEND_SCURVE" ? "scurve" : "reflexxes"
+    limits = seed["positional_limits_behavior"] == "POSITIONAL_LIMITS_ACTIVELY_PREVENT" ? "prevent" : "ignore"
+    sync = SYNC_BEHAVIORS.index((seed["synchronization_behavior"] || "PHASE_SYNCHRONIZATION_IF_POSSIBLE").to_sym) || 0
+    output = `#{WCET_REPLAY} #{mode} #{backend} #{limits} #{sync} #{seed["cycle_time"] || 0.01} #{input_file} #{REPLAY_REPETITIONS}`.strip
+    $?.success? ? output : "replay failed: #{output}"
+end
+
+if ARGV[0] == "--replay"
+    Dir.glob(File.join(SEED_DIR, "*.yml")).sort.each do |file|
+        seed = load_seed(file)
+        puts "#{seed["task"]} #{seed["path"]} (seed #{seed["seed"]}): recorded #{seed["max_computation_time"] * 1e3} ms (result #{seed["result"]}), now #{replay(seed)}"
+    end
+    exit
+end
+
+Orocos.run TASKS.map { |type, model| [model, "fuzz_#{type}"] }.to_h do
+
+    FileUtils.mkdir_p(SEED_DIR)
+    tasks = TASKS.keys.map { |type| [type, Orocos::TaskContext.get("fuzz_#{type}")] }.to_h
+
+    runs = (ARGV[0] || 20).to_i
+    runs.times do
+        seed = Random.new_seed % 2**32
+        tasks.each do |type, task|
+            stats, config = fuzz(task, type, seed)
+            next if !stats
+            stats.paths.each do |record|
+                next if record.cycles == 0
+                file = seed_file(type, record.path)
+                previous = load_seed(file)
+                next if previous && previous["max_computation_time"] >= record.max_computation_time
+                puts "#{type}: new worst case on path #{record.path}: #{record.max_computation_time * 1e3} ms (seed #{seed})"
+                File.open(file, "w") do |f|
+                    f.write(YAML.dump({"task" => type, "seed" => seed, "path" => record.path,
+                                       "max_computation_time" => record.max_computation_time, "cycles" => record.cycles,
+                                       "result" => record.result.to_s, "input" => record.input.to_simple_value}.merge(config)))
+                end
+            end
+        end
+    end
+end
@@ -0,0 +1,122 @@
+#include "ConstraintDerating.hpp"
+#include "Conversions.hpp"
+#include <cmath>
+
+namespace trajectory_generation{
+
+ConstraintDerating::ConstraintDerating() : active(false){
+}
+
+void ConstraintDerating::configure(const std::vector<std::string>& names, const DeratingConfig& cfg){
+    config = cfg;
+    layout.configure(names);
+    active = false;
+
+    const size_t n = names.size();
+    target.assign(n, 1);
+    factor.assign(n, 1);
+    base_speed.assign(n, base::NaN<double>());
+    base_acc.assign(n, base::NaN<double>());
+    base_jerk.assign(n, base::NaN<double>());
+    // Take over all limits in the first call
+    replaced.assign(n, true);
+    status.names = names;
+    status.factors.assign(n, 1);
+}
+
+ValidationStatus ConstraintDerating::setFactors(const DeratingFactors& sample, InputValidationError& error){
+    // Keep the capacity of the strings in error, see RMLTask::reportValidationError()
+    error.status = VALIDATION_OK;
+    error.name.clear();
+    error.value = base::NaN<double>();
+    if(sample.names.size() != sample.factors.size()){
+        error.status = VALIDATION_INVALID_SIZE;
+        error.value = sample.factors.size();
+        return error.status;
+    }
+
+    // Each configured element appears at most once in the sample, so all sample elements are known if all of them have been mapped
+    layout.update(sample.names);
+    size_t n_found = 0;
+    for(size_t i = 0; i < layout.size(); i++){
+        if(layout[i] < 0)
+            continue;
+        n_found++;
+        const double f = sample.factors[layout[i]];
+        if(!(f > 0 && f <= 1)){
+            error.status = VALIDATION_INVALID_DERATING_FACTOR;
+            error.name = layout.names()[i];
+            error.value = f;
+            return error.status;
+        }
+    }
+    if(n_found != sample.names.size()){
+        for(size_t i = 0; i < sample.names.size(); i++){
+            if(findName(layout.names(), sample.names[i]) < 0){
+                error.status = VALIDATION_UNKNOWN_NAME;
+                error.name = sample.names[i];
+                return error.status;
+            }
+        }
+    }
+
+    for(size_t i = 0; i < layout.size(); i++){
+        if(layout[i] >= 0)
+            target[i] = std::max(sample.factors[layout[i]], config.min_factor);
+    }
+    active = true;
+    return VALIDATION_OK;
+}
+
+void ConstraintDerating::limitsReplaced(){
+    replaced.assign(replaced.size(), true);
+}
+
+void ConstraintDerating::limitsReplaced(const joint_control_base::ConstrainedJointsCmd& target){
+    if(target.motion_constraints.empty())
+        return;
+    for(size_t i = 0; i < target.names.size(); i++){
+        const int idx = findName(layout.names(), target.names[i]);
+        if(idx >= 0)
+            replaced[idx] = true;
+    }
+}
+
+size_t ConstraintDerating::apply(RMLInputParameters& params, double* max_speed, const double dt){
+    if(!active)
+        return 0;
+
+    const double alpha = config.time_constant > 0 ? dt / (config.time_constant + dt) : 1;
+    double* max_acc  = params.MaxAccelerationVector->VecData;
+    double* max_jerk = params.MaxJerkVector->VecData;
+
+    size_t n_updated = 0;
+    for(size_t i = 0; i < target.size(); i++){
+        // Replaced limits become the new underated limits
+        const bool take_over = replaced[i];
+        if(take_over){
+            if(max_speed)
+                base_speed[i] = max_speed[i];
+            base_acc[i]  = max_acc[i];
+            base_jerk[i] = max_jerk[i];
+            replaced[i] = false;
+        }
+
+        factor[i] += alpha * (target[i] - factor[i]);
+        if(std::fabs(target[i] - factor[i]) < config.resolution)
+            factor[i] = target[i];
+        if(!take_over && std::fabs(factor[i] - status.factors[i]) < config.resolution &&
+           !(factor[i] == target[i] && status.factors[i] != target[i]))
+            continue;
+
+        status.factors[i] = factor[i];
+        if(max_speed)
+            max_speed[i] = base_speed[i] * factor[i];
+        max_acc[i]  = base_acc[i] * factor[i];
+        max_jerk[i] = base_jerk[i] * factor[i];
+        n_updated++;
+    }
+    return n_updated;
+}
+
+}
@@ -0,0 +1,67 @@
+#ifndef CONSTRAINT_DERATING_HPP
+#define CONSTRAINT_DERATING_HPP
+
+#include "trajectory_generationTypes.hpp"
+#include "NameLayoutCache.hpp"
+#include <ReflexxesAPI.h>
+#include <joint_control_base/ConstrainedJointsCmd.hpp>
+
+namespace trajectory_generation{
+
+/** Scales the max. speed, acceleration and jerk in the RML input parameters with per-element derating factors, e.g. computed from the
+ *  temperature or current of the drives.
+ *
+ *  Incoming factors are smoothed by a first-order filter. The RML input parameters are only modified for elements whose smoothed factor
+ *  changed by more than the configured resolution. The underated limits of each element are taken from the RML input parameters
+ *  themselves: After configure() and whenever the owner reports via limitsReplaced() that it has written new limits (e.g. the motion
+ *  constraints of a constrained target), the next apply() call uses the current limits as the new underated limits. Thus, derating also
+ *  applies to the motion constraints of constrained targets.*/
+class ConstraintDerating{
+public:
+    ConstraintDerating();
+
+    /** Set the element names (in the order of the RML input parameters) and reset all factors to 1. Allocates memory, so call this
+     *  only at configuration time*/
+    void configure(const std::vector<std::string>& names, const DeratingConfig& config);
+
+    /** Set new target factors for the elements in the given sample. Elements that are not contained keep their target factor.
+     *  Returns VALIDATION_OK or the reason for the rejection of the sample. The target factors are not modified in the latter case.*/
+    ValidationStatus setFactors(const DeratingFactors& sample, InputValidationError& error);
+
+    /** The limits of all elements in the RML input parameters have been replaced, e.g. by the default motion constraints*/
+    void limitsReplaced();
+
+    /** The limits of the elements of the given target have been replaced by its motion constraints. Does nothing if the target
+     *  has no motion constraints*/
+    void limitsReplaced(const joint_control_base::ConstrainedJointsCmd& target);
+
+    /** Advance the filter by dt seconds and write the derated limits to params. Returns the number of elements that have been updated.
+     *  Does nothing until the first valid factors have been received.*/
+    size_t apply(RMLPositionInputParameters& params, const double dt){
+        return apply(params, params.MaxVelocityVector->VecData, dt);
+    }
+    size_t apply(RMLVelocityInputParameters& params, const double dt){
+        return apply(params, 0, dt);
+    }
+
+    /** Currently applied factors of all elements*/
+    const DeratingFactors& getStatus() const {return status;}
+
+protected:
+    DeratingConfig config;
+    NameLayoutCache layout;
+    bool active;
+    std::vector<double> target;
+    std::vector<double> factor;        /** Smoothed factors*/
+    std::vector<double> base_speed;    /** Underated limits*/
+    std::vector<double> base_acc;
+    std::vector<double> base_jerk;
+    std::vector<bool> replaced;        /** Elements whose limits have to be taken over as underated limits in the next apply() call*/
+    DeratingFactors status;
+
+    size_t apply(RMLInputParameters& params, double* max_speed, const double dt);
+};
+
+}
+
+#endif
@@ -1,5 +1,5 @@
 #include "Conversions.hpp"
-#include <base-logging/Logging.hpp>
+#include "FixedSizeConversions.hpp"
 
 using namespace joint_control_base;
 
@@ -47,6 +47,35 @@ void rmlTypes2InputParams(const RMLVelocityInputParameters &in, ReflexxesInputPa
     rmlTypes2InputParams((RMLInputParameters&)in, out);
 }
 
+void inputParams2RmlTypes(const ReflexxesInputParameters& in, RMLInputParameters& out){
+    uint n_dof = out.GetNumberOfDOFs();
+    for(uint i = 0; i < n_dof; i++)
+        out.SelectionVector->VecData[i] = in.selection_vector[i] != 0;
+    memcpy(out.CurrentPositionVector->VecData,     in.current_position_vector.data(),     sizeof(double) * n_dof);
+    memcpy(out.CurrentVelocityVector->VecData,     in.current_velocity_vector.data(),     sizeof(double) * n_dof);
+    memcpy(out.CurrentAccelerationVector->VecData, in.current_acceleration_vector.data(), sizeof(double) * n_dof);
+    memcpy(out.MaxAccelerationVector->VecData,     in.max_acceleration_vector.data(),     sizeof(double) * n_dof);
+    memcpy(out.MaxJerkVector->VecData,             in.max_jerk_vector.data(),             sizeof(double) * n_dof);
+    memcpy(out.TargetVelocityVector->VecData,      in.target_velocity_vector.data(),      sizeof(double) * n_dof);
+    out.MinimumSynchronizationTime = in.min_synchronization_time;
+#ifdef USING_REFLEXXES_TYPE_IV
+    memcpy(out.MaxPositionVector->VecData, in.max_position_vector.data(), sizeof(double) * n_dof);
+    memcpy(out.MinPositionVector->VecData, in.min_position_vector.data(), sizeof(double) * n_dof);
+    out.OverrideValue = in.override_value;
+#endif
+}
+
+void inputParams2RmlTypes(const ReflexxesInputParameters& in, RMLPositionInputParameters& out){
+    uint n_dof = out.GetNumberOfDOFs();
+    inputParams2RmlTypes(in, (RMLInputParameters&)out);
+    memcpy(out.MaxVelocityVector->VecData,    in.max_velocity_vector.data(),    sizeof(double) * n_dof);
+    memcpy(out.TargetPositionVector->VecData, in.target_position_vector.data(), sizeof(double) * n_dof);
+}
+
+void inputParams2RmlTypes(const ReflexxesInputParameters& in, RMLVelocityInputParameters& out){
+    inputParams2RmlTypes(in, (RMLInputParameters&)out);
+}
+
 void rmlTypes2OutputParams(const RMLOutputParameters &in, ReflexxesOutputParameters& out){
     uint n_dof = in.GetNumberOfDOFs();
     memcpy(out.new_position_vector.data(),     in.NewPositionVector->VecData,     sizeof(double) * n_dof);
@@ -76,34 +105,108 @@ void rmlTypes2OutputParams(const RMLVelocityOutputParameters &in, ReflexxesOutpu
     memcpy(out.position_values_at_target_velocity.data(), in.PositionValuesAtTargetVelocity->VecData, sizeof(double) * n_dof);
 }
 
-void jointState2RmlTypes(const base::samples::Joints& joint_state, const std::vector<std::string> &names, const RMLFlags& flags, RMLInputParameters& params){
+const char* CARTESIAN_DOF_NAMES[6] = {"x", "y", "z", "yaw", "pitch", "roll"};
+
+int findName(const std::vector<std::string>& names, const std::string& name){
+    for(size_t i = 0; i < names.size(); i++)
+        if(names[i] == name)
+            return i;
+    return -1;
+}
+
+static ValidationStatus reject(const ValidationStatus status, const std::string& name, const double value, InputValidationError& error){
+    error.status = status;
+    error.name   = name;
+    error.value  = value;
+    return status;
+}
+
+void positionLimits(const MotionConstraints& constraints, std::vector<double>& min_position, std::vector<double>& max_position){
+    min_position.resize(constraints.size());
+    max_position.resize(constraints.size());
+    for(size_t i = 0; i < constraints.size(); i++){
+        min_position[i] = base::isNaN(constraints[i].min.position) ? -base::infinity<double>() : constraints[i].min.position;
+        max_position[i] = base::isNaN(constraints[i].max.position) ?  base::infinity<double>() : constraints[i].max.position;
+    }
+}
+
+ValidationStatus jointState2RmlTypes(const base::samples::Joints& joint_state, NameLayoutCache& layout, const PositionalLimitsBehavior behavior,
+                                     const std::vector<double>& min_position, const std::vector<double>& max_position,
+                                     RMLInputParameters& params, ViolationMask& violations, InputValidationError& error){
+    const std::vector<std::string>& names = layout.names();
+    violations.clear();
+    if(joint_state.names.size() != joint_state.elements.size())
+        return reject(VALIDATION_INVALID_SIZE, "", joint_state.elements.size(), error);
+    if(!layout.update(joint_state.names))
+        return reject(VALIDATION_MISSING_ELEMENT, names[layout.firstMissing()], base::NaN<double>(), error);
+
     for(size_t i = 0; i < names.size(); i++){
-        try{
-            const base::JointState &state = joint_state.getElementByName(names[i]);
-            if(!state.hasPosition()){
-                LOG_ERROR("Element %s of joint state does not have a valid position entry", names[i].c_str());
-                throw std::invalid_argument("Invalid joint state");
-            }
-#ifdef USING_REFLEXXES_TYPE_IV
-            if(flags.PositionalLimitsBehavior == POSITIONAL_LIMITS_ACTIVELY_PREVENT ||
-               flags.PositionalLimitsBehavior == POSITIONAL_LIMITS_ERROR_MSG_ONLY){
-                if(state.position > params.MaxPositionVector->VecData[i] ||
-                   state.position < params.MinPositionVector->VecData[i]){
-                    LOG_ERROR("Position of joint %s is outside joint limits, Upper: %f, Lower: %f, Actual: %f",
-                              names[i].c_str(), params.MaxPositionVector->VecData[i], params.MinPositionVector->VecData[i], state.position);
-                    throw std::invalid_argument("Invalid joint state");
-                }
-            }
-#endif
-            params.CurrentPositionVector->VecData[i]     = state.position;
-            params.CurrentVelocityVector->VecData[i]     = 0;
-            params.CurrentAccelerationVector->VecData[i] = 0;
+        const base::JointState &state = joint_state.elements[layout[i]];
+        if(!state.hasPosition())
+            return reject(VALIDATION_INVALID_POSITION, names[i], state.position, error);
+        params.CurrentPositionVector->VecData[i]     = state.position;
+        params.CurrentVelocityVector->VecData[i]     = 0;
+        params.CurrentAccelerationVector->VecData[i] = 0;
+    }
+
+    if(behavior != POSITIONAL_LIMITS_IGNORE){
+        checkLimits(min_position.data(), max_position.data(), params.CurrentPositionVector->VecData, names.size(), violations);
+        for(size_t i = 0; i < names.size() && violations.any(); i++){
+            if(violations.test(i))
+                return reject(VALIDATION_POSITION_LIMITS, names[i], params.CurrentPositionVector->VecData[i], error);
+        }
+    }
+    return VALIDATION_OK;
+}
+
+bool blendJointState(const base::samples::Joints& joint_state, NameLayoutCache& layout, const StateFeedbackConfig& config,
+                     const double age, const PositionalLimitsBehavior behavior, const std::vector<double>& min_position,
+                     const std::vector<double>& max_position, RMLInputParameters& params){
+    if(joint_state.names.size() != joint_state.elements.size() || !layout.update(joint_state.names))
+        return false;
+    for(size_t i = 0; i < layout.size(); i++){
+        if(!joint_state.elements[layout[i]].hasPosition())
+            return false;
+    }
+
+    for(size_t i = 0; i < layout.size(); i++){
+        const base::JointState &state = joint_state.elements[layout[i]];
+        double& position = params.CurrentPositionVector->VecData[i];
+        double& velocity = params.CurrentVelocityVector->VecData[i];
+        double& acceleration = params.CurrentAccelerationVector->VecData[i];
+        double measured_position = state.position;
+        if(state.hasSpeed()){
+            measured_position += state.speed * age;
+            velocity += config.velocity_gain * (state.speed - velocity);
+            // Keep the acceleration consistent with the corrected velocity. Without measurement, blend towards zero (steady motion)
+            const double measured_acceleration = state.hasAcceleration() ? state.acceleration : 0.0;
+            acceleration += config.velocity_gain * (measured_acceleration - acceleration);
+        }
+        const double deviation = measured_position - position;
+        if(fabs(deviation) > config.deadband)
+            position += config.position_gain * deviation;
+    }
+
+    if(behavior == POSITIONAL_LIMITS_IGNORE)
+        return true;
+    // Measurement noise or extrapolation must not push the interpolator state beyond the position limits. At a limit, the element
+    // must not move further outwards.
+    for(size_t i = 0; i < layout.size(); i++){
+        double& position = params.CurrentPositionVector->VecData[i];
+        double& velocity = params.CurrentVelocityVector->VecData[i];
+        double& acceleration = params.CurrentAccelerationVector->VecData[i];
+        if(position >= max_position[i]){
+            position = max_position[i];
+            velocity = std::min(velocity, 0.0);
+            acceleration = std::min(acceleration, 0.0);
         }
-        catch(const base::samples::Joints::InvalidName &e){
-            LOG_ERROR("Element %s has been configured in motion constraints, but is not available in joint state", e.name.c_str());
-            throw e;
+        else if(position <= min_position[i]){
+            position = min_position[i];
+            velocity = std::max(velocity, 0.0);
+            acceleration = std::max(acceleration, 0.0);
         }
     }
+    return true;
 }
 
 void rmlTypes2JointState(const RMLInputParameters& params, base::samples::Joints& joint_state){
@@ -115,34 +218,63 @@ void rmlTypes2JointState(const RMLInputParameters& params, base::samples::Joints
     }
 }
 
-void cartesianState2RmlTypes(const base::samples::RigidBodyStateSE3& cartesian_state, RMLInputParameters& params){
+/** Check the given Cartesian vector for NaN entries and fill error with the first invalid DOF*/
+static ValidationStatus validateCartesian(const CartesianVector& v, const ValidationStatus status, InputValidationError& error){
+    for(uint i = 0; i < CARTESIAN_DOF; i++){
+        if(base::isNaN(v(i)))
+            return reject(status, CARTESIAN_DOF_NAMES[i], v(i), error);
+    }
+    return VALIDATION_OK;
+}
+
+ValidationStatus cartesianState2RmlTypes(const base::samples::RigidBodyStateSE3& cartesian_state, RMLInputParameters& params, InputValidationError& error){
     if(!cartesian_state.hasValidPose()){
-        LOG_ERROR("Cartesian state has invalid position and/or orientation.");
-        throw std::invalid_argument("Invalid cartesian state");
+        const Eigen::Vector4d q = cartesian_state.pose.orientation.coeffs();
+        for(uint i = 0; i < 3; i++){
+            if(base::isNaN(cartesian_state.pose.position(i)))
+                return reject(VALIDATION_INVALID_POSITION, CARTESIAN_DOF_NAMES[i], cartesian_state.pose.position(i), error);
+        }
+        return reject(VALIDATION_INVALID_POSITION, "orientation", hasNaN(q) ? base::NaN<double>() : q.norm(), error);
     }
-    base::Vector3d euler = quaternion2Euler(cartesian_state.pose.orientation);
-    memcpy(params.CurrentPositionVector->VecData,   cartesian_state.pose.position.data(), sizeof(double)*3);
-    memcpy(params.CurrentPositionVector->VecData+3, euler.data(),                    sizeof(double)*3);
-    memset(params.CurrentVelocityVector->VecData,   0,                               sizeof(double)*6);
-    memset(params.CurrentVelocityVector->VecData,   0,                               sizeof(double)*6);
+    rmlVector<CARTESIAN_DOF>(*params.CurrentPositionVector) << cartesian_state.pose.position, quaternion2Euler(cartesian_state.pose.orientation);
+    rmlVector<CARTESIAN_DOF>(*params.CurrentVelocityVector).setZero();
+    rmlVector<CARTESIAN_DOF>(*params.CurrentAccelerationVector).setZero();
+    return VALIDATION_OK;
 }
 
 void rmlTypes2CartesianState(const RMLInputParameters& params, base::samples::RigidBodyStateSE3& cartesian_state){
-    base::Vector3d euler;
-    memcpy(cartesian_state.pose.position.data(),         params.CurrentPositionVector->VecData,   sizeof(double)*3);
-    memcpy(euler.data(),                            params.CurrentPositionVector->VecData+3, sizeof(double)*3);
-    memcpy(cartesian_state.twist.linear.data(),         params.CurrentVelocityVector->VecData,   sizeof(double)*3);
-    memcpy(cartesian_state.twist.angular.data(), params.CurrentVelocityVector->VecData+3, sizeof(double)*3);
-    cartesian_state.pose.orientation = euler2Quaternion(euler);
+    const Eigen::Map<CartesianVector> pos = rmlVector<CARTESIAN_DOF>(*params.CurrentPositionVector);
+    const Eigen::Map<CartesianVector> vel = rmlVector<CARTESIAN_DOF>(*params.CurrentVelocityVector);
+    cartesian_state.pose.position    = pos.head<3>();
+    cartesian_state.pose.orientation = euler2Quaternion(pos.tail<3>());
+    cartesian_state.twist.linear     = vel.head<3>();
+    cartesian_state.twist.angular    = vel.tail<3>();
+}
+
+bool validateStateFeedbackConfig(const StateFeedbackConfig& config){
+    // Negated comparisons, so that NaN values are rejected as well
+    return !(config.position_gain < 0 || config.position_gain > 1 || base::isNaN(config.position_gain) ||
+             config.velocity_gain < 0 || config.velocity_gain > 1 || base::isNaN(config.velocity_gain) ||
+             !(config.deadband >= 0) || !(config.latency >= 0) || !(config.max_extrapolation >= 0));
+}
+
+ValidationStatus validateMotionConstraint(const MotionConstraint& constraint, const std::string& name, InputValidationError& error){
+    // Negated comparisons, so that NaN values are rejected as well
+    if(!(constraint.max.speed > 0))
+        return reject(VALIDATION_INVALID_MAX_SPEED, name, constraint.max.speed, error);
+    if(!(constraint.max.acceleration > 0))
+        return reject(VALIDATION_INVALID_MAX_ACCELERATION, name, constraint.max.acceleration, error);
+    if(!(constraint.max_jerk > 0))
+        return reject(VALIDATION_INVALID_MAX_JERK, name, constraint.max_jerk, error);
+#ifdef USING_REFLEXXES_TYPE_IV
+    if(!(constraint.min.position < constraint.max.position))
+        return reject(VALIDATION_INVALID_POSITION_LIMITS, name, constraint.min.position, error);
+#endif
+    return VALIDATION_OK;
 }
 
 void motionConstraint2RmlTypes(const MotionConstraint& constraint, const uint idx, RMLInputParameters& params){
-    // Check if constraints are ok, e.g. speed > 0 etc.
-    constraint.validateVelocityLimit();
-    constraint.validateAccelerationLimit();
-    constraint.validateJerkLimit();
 #ifdef USING_REFLEXXES_TYPE_IV
-    constraint.validatePositionLimits();
     params.MaxPositionVector->VecData[idx] = constraint.max.position;
     params.MinPositionVector->VecData[idx] = constraint.min.position;
 #endif
@@ -160,6 +292,14 @@ void motionConstraint2RmlTypes(const MotionConstraint& constraint, const uint id
 }
 
 void rmlTypes2Command(const RMLPositionOutputParameters& params, base::commands::Joints& command){
+    rmlTypes2PositionCommand(params, command);
+}
+
+void rmlTypes2Command(const RMLPositionOutputParameters& params, base::samples::RigidBodyStateSE3& command){
+    rmlTypes2PositionCommand(params, command);
+}
+
+void rmlTypes2PositionCommand(const RMLOutputParameters& params, base::commands::Joints& command){
     uint n_dof = params.GetNumberOfDOFs();
     command.resize(n_dof);
     for(size_t i = 0; i < n_dof; i++){
@@ -169,13 +309,19 @@ void rmlTypes2Command(const RMLPositionOutputParameters& params, base::commands:
     }
 }
 
-void rmlTypes2Command(const RMLPositionOutputParameters& params, base::samples::RigidBodyStateSE3& command){
-    base::Vector3d euler;
-    memcpy(command.pose.position.data(),         params.NewPositionVector->VecData,   sizeof(double)*3);
-    memcpy(euler.data(),                    params.NewPositionVector->VecData+3, sizeof(double)*3);
-    memcpy(command.twist.linear.data(),         params.NewVelocityVector->VecData,   sizeof(double)*3);
-    memcpy(command.twist.angular.data(), params.NewVelocityVector->VecData+3, sizeof(double)*3);
-    command.pose.orientation = euler2Quaternion(euler);
+void rmlTypes2PositionCommand(const RMLOutputParameters& params, base::samples::RigidBodyStateSE3& command){
+    const Eigen::Map<CartesianVector> pos = rmlVector<CARTESIAN_DOF>(*params.NewPositionVector);
+    const Eigen::Map<CartesianVector> vel = rmlVector<CARTESIAN_DOF>(*params.NewVelocityVector);
+    command.pose.position    = pos.head<3>();
+    command.pose.orientation = euler2Quaternion(pos.tail<3>());
+    command.twist.linear     = vel.head<3>();
+    command.twist.angular    = vel.tail<3>();
+}
+
+void rmlTypes2PositionCommand(const RMLOutputParameters& params, base::samples::RigidBodyStateSE3& command, base::samples::RigidBodyStateSE3& current_sample){
+    rmlTypes2PositionCommand(params, command);
+    current_sample.pose  = command.pose;
+    current_sample.twist = command.twist;
 }
 
 void rmlTypes2Command(const RMLVelocityOutputParameters& params, base::commands::Joints& command){
@@ -188,87 +334,179 @@ void rmlTypes2Command(const RMLVelocityOutputParameters& params, base::commands:
 }
 
 void rmlTypes2Command(const RMLVelocityOutputParameters& params, base::samples::RigidBodyStateSE3& command){
-    memcpy(command.twist.linear.data(),         params.NewVelocityVector->VecData,       sizeof(double)*3);
-    memcpy(command.twist.angular.data(),        params.NewVelocityVector->VecData+3,     sizeof(double)*3);
-    memcpy(command.acceleration.linear.data(),  params.NewAccelerationVector->VecData,   sizeof(double)*3);
-    memcpy(command.acceleration.angular.data(), params.NewAccelerationVector->VecData+3, sizeof(double)*3);
+    const Eigen::Map<CartesianVector> vel = rmlVector<CARTESIAN_DOF>(*params.NewVelocityVector);
+    const Eigen::Map<CartesianVector> acc = rmlVector<CARTESIAN_DOF>(*params.NewAccelerationVector);
+    command.twist.linear         = vel.head<3>();
+    command.twist.angular        = vel.tail<3>();
+    command.acceleration.linear  = acc.head<3>();
+    command.acceleration.angular = acc.tail<3>();
 }
 
-void target2RmlTypes(const ConstrainedJointsCmd& target, const MotionConstraints& default_constraints, RMLPositionInputParameters& params){
-    // Set selection vector to false. Select individual elements below
-    memset(params.SelectionVector->VecData, false, params.GetNumberOfDOFs());
+/** Entries of a joint target that have to be valid*/
+enum JointTargetMode{
+    TARGET_POSITION, /** Position based OTG: positions*/
+    TARGET_SPEED,    /** Velocity based OTG: speeds*/
+    TARGET_MIXED     /** Mixed OTG: position or speed, depending on the element*/
+};
+
+/** Validate a joint target: all names have to be configured in the default constraints, all positions (position based OTG)
+ *  or speeds (velocity based OTG) have to be valid and all given motion constraints have to be valid after applying the defaults*/
+static ValidationStatus validateJointTarget(const ConstrainedJointsCmd& target, const MotionConstraints& default_constraints,
+                                           const JointTargetMode mode, InputValidationError& error){
+    if(target.names.size() != target.elements.size())
+        return reject(VALIDATION_INVALID_SIZE, "", target.elements.size(), error);
+    if(!target.motion_constraints.empty() && target.motion_constraints.size() != target.size())
+        return reject(VALIDATION_INVALID_SIZE, "", target.motion_constraints.size(), error);
+
     for(size_t i = 0; i < target.size(); i++){
-        try{
-            size_t idx = default_constraints.mapNameToIndex(target.names[i]);
-            target2RmlTypes(target[i].position, target[i].speed, idx, params);
-            if(!target.motion_constraints.empty()){
-                MotionConstraint constraint = target.motion_constraints[i];
-                constraint.applyDefaultIfUnset(default_constraints[idx]);
-                motionConstraint2RmlTypes(constraint, idx, params);
-            }
+        const int idx = findName(default_constraints.names, target.names[i]);
+        if(idx < 0)
+            return reject(VALIDATION_UNKNOWN_NAME, target.names[i], base::NaN<double>(), error);
+        if(mode == TARGET_POSITION && base::isNaN(target[i].position))
+            return reject(VALIDATION_INVALID_POSITION, target.names[i], target[i].position, error);
+        if(mode == TARGET_SPEED && base::isNaN(target[i].speed))
+            return reject(VALIDATION_INVALID_SPEED, target.names[i], target[i].speed, error);
+        if(mode == TARGET_MIXED && base::isNaN(target[i].position) && base::isNaN(target[i].speed))
+            return reject(VALIDATION_INVALID_SPEED, target.names[i], target[i].speed, error);
+        if(!target.motion_constraints.empty()){
+            MotionConstraint constraint = target.motion_constraints[i];
+            constraint.applyDefaultIfUnset(default_constraints[idx]);
+            const ValidationStatus status = validateMotionConstraint(constraint, target.names[i], error);
+            if(status != VALIDATION_OK)
+                return status;
         }
-        catch(const MotionConstraints::InvalidName &e){
-            LOG_ERROR("Joint '%s' is in target vector but has not been configured in motion constraints", e.name.c_str());
-            throw e;
+    }
+    return VALIDATION_OK;
+}
+
+ValidationStatus target2RmlTypes(const ConstrainedJointsCmd& target, const MotionConstraints& default_constraints,
+                                 RMLPositionInputParameters& params, InputValidationError& error, const bool merge){
+    const ValidationStatus status = validateJointTarget(target, default_constraints, TARGET_POSITION, error);
+    if(status != VALIDATION_OK)
+        return status;
+
+    // Set selection vector to false. Select individual elements below
+    if(!merge)
+        memset(params.SelectionVector->VecData, false, params.GetNumberOfDOFs());
+    for(size_t i = 0; i < target.size(); i++){
+        const int idx = findName(default_constraints.names, target.names[i]);
+        target2RmlTypes(target[i].position, target[i].speed, idx, params);
+        if(!target.motion_constraints.empty()){
+            MotionConstraint constraint = target.motion_constraints[i];
+            constraint.applyDefaultIfUnset(default_constraints[idx]);
+            motionConstraint2RmlTypes(constraint, idx, params);
         }
     }
+    return VALIDATION_OK;
 }
 
-void target2RmlTypes(const ConstrainedJointsCmd& target, const MotionConstraints& default_constraints, RMLVelocityInputParameters& params){
+ValidationStatus target2RmlTypes(const ConstrainedJointsCmd& target, const MotionConstraints& default_constraints,
+                                 RMLVelocityInputParameters& params, InputValidationError& error, const bool merge){
+    const ValidationStatus status = validateJointTarget(target, default_constraints, TARGET_SPEED, error);
+    if(status != VALIDATION_OK)
+        return status;
+
     // Set selection vector to false. Select individual elements below
-    memset(params.SelectionVector->VecData, false, params.GetNumberOfDOFs());
+    if(!merge)
+        memset(params.SelectionVector->VecData, false, params.GetNumberOfDOFs());
+    for(size_t i = 0; i < target.size(); i++){
+        const int idx = findName(default_constraints.names, target.names[i]);
+        target2RmlTypes(target[i].speed, idx, params);
+        if(!target.motion_constraints.empty()){
+            MotionConstraint constraint = target.motion_constraints[i];
+            constraint.applyDefaultIfUnset(default_constraints[idx]);
+            motionConstraint2RmlTypes(constraint, idx, params);
+        }
+    }
+    return VALIDATION_OK;
+}
+
+ValidationStatus target2RmlTypes(const ConstrainedJointsCmd& target, const MotionConstraints& default_constraints,
+                                 RMLPositionInputParameters& pos_params, RMLVelocityInputParameters& vel_params, InputValidationError& error,
+                                 const bool merge){
+    const ValidationStatus status = validateJointTarget(target, default_constraints, TARGET_MIXED, error);
+    if(status != VALIDATION_OK)
+        return status;
+
+    // Set selection vectors to false. Select individual elements below, each one either for position or for velocity based OTG
+    if(!merge){
+        memset(pos_params.SelectionVector->VecData, false, pos_params.GetNumberOfDOFs());
+        memset(vel_params.SelectionVector->VecData, false, vel_params.GetNumberOfDOFs());
+    }
     for(size_t i = 0; i < target.size(); i++){
-        try{
-            size_t idx = default_constraints.mapNameToIndex(target.names[i]);
-            target2RmlTypes(target[i].speed, idx, params);
-            if(!target.motion_constraints.empty()){
-                MotionConstraint constraint = target.motion_constraints[i];
-                constraint.applyDefaultIfUnset(default_constraints[idx]);
-                motionConstraint2RmlTypes(constraint, idx, params);
-            }
+        const int idx = findName(default_constraints.names, target.names[i]);
+        // Deselect the element in the other mode, it might have been selected there by a previous target (merge only)
+        if(!base::isNaN(target[i].position)){
+            target2RmlTypes(target[i].position, target[i].speed, idx, pos_params);
+            vel_params.SelectionVector->VecData[idx] = false;
         }
-        catch(const MotionConstraints::InvalidName &e){
-            LOG_ERROR("Joint '%s' is in target vector but has not been configured in motion constraints", e.name.c_str());
-            throw e;
+        else{
+            target2RmlTypes(target[i].speed, idx, vel_params);
+            pos_params.SelectionVector->VecData[idx] = false;
+        }
+        if(!target.motion_constraints.empty()){
+            MotionConstraint constraint = target.motion_constraints[i];
+            constraint.applyDefaultIfUnset(default_constraints[idx]);
+            motionConstraint2RmlTypes(constraint, idx, pos_params);
         }
     }
+    return VALIDATION_OK;
 }
 
-void target2RmlTypes(const base::samples::RigidBodyStateSE3& target, RMLPositionInputParameters& params){
-    base::Vector3d euler = quaternion2Euler(target.pose.orientation);
-    for(int i = 0; i < 3; i++)
-        target2RmlTypes(target.pose.position(i), target.twist.linear(i), i, params);
-    for(int i = 0; i < 3; i++)
-        target2RmlTypes(euler(i), target.twist.angular(i), i+3, params);
+/** Both parts of a Cartesian vector, for error reporting only*/
+static CartesianVector cartesianVector(const base::Vector3d& head, const base::Vector3d& tail){
+    CartesianVector v;
+    v << head, tail;
+    return v;
 }
 
-void target2RmlTypes(const base::samples::RigidBodyStateSE3& target, RMLVelocityInputParameters& params){
-    for(int i = 0; i < 3; i++)
-        target2RmlTypes(target.twist.linear(i), i, params);
-    for(int i = 0; i < 3; i++)
-        target2RmlTypes(target.twist.angular(i), i+3, params);
+ValidationStatus target2RmlTypes(const base::samples::RigidBodyStateSE3& target, RMLPositionInputParameters& params, InputValidationError& error){
+    const base::Vector3d euler = quaternion2Euler(target.pose.orientation);
+    if(!fixedTarget2RmlTypes<CARTESIAN_DOF>(target.pose.position, euler, target.twist.linear, target.twist.angular, params))
+        return validateCartesian(cartesianVector(target.pose.position, euler), VALIDATION_INVALID_POSITION, error);
+    return VALIDATION_OK;
 }
 
-void target2RmlTypes(const base::samples::RigidBodyState& target, RMLPositionInputParameters& params){
-    base::Vector3d euler = quaternion2Euler(target.orientation);
-    for(int i = 0; i < 3; i++)
-        target2RmlTypes(target.position(i), target.velocity(i), i, params);
-    for(int i = 0; i < 3; i++)
-        target2RmlTypes(euler(i), target.angular_velocity(i), i+3, params);
+ValidationStatus target2RmlTypes(const base::samples::RigidBodyStateSE3& target, RMLVelocityInputParameters& params, InputValidationError& error){
+    if(!fixedTarget2RmlTypes<CARTESIAN_DOF>(target.twist.linear, target.twist.angular, params))
+        return validateCartesian(cartesianVector(target.twist.linear, target.twist.angular), VALIDATION_INVALID_SPEED, error);
+    return VALIDATION_OK;
 }
 
-void target2RmlTypes(const base::samples::RigidBodyState& target, RMLVelocityInputParameters& params){
-    for(int i = 0; i < 3; i++)
-        target2RmlTypes(target.velocity(i), i, params);
-    for(int i = 0; i < 3; i++)
-        target2RmlTypes(target.angular_velocity(i), i+3, params);
+ValidationStatus target2RmlTypes(const base::samples::RigidBodyState& target, RMLPositionInputParameters& params, InputValidationError& error){
+    const base::Vector3d euler = quaternion2Euler(target.orientation);
+    if(!fixedTarget2RmlTypes<CARTESIAN_DOF>(target.position, euler, target.velocity, target.angular_velocity, params))
+        return validateCartesian(cartesianVector(target.position, euler), VALIDATION_INVALID_POSITION, error);
+    return VALIDATION_OK;
 }
 
-void target2RmlTypes(const double target_pos, const double target_vel, const uint idx, RMLPositionInputParameters& params){
-    if(base::isNaN(target_pos)){
-        LOG_ERROR("Element %i of target has no valid position!", idx);
-        throw std::invalid_argument("Invalid target");
+ValidationStatus target2RmlTypes(const base::samples::RigidBodyState& target, RMLVelocityInputParameters& params, InputValidationError& error){
+    if(!fixedTarget2RmlTypes<CARTESIAN_DOF>(target.velocity, target.angular_velocity, params))
+        return validateCartesian(cartesianVector(target.velocity, target.angular_velocity), VALIDATION_INVALID_SPEED, error);
+    return VALIDATION_OK;
+}
+
+void mergeJointTarget(const ConstrainedJointsCmd& partial, ConstrainedJointsCmd& merged){
+    // Keep the motion constraints of both consistent with the elements: either empty or one per element
+    if(!partial.motion_constraints.empty() && merged.motion_constraints.empty())
+        merged.motion_constraints.resize(merged.size());
+    for(size_t i = 0; i < partial.size(); i++){
+        int idx = findName(merged.names, partial.names[i]);
+        if(idx < 0){
+            idx = merged.size();
+            merged.names.push_back(partial.names[i]);
+            merged.elements.push_back(partial[i]);
+            if(!merged.motion_constraints.empty())
+                merged.motion_constraints.push_back(MotionConstraint());
+        }
+        merged[idx] = partial[i];
+        if(!partial.motion_constraints.empty())
+            merged.motion_constraints[idx] = partial.motion_constraints[i];
     }
+    merged.time = partial.time;
+}
+
+void target2RmlTypes(const double target_pos, const double target_vel, const uint idx, RMLPositionInputParameters& params){
     params.SelectionVector->VecData[idx]      = true;
     params.TargetPositionVector->VecData[idx] = target_pos;
     params.TargetVelocityVector->VecData[idx] = 0;
@@ -277,36 +515,19 @@ void target2RmlTypes(const double target_pos, const double target_vel, const uin
 }
 
 void target2RmlTypes(const double target_vel, const uint idx, RMLVelocityInputParameters& params){
-    if(base::isNaN(target_vel)){
-        LOG_ERROR("Element %i of target has no valid velocity!", idx);
-        throw std::invalid_argument("Invalid target");
-    }
     params.SelectionVector->VecData[idx]      = true;
     params.TargetVelocityVector->VecData[idx] = target_vel;
 }
 
-void cropTargetAtPositionLimits(RMLPositionInputParameters& params){
-#ifdef USING_REFLEXXES_TYPE_IV
-    for(uint i = 0; i < params.GetNumberOfDOFs(); i++){
-        double pos = params.TargetPositionVector->VecData[i];
-        double max = params.MaxPositionVector->VecData[i];
-        double min = params.MinPositionVector->VecData[i];
-        params.TargetPositionVector->VecData[i] = std::max(std::min(max, pos), min);
-    }
-#endif
+void cropTargetAtPositionLimits(const std::vector<double>& min_position, const std::vector<double>& max_position,
+                                RMLPositionInputParameters& params, ViolationMask& cropped){
+    clampToLimits(min_position.data(), max_position.data(), params.TargetPositionVector->VecData, params.GetNumberOfDOFs(), cropped);
 }
 
-void fixRmlSynchronizationBug(const double cycle_time, RMLVelocityInputParameters& params){
-#ifdef USING_REFLEXXES_TYPE_IV
-    for(uint i = 0; i < params.GetNumberOfDOFs(); i++){
-        double vel     = params.TargetVelocityVector->VecData[i];
-        double cur_pos = params.CurrentPositionVector->VecData[i];
-        double max_pos = params.MaxPositionVector->VecData[i];
-        double min_pos = params.MinPositionVector->VecData[i];
-        if( (vel*cycle_time + cur_pos > max_pos) || (vel*cycle_time + cur_pos < min_pos) )
-            params.TargetVelocityVector->VecData[i] = 0;
-    }
-#endif
+void fixRmlSynchronizationBug(const double cycle_time, const std::vector<double>& min_position, const std::vector<double>& max_position,
+                              RMLVelocityInputParameters& params, ViolationMask& modified){
+    zeroVelocityAtLimits(cycle_time, min_position.data(), max_position.data(), params.CurrentPositionVector->VecData,
+                         params.TargetVelocityVector->VecData, params.GetNumberOfDOFs(), modified);
 }
 
 }
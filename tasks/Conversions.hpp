@@ -2,6 +2,8 @@
 #define CONVERSIONS_HPP
 
 #include "trajectory_generationTypes.hpp"
+#include "LimitKernels.hpp"
+#include "NameLayoutCache.hpp"
 #include <base/samples/RigidBodyStateSE3.hpp>
 #include <base/samples/RigidBodyState.hpp>
 #include <joint_control_base/MotionConstraint.hpp>
@@ -17,19 +19,62 @@ void rmlTypes2InputParams(const RMLInputParameters &in,         ReflexxesInputPa
 void rmlTypes2InputParams(const RMLPositionInputParameters &in, ReflexxesInputParameters& out);
 void rmlTypes2InputParams(const RMLVelocityInputParameters &in, ReflexxesInputParameters& out);
 
+/** Inverse of rmlTypes2InputParams(), e.g. to replay a recorded worst case (WCETRecord::input). The number of DOF of in and out must match*/
+void inputParams2RmlTypes(const ReflexxesInputParameters& in, RMLInputParameters& out);
+void inputParams2RmlTypes(const ReflexxesInputParameters& in, RMLPositionInputParameters& out);
+void inputParams2RmlTypes(const ReflexxesInputParameters& in, RMLVelocityInputParameters& out);
+
 void rmlTypes2OutputParams(const RMLOutputParameters &in,         ReflexxesOutputParameters& out);
 void rmlTypes2OutputParams(const RMLPositionOutputParameters &in, ReflexxesOutputParameters& out);
 void rmlTypes2OutputParams(const RMLVelocityOutputParameters &in, ReflexxesOutputParameters& out);
 
-void jointState2RmlTypes(const base::samples::Joints& joint_state, const std::vector<std::string> &names, const RMLFlags& flags, RMLInputParameters& params);
+/** Names of the Cartesian DOF, used for error reporting*/
+extern const char* CARTESIAN_DOF_NAMES[6];
+
+/** Index of the given name in names or -1 if it is not contained. Non-throwing replacement for NamedVector::mapNameToIndex()*/
+int findName(const std::vector<std::string>& names, const std::string& name);
+
+/** Position limits of the given constraints, -inf/+inf if a limit is not set (NaN). The limits are passed to the functions below and
+ *  to OTGBackend::setPositionLimits() instead of being read from the RML input parameters, which only contain them with Reflexxes Type IV*/
+void positionLimits(const joint_control_base::MotionConstraints& constraints, std::vector<double>& min_position, std::vector<double>& max_position);
+
+/** Set the current position of all joints configured in layout. The layout is updated with the names of the joint state.
+ *  If the joint state is invalid, the current state in params is undefined, the reason is returned and described in error.
+ *  Unless behavior is POSITIONAL_LIMITS_IGNORE, joints that violate their position limits are marked in violations and rejected.*/
+ValidationStatus jointState2RmlTypes(const base::samples::Joints& joint_state, NameLayoutCache& layout, const PositionalLimitsBehavior behavior,
+                                     const std::vector<double>& min_position, const std::vector<double>& max_position,
+                                     RMLInputParameters& params, ViolationMask& violations, InputValidationError& error);
+/** Fuse a measured joint state into the current state of params according to config. The measured positions are extrapolated
+ *  by age seconds using the measured speeds (if valid). Velocity and acceleration are blended with the velocity gain, the acceleration
+ *  towards zero if it is not measured. Unless behavior is POSITIONAL_LIMITS_IGNORE, the resulting positions are clamped to the position limits.
+ *  Returns false if the joint state does not contain valid entries for all joints configured in layout. In this case, params remain
+ *  untouched.*/
+bool blendJointState(const base::samples::Joints& joint_state, NameLayoutCache& layout, const StateFeedbackConfig& config,
+                     const double age, const PositionalLimitsBehavior behavior, const std::vector<double>& min_position,
+                     const std::vector<double>& max_position, RMLInputParameters& params);
 void rmlTypes2JointState(const RMLInputParameters& params, base::samples::Joints& joint_state);
-void cartesianState2RmlTypes(const base::samples::RigidBodyStateSE3& cartesian_state, RMLInputParameters& params);
+/** Set the current Cartesian pose. Returns the reason and leaves params untouched if the pose is invalid*/
+ValidationStatus cartesianState2RmlTypes(const base::samples::RigidBodyStateSE3& cartesian_state, RMLInputParameters& params, InputValidationError& error);
 void rmlTypes2CartesianState(const RMLInputParameters& params, base::samples::RigidBodyStateSE3& cartesian_state);
 
+/** Check that gains are in [0,1] and deadband, latency and max. extrapolation are not negative*/
+bool validateStateFeedbackConfig(const StateFeedbackConfig& config);
+
+/** Check that the given constraint is valid (positive max. speed, acceleration, jerk and, for Type IV, min. position < max. position)*/
+ValidationStatus validateMotionConstraint(const joint_control_base::MotionConstraint& constraint, const std::string& name, InputValidationError& error);
+
+/** Set the motion constraint of element idx. The constraint is not validated, see validateMotionConstraint()*/
 void motionConstraint2RmlTypes(const joint_control_base::MotionConstraint& constraint, const uint idx, RMLInputParameters& params);
 void motionConstraint2RmlTypes(const joint_control_base::MotionConstraint& constraint, const uint idx, RMLPositionInputParameters& params);
 void motionConstraint2RmlTypes(const joint_control_base::MotionConstraint& constraint, const uint idx, RMLVelocityInputParameters& params);
 
+/** Write the new position, speed and acceleration of params to command. Also used by velocity based OTG to command positions (convert_to_position)*/
+void rmlTypes2PositionCommand(const RMLOutputParameters& params, base::commands::Joints& command);
+void rmlTypes2PositionCommand(const RMLOutputParameters& params, base::samples::RigidBodyStateSE3& command);
+/** Same, and also write it to current_sample. The Cartesian tasks feed the new state back as current state (see RMLTask::stepOTG()), so
+ *  command and interpolator state are equal and the Euler angles only have to be converted once per cycle*/
+void rmlTypes2PositionCommand(const RMLOutputParameters& params, base::samples::RigidBodyStateSE3& command, base::samples::RigidBodyStateSE3& current_sample);
+
 void rmlTypes2Command(const RMLPositionOutputParameters& params, base::commands::Joints& command);
 void rmlTypes2Command(const RMLPositionOutputParameters& params, base::samples::RigidBodyStateSE3& command);
 void rmlTypes2Command(const RMLPositionOutputParameters& params, base::samples::RigidBodyStateSE3& command);
@@ -37,15 +82,36 @@ void rmlTypes2Command(const RMLVelocityOutputParameters& params, base::commands:
 void rmlTypes2Command(const RMLVelocityOutputParameters& params, base::samples::RigidBodyStateSE3& command);
 void rmlTypes2Command(const RMLVelocityOutputParameters& params, base::samples::RigidBodyStateSE3& command);
 
-void target2RmlTypes(const joint_control_base::ConstrainedJointsCmd& target, const joint_control_base::MotionConstraints& default_constraints, RMLPositionInputParameters& params);
-void target2RmlTypes(const joint_control_base::ConstrainedJointsCmd& target, const joint_control_base::MotionConstraints& default_constraints, RMLVelocityInputParameters& params);
-void target2RmlTypes(const base::samples::RigidBodyState& target, RMLPositionInputParameters& params);
-void target2RmlTypes(const base::samples::RigidBodyState& target, RMLVelocityInputParameters& params);
+/** The following functions validate the complete target before modifying params. If the target is invalid, params remain
+ *  untouched and the reason is returned and described in error. If merge is false, only the elements of the target are selected.
+ *  If merge is true, all other elements keep their selection and target, i.e. a partial target is merged into the current one*/
+ValidationStatus target2RmlTypes(const joint_control_base::ConstrainedJointsCmd& target, const joint_control_base::MotionConstraints& default_constraints,
+                                 RMLPositionInputParameters& params, InputValidationError& error, const bool merge = false);
+ValidationStatus target2RmlTypes(const joint_control_base::ConstrainedJointsCmd& target, const joint_control_base::MotionConstraints& default_constraints,
+                                 RMLVelocityInputParameters& params, InputValidationError& error, const bool merge = false);
+/** Mixed target: Elements with valid position are selected for position based OTG in pos_params, all others for velocity based
+ *  OTG in vel_params. Motion constraints are only written to pos_params*/
+ValidationStatus target2RmlTypes(const joint_control_base::ConstrainedJointsCmd& target, const joint_control_base::MotionConstraints& default_constraints,
+                                 RMLPositionInputParameters& pos_params, RMLVelocityInputParameters& vel_params, InputValidationError& error,
+                                 const bool merge = false);
+/** Merge a validated partial target into merged: Elements contained in partial are overwritten, new elements are appended. Elements
+ *  without motion constraints in partial keep their motion constraints in merged, like the motion constraints in the RML input parameters.
+ *  Appending allocates memory, so merged should be presized with all names and motion constraints if this is called in the cycle*/
+void mergeJointTarget(const joint_control_base::ConstrainedJointsCmd& partial, joint_control_base::ConstrainedJointsCmd& merged);
+ValidationStatus target2RmlTypes(const base::samples::RigidBodyStateSE3& target, RMLPositionInputParameters& params, InputValidationError& error);
+ValidationStatus target2RmlTypes(const base::samples::RigidBodyStateSE3& target, RMLVelocityInputParameters& params, InputValidationError& error);
+ValidationStatus target2RmlTypes(const base::samples::RigidBodyState& target, RMLPositionInputParameters& params, InputValidationError& error);
+ValidationStatus target2RmlTypes(const base::samples::RigidBodyState& target, RMLVelocityInputParameters& params, InputValidationError& error);
+/** Set target of a single element. The values are not validated*/
 void target2RmlTypes(const double target_pos, const double target_vel, const uint idx, RMLPositionInputParameters& params);
 void target2RmlTypes(const double target_vel, const uint idx, RMLVelocityInputParameters& params);
 
-void cropTargetAtPositionLimits(RMLPositionInputParameters& params);
-void fixRmlSynchronizationBug(const double cycle_time, RMLVelocityInputParameters& params);
+/** Clamp target positions to the given position limits. Clamped DOF are marked in cropped*/
+void cropTargetAtPositionLimits(const std::vector<double>& min_position, const std::vector<double>& max_position,
+                                RMLPositionInputParameters& params, ViolationMask& cropped);
+/** Set target velocity to zero for all DOF that would exceed the given position limits in the next cycle. Modified DOF are marked in modified*/
+void fixRmlSynchronizationBug(const double cycle_time, const std::vector<double>& min_position, const std::vector<double>& max_position,
+                              RMLVelocityInputParameters& params, ViolationMask& modified);
 
 }
 
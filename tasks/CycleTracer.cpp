@@ -0,0 +1,30 @@
+#include "CycleTracer.hpp"
+
+namespace trajectory_generation{
+
+static const char* stage_names[NUMBER_OF_CYCLE_STAGES] = {
+    "current_state", "target", "constraints", "otg", "monitoring", "write_command", "debug_output"
+};
+
+void CycleTracer::configure(const bool enable){
+    enabled = enable;
+    trace = CycleTrace();
+    if(!enabled)
+        return;
+    trace.stages.resize(NUMBER_OF_CYCLE_STAGES);
+    for(int i = 0; i < NUMBER_OF_CYCLE_STAGES; i++)
+        trace.stages[i].name = stage_names[i];
+}
+
+void CycleTracer::beginCycle(const base::Time& time, const base::Time& start_time){
+    cycle_start = monotonicNanoseconds();
+    trace.time = time;
+    trace.start_time = start_time;
+    trace.duration = 0;
+    for(size_t i = 0; i < trace.stages.size(); i++){
+        trace.stages[i].start = base::NaN<double>();
+        trace.stages[i].duration = 0;
+    }
+}
+
+}
@@ -0,0 +1,78 @@
+#ifndef CYCLE_TRACER_HPP
+#define CYCLE_TRACER_HPP
+
+#include "trajectory_generationTypes.hpp"
+#include <time.h>
+
+namespace trajectory_generation{
+
+/** Measures the duration of the stages of the OTG cycle on the monotonic clock and stores them in a preallocated CycleTrace.
+ *  Memory is only allocated in configure(). If the tracer is disabled, each ScopedStageTimer costs a single branch.*/
+class CycleTracer{
+public:
+    CycleTracer() : enabled(false), cycle_start(0){}
+
+    /** Enable or disable the tracer and allocate the trace*/
+    void configure(const bool enable);
+
+    bool isEnabled() const {return enabled;}
+
+    /** Reset all stages and start the cycle with the given time stamp and system clock start time*/
+    void beginCycle(const base::Time& time, const base::Time& start_time);
+
+    /** Set the duration of the whole cycle*/
+    void endCycle(){
+        trace.duration = elapsed();
+    }
+
+    void beginStage(const CycleStage stage){
+        trace.stages[stage].start = elapsed();
+    }
+
+    void endStage(const CycleStage stage){
+        CycleTraceStage& s = trace.stages[stage];
+        s.duration = elapsed() - s.start;
+    }
+
+    const CycleTrace& getTrace() const {return trace;}
+
+private:
+    bool enabled;
+    int64_t cycle_start;   /** Start of the current cycle on the monotonic clock in ns*/
+    CycleTrace trace;
+
+    static int64_t monotonicNanoseconds(){
+        timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return (int64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+    }
+
+    /** Time since the start of the current cycle in seconds*/
+    double elapsed() const {
+        return (monotonicNanoseconds() - cycle_start) * 1e-9;
+    }
+};
+
+/** Measures the duration of the enclosing scope as the given stage of the cycle. Does nothing if the tracer is disabled*/
+class ScopedStageTimer{
+public:
+    ScopedStageTimer(CycleTracer& tracer, const CycleStage stage) : tracer(tracer.isEnabled() ? &tracer : 0), stage(stage){
+        if(this->tracer)
+            this->tracer->beginStage(stage);
+    }
+    ~ScopedStageTimer(){
+        if(tracer)
+            tracer->endStage(stage);
+    }
+
+private:
+    CycleTracer* tracer;
+    const CycleStage stage;
+
+    ScopedStageTimer(const ScopedStageTimer&);
+    ScopedStageTimer& operator=(const ScopedStageTimer&);
+};
+
+}
+
+#endif
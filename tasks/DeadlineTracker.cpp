@@ -0,0 +1,94 @@
+#include "DeadlineTracker.hpp"
+#include <algorithm>
+
+namespace trajectory_generation{
+
+void DeadlineTracker::reset(){
+    pending = deadline = base::Time();
+    status = DeadlineStatus();
+    replan = applied = infeasible = drop_stretch = false;
+    motion_end_offset = 0;
+}
+
+void DeadlineTracker::request(const base::Time& now, const base::Time& arrival_time){
+    pending = arrival_time;
+    if(!arrival_time.isNull())
+        return;
+    drop_stretch = drop_stretch || isActive();
+    deadline = base::Time();
+    status = DeadlineStatus();
+    status.time = now;
+}
+
+bool DeadlineTracker::apply(const base::Time& now, const bool target_changed, const double cycle_time, double& min_sync_time){
+    applied = false;
+    bool dropped = false;
+    if(target_changed){
+        if(isActive()){
+            dropped = drop_stretch = true;
+            status = DeadlineStatus();
+            status.time = now;
+            status.arrival_time = deadline;
+        }
+        deadline = pending;
+        pending = base::Time();
+        replan = true;
+        infeasible = false;
+    }
+    if(drop_stretch){
+        min_sync_time = 0;
+        drop_stretch = false;
+    }
+    if(!isActive())
+        return dropped;
+
+    // Only recompute the motion if required. Within the last cycle, the remaining time is too close to zero to be applied
+    const double remaining = (deadline - now).toSeconds();
+    if(replan && remaining > cycle_time){
+        min_sync_time = remaining;
+        applied = true;
+    }
+    replan = false;
+    return dropped;
+}
+
+const DeadlineStatus& DeadlineTracker::evaluate(const base::Time& now, const int result, const RMLPositionOutputParameters& out,
+                                                const double cycle_time, double& min_sync_time){
+    if(out.ANewCalculationWasPerformed)
+        motion_end_offset = out.SynchronizationTime;
+    else
+        motion_end_offset = std::max(motion_end_offset - cycle_time, 0.0);
+
+    status.time = now;
+    status.arrival_time = deadline;
+    status.expected_arrival = now;
+    if(result != RML_FINAL_STATE_REACHED)
+        status.expected_arrival = status.expected_arrival + base::Time::fromSeconds(motion_end_offset);
+    status.slack = (deadline - status.expected_arrival).toSeconds();
+
+    // Tolerate deviations of half a cycle, since the motion can only end on a cycle
+    const bool late  = status.slack < -cycle_time / 2;
+    const bool early = status.slack >  cycle_time / 2;
+
+    // If the motion is still late after applying the remaining time, the deadline cannot be met. Otherwise, deviations are caused
+    // by a recomputation with an outdated MinimumSynchronizationTime (e.g. after a change of the current state) or by cycle jitter
+    if(late && applied)
+        infeasible = true;
+    replan = early || (late && !infeasible);
+
+    if(result == RML_FINAL_STATE_REACHED)
+        status.state = late ? DEADLINE_MISSED : DEADLINE_REACHED;
+    else if((now - deadline).toSeconds() > cycle_time / 2)
+        status.state = DEADLINE_MISSED;
+    else
+        status.state = late ? DEADLINE_INFEASIBLE : DEADLINE_FEASIBLE;
+
+    if(status.state == DEADLINE_MISSED || status.state == DEADLINE_REACHED){
+        // Continue (or start the next motion) without deadline
+        min_sync_time = 0;
+        deadline = base::Time();
+    }
+    return status;
+}
+
+}
@@ -0,0 +1,51 @@
+#ifndef DEADLINE_TRACKER_HPP
+#define DEADLINE_TRACKER_HPP
+
+#include "OTGBackend.hpp"
+#include <base/Time.hpp>
+
+namespace trajectory_generation{
+
+/** Requested arrival time (deadline) of a position based motion. A requested deadline is pending until the next target is accepted and
+ *  belongs to that target only: It is dropped when the target is replaced, has been reached or the deadline has passed. While it is
+ *  active, the motion is stretched via the minimum synchronization time of the OTG algorithm so that it ends at the deadline, and
+ *  re-evaluated against the clock in each cycle. See RMLTask::applyDeadline()*/
+class DeadlineTracker{
+public:
+    DeadlineTracker(){reset();}
+
+    /** Drop the pending and the active deadline*/
+    void reset();
+
+    /** New requested arrival time, armed by the next accepted target. A null time drops the pending and the active deadline and sets
+     *  the status to DEADLINE_NONE*/
+    void request(const base::Time& now, const base::Time& arrival_time);
+
+    /** Call in each cycle before the OTG step. A new target (target_changed) drops the deadline of the previous target and arms the pending
+     *  one. Sets min_sync_time to the remaining time until the deadline if the motion has to be recomputed, and to 0 if the deadline has
+     *  been dropped. Returns true if an active deadline has been dropped by the new target, the status is DEADLINE_NONE in this case*/
+    bool apply(const base::Time& now, const bool target_changed, const double cycle_time, double& min_sync_time);
+
+    /** Call in each cycle after the OTG step while the deadline is active. Compares the expected arrival time of the motion with the deadline
+     *  and updates the status. Drops the deadline (and sets min_sync_time to 0) once it has been reached or has passed*/
+    const DeadlineStatus& evaluate(const base::Time& now, const int result, const RMLPositionOutputParameters& out, const double cycle_time,
+                                   double& min_sync_time);
+
+    bool isActive() const {return !deadline.isNull();}
+    bool isPending() const {return !pending.isNull();}
+    const DeadlineStatus& getStatus() const {return status;}
+
+private:
+    base::Time pending;         /** Requested arrival time of the next target, null if none*/
+    base::Time deadline;        /** Requested arrival time of the current target, null if no deadline is active*/
+    DeadlineStatus status;
+    bool replan;                /** Recompute the motion with the remaining time until the deadline in the next cycle*/
+    bool applied;               /** True if the remaining time until the deadline has been applied in the current cycle*/
+    bool infeasible;            /** True if the deadline cannot be met by the current target*/
+    bool drop_stretch;          /** The deadline has been dropped, reset the min. synchronization time in the next cycle*/
+    double motion_end_offset;   /** Remaining duration of the current motion in seconds*/
+};
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef FIXED_SIZE_CONVERSIONS_HPP
+#define FIXED_SIZE_CONVERSIONS_HPP
+
+#include <base/Eigen.hpp>
+#include <base/Float.hpp>
+#include <base/commands/Joints.hpp>
+#include <ReflexxesAPI.h>
+#include <cstring>
+
+namespace trajectory_generation{
+
+/** Number of DOF in Cartesian space: 3 translational + 3 rotational (ZYX-euler angles) DOF*/
+const unsigned int CARTESIAN_DOF = 6;
+
+/** Stack allocated state vector for N DOF*/
+template<int N> using FixedVector = Eigen::Matrix<double,N,1>;
+
+/** Cartesian state vector: position followed by ZYX-euler angles*/
+typedef FixedVector<CARTESIAN_DOF> CartesianVector;
+
+/** Map the data of a RML vector onto a fixed size Eigen vector without copying*/
+template<int N> inline Eigen::Map<FixedVector<N> > rmlVector(RMLDoubleVector& v){
+    static_assert(N > 0, "Only fixed sizes are supported");
+    return Eigen::Map<FixedVector<N> >(v.VecData);
+}
+
+/** Map the data of a RML vector onto a fixed size Eigen vector without copying*/
+template<int N> inline Eigen::Map<const FixedVector<N> > rmlVector(const RMLDoubleVector& v){
+    static_assert(N > 0, "Only fixed sizes are supported");
+    return Eigen::Map<const FixedVector<N> >(v.VecData);
+}
+
+/** True if any of the elements is NaN*/
+template<typename Derived> inline bool hasNaN(const Eigen::MatrixBase<Derived>& v){
+    return !(v.array() == v.array()).all();
+}
+
+/** Set the target position of all N DOF from the N1 first and N-N1 last elements and select them. The target velocities are given in the
+ *  same way, NaN velocities are replaced by zero. Returns false and leaves the parameters untouched if any target position is NaN.
+ *  Writes directly into the RML vectors, so that no intermediate N DOF vector is assembled*/
+template<int N, int N1> bool fixedTarget2RmlTypes(const FixedVector<N1>& pos_head, const FixedVector<N-N1>& pos_tail,
+                                                   const FixedVector<N1>& vel_head, const FixedVector<N-N1>& vel_tail,
+                                                   RMLPositionInputParameters& params){
+    if(hasNaN(pos_head) || hasNaN(pos_tail))
+        return false;
+    memset(params.SelectionVector->VecData, true, N);
+    Eigen::Map<FixedVector<N> > pos = rmlVector<N>(*params.TargetPositionVector);
+    Eigen::Map<FixedVector<N> > vel = rmlVector<N>(*params.TargetVelocityVector);
+    pos.template head<N1>()   = pos_head;
+    pos.template tail<N-N1>() = pos_tail;
+    vel.template head<N1>()   = (vel_head.array() == vel_head.array()).select(vel_head, 0.0);
+    vel.template tail<N-N1>() = (vel_tail.array() == vel_tail.array()).select(vel_tail, 0.0);
+    return true;
+}
+
+/** Set the target velocity of all N DOF from the N1 first and N-N1 last elements and select them. Returns false and leaves the parameters
+ *  untouched if any target velocity is NaN.*/
+template<int N, int N1> bool fixedTarget2RmlTypes(const FixedVector<N1>& vel_head, const FixedVector<N-N1>& vel_tail, RMLVelocityInputParameters& params){
+    if(hasNaN(vel_head) || hasNaN(vel_tail))
+        return false;
+    memset(params.SelectionVector->VecData, true, N);
+    Eigen::Map<FixedVector<N> > vel = rmlVector<N>(*params.TargetVelocityVector);
+    vel.template head<N1>()   = vel_head;
+    vel.template tail<N-N1>() = vel_tail;
+    return true;
+}
+
+}
+
+#endif
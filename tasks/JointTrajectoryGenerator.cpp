@@ -0,0 +1,260 @@
+#include "JointTrajectoryGenerator.hpp"
+#include "Conversions.hpp"
+#include <base-logging/Logging.hpp>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace trajectory_generation{
+
+// Mode specific parts. Overloaded on the RML parameter types, like the conversion functions
+
+// Crop at limits, otherwise RML will throw a positional limits error
+static void applyPositionLimits(const double, const std::vector<double>& min_position, const std::vector<double>& max_position,
+                                RMLPositionInputParameters& in, ViolationMask& violations){
+    cropTargetAtPositionLimits(min_position, max_position, in, violations);
+}
+
+// See fixRmlSynchronizationBug(): The synchronization time is computed as if a joint at its position limit could move freely in direction of the limit
+static void applyPositionLimits(const double cycle_time, const std::vector<double>& min_position, const std::vector<double>& max_position,
+                                RMLVelocityInputParameters& in, ViolationMask& violations){
+    fixRmlSynchronizationBug(cycle_time, min_position, max_position, in, violations);
+}
+
+static void writeCommand(const RMLPositionOutputParameters& out, const bool, base::commands::Joints& command){
+    rmlTypes2Command(out, command);
+}
+
+static void writeCommand(const RMLVelocityOutputParameters& out, const bool convert_to_position, base::commands::Joints& command){
+    if(convert_to_position)
+        rmlTypes2PositionCommand(out, command);
+    else
+        rmlTypes2Command(out, command);
+}
+
+/** Capacity reserved for the element name of the validation error, so that rejections do not allocate memory*/
+static const size_t MAX_VALIDATION_NAME_LENGTH = 128;
+
+template<class Mode> JointTrajectoryGenerator<Mode>::JointTrajectoryGenerator() :
+    backend(0),
+    input_parameters(0),
+    output_parameters(0),
+    result_value(RML_NOT_INITIALIZED),
+    configured(false),
+    windup_correction(false),
+    has_current_state(false),
+    has_target(false){
+}
+
+template<class Mode> JointTrajectoryGenerator<Mode>::~JointTrajectoryGenerator(){
+    release();
+}
+
+template<class Mode> void JointTrajectoryGenerator<Mode>::release(){
+    delete backend;
+    delete input_parameters;
+    delete output_parameters;
+    backend = 0;
+    input_parameters = 0;
+    output_parameters = 0;
+    configured = false;
+}
+
+template<class Mode> bool JointTrajectoryGenerator<Mode>::configure(const JointTrajectoryGeneratorConfig& new_config, const bool create_backend){
+    release();
+    reset();
+
+    const joint_control_base::MotionConstraints& constraints = new_config.motion_constraints;
+    if(constraints.size() != constraints.names.size()){
+        LOG_ERROR("Number of elements in motion constraints must be same as size of the names vector");
+        return false;
+    }
+    if(!(new_config.cycle_time > 0)){
+        LOG_ERROR("Cycle time must be > 0, but is %f", new_config.cycle_time);
+        return false;
+    }
+    for(size_t i = 0; i < constraints.size(); i++){
+        if(validateMotionConstraint(constraints[i], constraints.names[i], validation_error) != VALIDATION_OK){
+            LOG_ERROR("Invalid motion constraint for element %s (validation status %i, value %f)",
+                      validation_error.name.c_str(), validation_error.status, validation_error.value);
+            return false;
+        }
+    }
+    if(!validateStateFeedbackConfig(new_config.state_feedback)){
+        LOG_ERROR("Invalid state feedback configuration. Gains have to be in [0,1], deadband, latency and max. extrapolation must not be negative");
+        return false;
+    }
+    if(new_config.max_pos_diff.size() > 0 && (size_t)new_config.max_pos_diff.size() != constraints.size()){
+        LOG_ERROR("Max pos. diff has %i entries but configured number of DOF is %i", (int)new_config.max_pos_diff.size(), (int)constraints.size());
+        return false;
+    }
+
+    config = new_config;
+    const size_t n_dof = constraints.size();
+    flags = Flags();
+    flags.SynchronizationBehavior = config.synchronization_behavior;
+#ifdef USING_REFLEXXES_TYPE_IV
+    flags.PositionalLimitsBehavior = config.positional_limits_behavior;
+#endif
+    positionLimits(constraints, min_position, max_position);
+
+    if(create_backend){
+        input_parameters = new InputParameters(n_dof);
+        output_parameters = new OutputParameters(n_dof);
+        for(size_t i = 0; i < n_dof; i++)
+            motionConstraint2RmlTypes(constraints[i], i, *input_parameters);
+
+        backend = createOTGBackend(config.otg_backend, n_dof, config.cycle_time);
+        backend->setPositionLimits(min_position, max_position, config.positional_limits_behavior);
+    }
+
+    // The windup correction only applies to velocity based OTG that commands positions
+    windup_correction = std::is_same<Mode, VelocityMode>::value && config.convert_to_position && config.max_pos_diff.size() > 0;
+    joint_state_layout.configure(constraints.names);
+    target_speeds.assign(n_dof, 0);
+    measured_positions.assign(n_dof, base::NaN<double>());
+    limit_violations.resize(n_dof);
+    validation_error = InputValidationError();
+    validation_error.name.reserve(MAX_VALIDATION_NAME_LENGTH);
+    configured = true;
+    return true;
+}
+
+template<class Mode> void JointTrajectoryGenerator<Mode>::reset(){
+    has_current_state = has_target = false;
+    result_value = RML_NOT_INITIALIZED;
+    std::fill(target_speeds.begin(), target_speeds.end(), 0);
+    std::fill(measured_positions.begin(), measured_positions.end(), base::NaN<double>());
+}
+
+template<class Mode> ValidationStatus JointTrajectoryGenerator<Mode>::notConfigured(InputValidationError& error) const{
+    error.status = VALIDATION_NOT_CONFIGURED;
+    error.name.clear();
+    error.value = base::NaN<double>();
+    return error.status;
+}
+
+template<class Mode> ValidationStatus JointTrajectoryGenerator<Mode>::setCurrentState(const base::samples::Joints& sample, const base::Time& now){
+    if(!input_parameters)
+        return notConfigured(validation_error);
+    return setCurrentState(sample, now, *input_parameters, limit_violations, validation_error);
+}
+
+template<class Mode> ValidationStatus JointTrajectoryGenerator<Mode>::setCurrentState(const base::samples::Joints& sample, const base::Time& now, InputParameters& in,
+                                                                                     ViolationMask& violations, InputValidationError& error){
+    if(!configured)
+        return notConfigured(error);
+
+    if(!has_current_state){
+        ValidationStatus status = jointState2RmlTypes(sample, joint_state_layout, config.positional_limits_behavior, min_position, max_position,
+                                                      in, violations, error);
+        if(status != VALIDATION_OK)
+            return status;
+        has_current_state = true;
+    }
+    else if(config.state_feedback.enabled){
+        // Extrapolate the measurement to the current time. Samples without timestamp are assumed to be delayed only by the configured latency
+        double age = config.state_feedback.latency;
+        if(!sample.time.isNull())
+            age += (now - sample.time).toSeconds();
+        if(age <= config.state_feedback.max_extrapolation)
+            blendJointState(sample, joint_state_layout, config.state_feedback, std::max(age, 0.0), config.positional_limits_behavior,
+                            min_position, max_position, in);
+    }
+    storeMeasuredPositions(sample);
+    return VALIDATION_OK;
+}
+
+template<class Mode> void JointTrajectoryGenerator<Mode>::storeMeasuredPositions(const base::samples::Joints& sample){
+    if(!windup_correction)
+        return;
+    if(sample.names.size() != sample.elements.size()){
+        std::fill(measured_positions.begin(), measured_positions.end(), base::NaN<double>());
+        return;
+    }
+    joint_state_layout.update(sample.names);
+    for(size_t i = 0; i < measured_positions.size(); i++){
+        const int idx = joint_state_layout[i];
+        measured_positions[i] = idx < 0 ? base::NaN<double>() : sample.elements[idx].position;
+    }
+}
+
+template<class Mode> ValidationStatus JointTrajectoryGenerator<Mode>::setTarget(const joint_control_base::ConstrainedJointsCmd& new_target){
+    if(!input_parameters)
+        return notConfigured(validation_error);
+    return setTarget(new_target, *input_parameters, limit_violations, validation_error);
+}
+
+template<class Mode> ValidationStatus JointTrajectoryGenerator<Mode>::setTarget(const joint_control_base::ConstrainedJointsCmd& new_target, InputParameters& in,
+                                                                               ViolationMask& violations, InputValidationError& error, const bool merge){
+    if(!configured)
+        return notConfigured(error);
+
+    // The target speeds in the input parameters may have been modified by the windup correction or at the position limits. Restore them,
+    // so that the modified values are not merged into the new target
+    if(merge)
+        std::copy(target_speeds.begin(), target_speeds.end(), in.TargetVelocityVector->VecData);
+    // Invalid samples are rejected without modifying the input parameters, i.e. the previous target remains active
+    ValidationStatus status = target2RmlTypes(new_target, config.motion_constraints, in, error, merge);
+    if(status != VALIDATION_OK)
+        return status;
+    std::copy(in.TargetVelocityVector->VecData, in.TargetVelocityVector->VecData + target_speeds.size(), target_speeds.begin());
+    has_target = true;
+    if(config.positional_limits_behavior == POSITIONAL_LIMITS_ACTIVELY_PREVENT)
+        applyPositionLimits(config.cycle_time, min_position, max_position, in, violations);
+    return VALIDATION_OK;
+}
+
+template<class Mode> ValidationStatus JointTrajectoryGenerator<Mode>::setTarget(const joint_control_base::ConstrainedJointsCmd& new_target, RMLPositionInputParameters& in,
+                                                                               RMLVelocityInputParameters& vel_in, ViolationMask& violations, InputValidationError& error,
+                                                                               const bool merge){
+    if(!configured)
+        return notConfigured(error);
+
+    ValidationStatus status = target2RmlTypes(new_target, config.motion_constraints, in, vel_in, error, merge);
+    if(status != VALIDATION_OK)
+        return status;
+    has_target = true;
+    if(config.positional_limits_behavior == POSITIONAL_LIMITS_ACTIVELY_PREVENT)
+        applyPositionLimits(config.cycle_time, min_position, max_position, in, violations);
+    return VALIDATION_OK;
+}
+
+template<class Mode> void JointTrajectoryGenerator<Mode>::correctInterpolatorState(InputParameters& in, const OutputParameters& out) const{
+    if(!windup_correction)
+        return;
+    // Restore the target speeds that have been set to zero in the previous cycle. The target has been validated and converted
+    // when it was received, so neither validation nor name lookups are needed here
+    std::copy(target_speeds.begin(), target_speeds.end(), in.TargetVelocityVector->VecData);
+    for(uint i = 0; i < in.NumberOfDOFs; i++){
+        // NaN if the joint is missing in the joint state, the comparison is false then
+        if(fabs(out.NewPositionVector->VecData[i] - measured_positions[i]) > config.max_pos_diff(i))
+            in.TargetVelocityVector->VecData[i] = 0.0;
+    }
+}
+
+template<class Mode> void JointTrajectoryGenerator<Mode>::writeCommand(const OutputParameters& out, base::commands::Joints& command) const{
+    trajectory_generation::writeCommand(out, config.convert_to_position, command);
+}
+
+template<class Mode> ReflexxesResultValue JointTrajectoryGenerator<Mode>::step(base::commands::Joints& command){
+    if(!backend || !has_current_state || !has_target)
+        return RML_NOT_INITIALIZED;
+
+    correctInterpolatorState(*input_parameters, *output_parameters);
+
+    result_value = (ReflexxesResultValue)Mode::run(*backend, *input_parameters, *output_parameters, flags);
+
+    // Feed back the new state as the current state, see RMLTask::stepOTG()
+    *input_parameters->CurrentPositionVector     = *output_parameters->NewPositionVector;
+    *input_parameters->CurrentVelocityVector     = *output_parameters->NewVelocityVector;
+    *input_parameters->CurrentAccelerationVector = *output_parameters->NewAccelerationVector;
+
+    writeCommand(*output_parameters, command);
+    return result_value;
+}
+
+template class JointTrajectoryGenerator<PositionMode>;
+template class JointTrajectoryGenerator<VelocityMode>;
+
+}
@@ -0,0 +1,146 @@
+#ifndef JOINT_TRAJECTORY_GENERATOR_HPP
+#define JOINT_TRAJECTORY_GENERATOR_HPP
+
+#include "trajectory_generationTypes.hpp"
+#include "OTGBackend.hpp"
+#include "OTGMode.hpp"
+#include "LimitKernels.hpp"
+#include "NameLayoutCache.hpp"
+#include <base/commands/Joints.hpp>
+#include <base/samples/Joints.hpp>
+#include <joint_control_base/MotionConstraint.hpp>
+#include <joint_control_base/ConstrainedJointsCmd.hpp>
+
+namespace trajectory_generation{
+
+/** Configuration of a JointTrajectoryGenerator. The fields have the same meaning as the corresponding properties of RMLPositionTask and RMLVelocityTask*/
+struct JointTrajectoryGeneratorConfig{
+    joint_control_base::MotionConstraints motion_constraints; /** Default motion constraints and joint order*/
+    double cycle_time;                                        /** Time between two calls of step() in seconds*/
+    OTGBackendType otg_backend;                               /** Online trajectory generation algorithm*/
+    RMLFlags::SyncBehaviorEnum synchronization_behavior;      /** Synchronization behavior between the joints*/
+    PositionalLimitsBehavior positional_limits_behavior;      /** Behavior at the position limits. During the motion only enforced by Reflexxes Type IV or the S-curve backend*/
+    StateFeedbackConfig state_feedback;                       /** Continuous fusion of the measured joint state into the interpolator state*/
+    bool convert_to_position;                                 /** Velocity based only: Command positions instead of speeds*/
+    base::VectorXd max_pos_diff;                              /** Velocity based only: Max. difference between interpolator and measured position per joint. Empty: No limit*/
+
+    JointTrajectoryGeneratorConfig() :
+        cycle_time(0.01),
+        otg_backend(OTG_BACKEND_REFLEXXES),
+        synchronization_behavior(RMLFlags::PHASE_SYNCHRONIZATION_IF_POSSIBLE),
+        positional_limits_behavior(POSITIONAL_LIMITS_ACTIVELY_PREVENT),
+        convert_to_position(false){}
+};
+
+/** Joint space online trajectory generation without any dependency on the Orocos RTT. Implements state handling, target conversion,
+ *  position limit handling, integrator windup correction and OTG stepping of the joint space tasks (RMLPositionTask, RMLVelocityTask and
+ *  RMLMixedTask are built on it), so that other components can embed the generator and call it in-process instead of connecting to a task via ports.
+ *
+ *  Usage: configure() once, then in each cycle setCurrentState() (required at least once), setTarget() whenever the target changes and step().
+ *  Mode is PositionMode or VelocityMode, see the typedefs JointPositionGenerator and JointVelocityGenerator. All memory is allocated in configure(),
+ *  the other functions do not allocate memory.
+ *
+ *  The overloads that take RML input parameters operate on the parameters of the caller instead of the internal ones. They are used by the tasks,
+ *  which run their own OTG cycle (derating, deadlines, fallback, ...) on the same parameters. In this case, configure() is called with create_backend = false.*/
+template<class Mode> class JointTrajectoryGenerator{
+public:
+    typedef typename Mode::InputParameters  InputParameters;
+    typedef typename Mode::OutputParameters OutputParameters;
+    typedef typename Mode::Flags            Flags;
+
+    JointTrajectoryGenerator();
+    ~JointTrajectoryGenerator();
+
+    /** Validate the configuration and allocate all memory. Returns false and logs the reason if the configuration is invalid. Discards current
+     *  state and target. If create_backend is false, the OTG backend and the internal RML parameters are not allocated and only the overloads
+     *  that take RML input parameters can be used*/
+    bool configure(const JointTrajectoryGeneratorConfig& config, const bool create_backend = true);
+
+    /** Discard current state and target. The configuration is kept*/
+    void reset();
+
+    /** Set the current joint state. The first valid sample initializes the interpolator state, subsequent samples are only fused into the interpolator
+     *  state if state feedback is enabled. now is the current time, used to extrapolate time stamped samples. Returns VALIDATION_OK or the reason
+     *  for the rejection of the sample, which is described in getValidationError(). Returns VALIDATION_NOT_CONFIGURED before configure()*/
+    ValidationStatus setCurrentState(const base::samples::Joints& joint_state, const base::Time& now);
+    /** Same as above, but on the given input parameters. The reason for a rejection is described in error, joints that violate their
+     *  position limits are marked in violations*/
+    ValidationStatus setCurrentState(const base::samples::Joints& joint_state, const base::Time& now, InputParameters& in,
+                                     ViolationMask& violations, InputValidationError& error);
+
+    /** Set a new target. Invalid targets are rejected and the previous target remains active. Returns VALIDATION_OK or the reason for the
+     *  rejection, which is described in getValidationError(). Returns VALIDATION_NOT_CONFIGURED before configure()*/
+    ValidationStatus setTarget(const joint_control_base::ConstrainedJointsCmd& target);
+    /** Same as above, but on the given input parameters. If merge is set, the target is merged into the current one (see target2RmlTypes()).
+     *  Target positions or speeds that have been modified at the position limits are marked in violations*/
+    ValidationStatus setTarget(const joint_control_base::ConstrainedJointsCmd& target, InputParameters& in,
+                               ViolationMask& violations, InputValidationError& error, const bool merge = false);
+    /** Mixed position/velocity target, see RMLMixedTask: Elements with valid position are selected in in, all others in vel_in.
+     *  Only the position limits of in are handled here*/
+    ValidationStatus setTarget(const joint_control_base::ConstrainedJointsCmd& target, RMLPositionInputParameters& in, RMLVelocityInputParameters& vel_in,
+                               ViolationMask& violations, InputValidationError& error, const bool merge = false);
+
+    /** Perform one cycle of online trajectory generation and write the new interpolator state to command. The command is resized to the
+     *  number of DOF, names and time are left to the caller. Returns RML_NOT_INITIALIZED without modifying command if there is no current state or no target yet*/
+    ReflexxesResultValue step(base::commands::Joints& command);
+
+    /** Velocity based only: Restore the target speeds of the current target and stop all joints whose interpolator position (out) differs from the
+     *  last measured position by more than max_pos_diff. Does nothing if the windup correction is disabled (convert_to_position not set or max_pos_diff empty)*/
+    void correctInterpolatorState(InputParameters& in, const OutputParameters& out) const;
+
+    /** Write the new interpolator state to command. Velocity based: Positions are commanded if convert_to_position is set*/
+    void writeCommand(const OutputParameters& out, base::commands::Joints& command) const;
+
+    bool isConfigured() const {return configured;}
+    bool hasCurrentState() const {return has_current_state;}
+    bool hasTarget() const {return has_target;}
+    size_t getNumberOfDOFs() const {return config.motion_constraints.size();}
+    const JointTrajectoryGeneratorConfig& getConfig() const {return config;}
+    const InputValidationError& getValidationError() const {return validation_error;}
+    /** Joints that have been modified at the position limits by the last setCurrentState() or setTarget() call*/
+    const ViolationMask& getLimitViolations() const {return limit_violations;}
+    /** Mapping of the joint state elements onto the configured joint order*/
+    const NameLayoutCache& getJointStateLayout() const {return joint_state_layout;}
+    /** Current interpolator state, target and constraints. Only valid after configure() with create_backend set*/
+    const InputParameters& getInputParameters() const {return *input_parameters;}
+    /** Output of the last step() call. Only valid after configure() with create_backend set*/
+    const OutputParameters& getOutputParameters() const {return *output_parameters;}
+    ReflexxesResultValue getResultValue() const {return result_value;}
+
+private:
+    JointTrajectoryGeneratorConfig config;
+    OTGBackend* backend;
+    InputParameters* input_parameters;
+    OutputParameters* output_parameters;
+    Flags flags;
+    std::vector<double> min_position;       /** Position limits of the motion constraints, -inf/+inf if not set. See positionLimits()*/
+    std::vector<double> max_position;
+    NameLayoutCache joint_state_layout;
+    std::vector<double> target_speeds;      /** Target speeds of the current target in the configured joint order, see correctInterpolatorState()*/
+    std::vector<double> measured_positions; /** Positions of the most recent joint state in the configured joint order, NaN if missing. Only with windup correction*/
+    InputValidationError validation_error;
+    ViolationMask limit_violations;
+    ReflexxesResultValue result_value;
+    bool configured;
+    bool windup_correction;
+    bool has_current_state;
+    bool has_target;
+
+    void release();
+    /** Store the positions of the given joint state for the windup correction*/
+    void storeMeasuredPositions(const base::samples::Joints& joint_state);
+    ValidationStatus notConfigured(InputValidationError& error) const;
+
+    JointTrajectoryGenerator(const JointTrajectoryGenerator&);
+    JointTrajectoryGenerator& operator=(const JointTrajectoryGenerator&);
+};
+
+typedef JointTrajectoryGenerator<PositionMode> JointPositionGenerator;
+typedef JointTrajectoryGenerator<VelocityMode> JointVelocityGenerator;
+
+extern template class JointTrajectoryGenerator<PositionMode>;
+extern template class JointTrajectoryGenerator<VelocityMode>;
+
+}
+
+#endif
@@ -0,0 +1,49 @@
+#include "LimitKernels.hpp"
+#include <algorithm>
+
+namespace trajectory_generation{
+
+/** Number of DOF processed in one block, i.e. one word of the violation mask*/
+static const size_t BLOCK_SIZE = 64;
+
+void clampToLimits(const double* min, const double* max, double* values, const size_t n, ViolationMask& clamped){
+    for(size_t offset = 0, word = 0; offset < n; offset += BLOCK_SIZE, word++){
+        const size_t len = std::min(BLOCK_SIZE, n - offset);
+        uint64_t bits = 0;
+        for(size_t i = 0; i < len; i++){
+            const double v = values[offset + i], lo = min[offset + i], hi = max[offset + i];
+            bits |= uint64_t((v > hi) | (v < lo)) << i;
+            values[offset + i] = std::max(std::min(v, hi), lo);
+        }
+        clamped.setWord(word, bits);
+    }
+}
+
+void checkLimits(const double* min, const double* max, const double* values, const size_t n, ViolationMask& violations){
+    for(size_t offset = 0, word = 0; offset < n; offset += BLOCK_SIZE, word++){
+        const size_t len = std::min(BLOCK_SIZE, n - offset);
+        uint64_t bits = 0;
+        for(size_t i = 0; i < len; i++){
+            const double v = values[offset + i];
+            bits |= uint64_t((v > max[offset + i]) | (v < min[offset + i])) << i;
+        }
+        violations.setWord(word, bits);
+    }
+}
+
+void zeroVelocityAtLimits(const double cycle_time, const double* min, const double* max, const double* position,
+                          double* velocity, const size_t n, ViolationMask& modified){
+    for(size_t offset = 0, word = 0; offset < n; offset += BLOCK_SIZE, word++){
+        const size_t len = std::min(BLOCK_SIZE, n - offset);
+        uint64_t bits = 0;
+        for(size_t i = 0; i < len; i++){
+            const double next = position[offset + i] + velocity[offset + i]*cycle_time;
+            const bool flag = (next > max[offset + i]) | (next < min[offset + i]);
+            bits |= uint64_t(flag) << i;
+            velocity[offset + i] = flag ? 0.0 : velocity[offset + i];
+        }
+        modified.setWord(word, bits);
+    }
+}
+
+}
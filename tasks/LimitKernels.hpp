@@ -0,0 +1,64 @@
+#ifndef LIMIT_KERNELS_HPP
+#define LIMIT_KERNELS_HPP
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace trajectory_generation{
+
+/** Bitmask with one bit per DOF, e.g. to mark the DOF that violate their limits*/
+class ViolationMask{
+    std::vector<uint64_t> words;
+    size_t n_dof;
+public:
+    ViolationMask(const size_t n = 0){resize(n);}
+
+    /** Set number of DOF and clear all bits. Allocates memory, so call this only at configuration time*/
+    void resize(const size_t n){n_dof = n; words.assign((n + 63) / 64, 0);}
+    void clear(){std::fill(words.begin(), words.end(), 0);}
+    size_t size() const {return n_dof;}
+
+    /** Set bit idx if flag is true. Does not clear the bit otherwise*/
+    void set(const size_t idx, const bool flag = true){words[idx >> 6] |= uint64_t(flag) << (idx & 63);}
+    /** Set the bits of DOF 64*k to 64*k+63 at once. Bits beyond size() have to be zero*/
+    void setWord(const size_t k, const uint64_t bits){words[k] = bits;}
+    bool test(const size_t idx) const {return (words[idx >> 6] >> (idx & 63)) & 1;}
+    bool any() const {
+        uint64_t res = 0;
+        for(size_t i = 0; i < words.size(); i++)
+            res |= words[i];
+        return res != 0;
+    }
+    /** Number of set bits*/
+    size_t count() const {
+        size_t res = 0;
+        for(size_t i = 0; i < words.size(); i++)
+            res += __builtin_popcountll(words[i]);
+        return res;
+    }
+    bool operator==(const ViolationMask& other) const {return n_dof == other.n_dof && words == other.words;}
+    bool operator!=(const ViolationMask& other) const {return !(*this == other);}
+    /** Raw bit words, bit i of word k belongs to DOF 64*k+i*/
+    const std::vector<uint64_t>& data() const {return words;}
+};
+
+/** The kernels below work on contiguous arrays of n elements (e.g. the data of the RML vectors). They are branch-free loops that the
+ *  compiler can vectorize (e.g. with -O3), so that they can be applied to all DOF of a high-DOF system in every cycle. Instead of stopping
+ *  at the first DOF that violates a limit, they mark all violating DOF in the given mask (which has to be of size n). Each block of 64 DOF
+ *  is written to the mask as one word. See test/benchmark_limit_kernels.cpp for a comparison with the scalar loops.*/
+
+/** Clamp values to [min,max]. Marks the DOF whose value has been modified*/
+void clampToLimits(const double* min, const double* max, double* values, const size_t n, ViolationMask& clamped);
+
+/** Mark the DOF whose value is outside of [min,max]*/
+void checkLimits(const double* min, const double* max, const double* values, const size_t n, ViolationMask& violations);
+
+/** Set the velocity to zero for all DOF that would leave [min,max] within the next cycle when moving with that velocity. Marks the modified DOF*/
+void zeroVelocityAtLimits(const double cycle_time, const double* min, const double* max, const double* position,
+                          double* velocity, const size_t n, ViolationMask& modified);
+
+}
+
+#endif
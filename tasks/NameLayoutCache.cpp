@@ -0,0 +1,74 @@
+#include "NameLayoutCache.hpp"
+
+namespace trajectory_generation{
+
+NameLayoutCache::NameLayoutCache() : layout_hash(0), layout_size(0), valid(false), first_missing(-1), n_hits(0), n_misses(0){
+}
+
+void NameLayoutCache::configure(const std::vector<std::string>& names){
+    configured_names = names;
+    permutation.assign(names.size(), -1);
+    n_hits = n_misses = 0;
+    reset();
+}
+
+void NameLayoutCache::reset(){
+    valid = false;
+    layout_hash = 0;
+    layout_size = 0;
+}
+
+uint64_t NameLayoutCache::hash(const std::vector<std::string>& names){
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t h = 14695981039346656037ULL;
+    for(size_t i = 0; i < names.size(); i++){
+        const std::string& name = names[i];
+        for(size_t j = 0; j < name.size(); j++){
+            h ^= (unsigned char)name[j];
+            h *= prime;
+        }
+        // Include the length, so that e.g. {"ab","c"} and {"a","bc"} have different hashes
+        h ^= name.size();
+        h *= prime;
+    }
+    return h;
+}
+
+bool NameLayoutCache::matches(const std::vector<std::string>& sample_names) const{
+    // Layouts with missing elements are always recomputed, a missing name might be contained in the new sample
+    if(first_missing >= 0)
+        return false;
+    for(size_t i = 0; i < configured_names.size(); i++){
+        if(sample_names[permutation[i]] != configured_names[i])
+            return false;
+    }
+    return true;
+}
+
+bool NameLayoutCache::update(const std::vector<std::string>& sample_names){
+    const uint64_t h = hash(sample_names);
+    if(valid && h == layout_hash && sample_names.size() == layout_size && matches(sample_names)){
+        n_hits++;
+        return true;
+    }
+
+    n_misses++;
+    first_missing = -1;
+    for(size_t i = 0; i < configured_names.size(); i++){
+        permutation[i] = -1;
+        for(size_t j = 0; j < sample_names.size(); j++){
+            if(sample_names[j] == configured_names[i]){
+                permutation[i] = j;
+                break;
+            }
+        }
+        if(permutation[i] < 0 && first_missing < 0)
+            first_missing = i;
+    }
+    layout_hash = h;
+    layout_size = sample_names.size();
+    valid = true;
+    return first_missing < 0;
+}
+
+}
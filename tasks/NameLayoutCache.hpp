@@ -0,0 +1,63 @@
+#ifndef NAME_LAYOUT_CACHE_HPP
+#define NAME_LAYOUT_CACHE_HPP
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+namespace trajectory_generation{
+
+/** Maps the elements of incoming samples (e.g. joint states) onto the configured element order. Usually, the name layout of a
+ *  data source does not change, so the mapping is computed once by name search and reused as long as the hash of the incoming
+ *  names stays the same and the mapped names still match. This replaces the O(n^2) string search per sample of
+ *  NamedVector::getElementByName() by a linear comparison.*/
+class NameLayoutCache{
+public:
+    NameLayoutCache();
+
+    /** Set the configured element names. Allocates memory, so call this only at configuration time*/
+    void configure(const std::vector<std::string>& names);
+
+    /** Update the mapping for the given sample names. Recomputes the mapping only if the layout has changed, i.e. if the hash or size
+     *  of the names differ, a mapped name does not match (hash collision) or the last layout was incomplete.
+     *  Returns true if all configured names are contained in the sample*/
+    bool update(const std::vector<std::string>& sample_names);
+
+    /** Index of configured element i in the last sample, -1 if it is not contained*/
+    int operator[](const size_t i) const {return permutation[i];}
+
+    /** Configured element names*/
+    const std::vector<std::string>& names() const {return configured_names;}
+
+    /** Number of configured elements*/
+    size_t size() const {return configured_names.size();}
+
+    /** Index of the first configured element that is missing in the last sample, -1 if none is missing*/
+    int firstMissing() const {return first_missing;}
+
+    uint64_t hits() const {return n_hits;}
+    uint64_t misses() const {return n_misses;}
+
+    /** Forget the cached layout, e.g. after reconfiguration of the data source*/
+    void reset();
+
+    /** 64 bit FNV-1a hash of the given names, including their lengths*/
+    static uint64_t hash(const std::vector<std::string>& names);
+
+protected:
+    /** True if the cached mapping is complete and maps each configured name onto the same name in sample_names*/
+    bool matches(const std::vector<std::string>& sample_names) const;
+
+    std::vector<std::string> configured_names;
+    std::vector<int> permutation;
+    uint64_t layout_hash;
+    size_t layout_size;
+    bool valid;
+    int first_missing;
+    uint64_t n_hits;
+    uint64_t n_misses;
+};
+
+}
+
+#endif
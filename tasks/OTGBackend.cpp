@@ -0,0 +1,18 @@
+#include "OTGBackend.hpp"
+#include "SCurveBackend.hpp"
+#include <stdexcept>
+
+namespace trajectory_generation{
+
+OTGBackend* createOTGBackend(const OTGBackendType type, const unsigned int n_dof, const double cycle_time){
+    switch(type){
+    case OTG_BACKEND_REFLEXXES:
+        return new ReflexxesBackend(n_dof, cycle_time);
+    case OTG_BACKEND_SCURVE:
+        return new SCurveBackend(n_dof, cycle_time);
+    default:
+        throw std::invalid_argument("Invalid OTG backend type");
+    }
+}
+
+}
@@ -0,0 +1,57 @@
+#ifndef OTG_BACKEND_HPP
+#define OTG_BACKEND_HPP
+
+#include "trajectory_generationTypes.hpp"
+#include <ReflexxesAPI.h>
+#include <vector>
+
+namespace trajectory_generation{
+
+/** Interface to an online trajectory generation (OTG) algorithm. The signatures follow the ReflexxesAPI, so that
+ *  all backends work on the same RML input/output parameters and flags.*/
+class OTGBackend{
+public:
+    virtual ~OTGBackend(){}
+
+    /** Set the position limits and the behavior at the limits. Only used by backends that implement position limits themselves,
+     *  the Reflexxes backend takes the limits from the input parameters (Type IV only).*/
+    virtual void setPositionLimits(const std::vector<double>& min_position,
+                                   const std::vector<double>& max_position,
+                                   const PositionalLimitsBehavior behavior){}
+
+    /** Take over the internal state of other, so that this backend continues the trajectory of other exactly, e.g. on a scratch copy of
+     *  the interpolator. Backends that compute each step from the input parameters only (Reflexxes) do not have to implement this.
+     *  Backends of a different type are ignored.*/
+    virtual void copyState(const OTGBackend& other){}
+
+    /** Perform one step of position based OTG. Returns one of the ReflexxesResultValue values*/
+    virtual int RMLPosition(const RMLPositionInputParameters& in,
+                            RMLPositionOutputParameters* out,
+                            const RMLPositionFlags& flags) = 0;
+
+    /** Perform one step of velocity based OTG. Returns one of the ReflexxesResultValue values*/
+    virtual int RMLVelocity(const RMLVelocityInputParameters& in,
+                            RMLVelocityOutputParameters* out,
+                            const RMLVelocityFlags& flags) = 0;
+};
+
+/** Backend that forwards all calls to the Reflexxes Motion Libraries*/
+class ReflexxesBackend : public OTGBackend{
+    ReflexxesAPI rml_api;
+public:
+    ReflexxesBackend(const unsigned int n_dof, const double cycle_time) : rml_api(n_dof, cycle_time){}
+
+    virtual int RMLPosition(const RMLPositionInputParameters& in, RMLPositionOutputParameters* out, const RMLPositionFlags& flags){
+        return rml_api.RMLPosition(in, out, flags);
+    }
+    virtual int RMLVelocity(const RMLVelocityInputParameters& in, RMLVelocityOutputParameters* out, const RMLVelocityFlags& flags){
+        return rml_api.RMLVelocity(in, out, flags);
+    }
+};
+
+/** Create an OTG backend of the given type. The caller takes ownership of the returned object.*/
+OTGBackend* createOTGBackend(const OTGBackendType type, const unsigned int n_dof, const double cycle_time);
+
+}
+
+#endif
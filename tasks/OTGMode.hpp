@@ -0,0 +1,32 @@
+#ifndef OTG_MODE_HPP
+#define OTG_MODE_HPP
+
+#include "OTGBackend.hpp"
+
+namespace trajectory_generation{
+
+/** Position based OTG. Selects the typed RML parameter objects and the backend call at compile time (see RMLTask::runCycle())*/
+struct PositionMode{
+    typedef RMLPositionInputParameters  InputParameters;
+    typedef RMLPositionOutputParameters OutputParameters;
+    typedef RMLPositionFlags            Flags;
+
+    static int run(OTGBackend& backend, const InputParameters& in, OutputParameters& out, const Flags& flags){
+        return backend.RMLPosition(in, &out, flags);
+    }
+};
+
+/** Velocity based OTG. Selects the typed RML parameter objects and the backend call at compile time (see RMLTask::runCycle())*/
+struct VelocityMode{
+    typedef RMLVelocityInputParameters  InputParameters;
+    typedef RMLVelocityOutputParameters OutputParameters;
+    typedef RMLVelocityFlags            Flags;
+
+    static int run(OTGBackend& backend, const InputParameters& in, OutputParameters& out, const Flags& flags){
+        return backend.RMLVelocity(in, &out, flags);
+    }
+};
+
+}
+
+#endif
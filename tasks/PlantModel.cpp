@@ -0,0 +1,65 @@
+#include "PlantModel.hpp"
+#include <algorithm>
+
+namespace trajectory_generation{
+
+PlantModel::PlantModel() : elapsed(0){
+}
+
+bool PlantModel::configure(const PlantModelConfig& cfg, const size_t n_dof){
+    if(cfg.initial_position.size() != 0 && (size_t)cfg.initial_position.size() != n_dof)
+        return false;
+    if(cfg.type == PLANT_FIRST_ORDER_LAG && !(cfg.time_constant >= 0))
+        return false;
+    if(cfg.type == PLANT_SATURATING && !(cfg.max_speed > 0))
+        return false;
+    if(cfg.type == PLANT_COMPLIANT_OFFSET && ((size_t)cfg.offset.size() != n_dof || !(cfg.offset_delay >= 0)))
+        return false;
+
+    config = cfg;
+    if(config.initial_position.size() == 0)
+        config.initial_position.setZero(n_dof);
+    reset();
+    return true;
+}
+
+void PlantModel::reset(){
+    pos = reference = config.initial_position;
+    elapsed = 0;
+}
+
+void PlantModel::step(const base::commands::Joints& command, const double dt, base::samples::Joints& state){
+    state.resize(pos.size());
+    for(int i = 0; i < pos.size(); i++){
+        const base::JointState& cmd = command[i];
+        if(!base::isNaN(cmd.position))
+            reference(i) = cmd.position;
+        else if(!base::isNaN(cmd.speed))
+            reference(i) += cmd.speed * dt;
+        const double target = reference(i);
+
+        const double prev = pos(i);
+        switch(config.type){
+        case PLANT_FIRST_ORDER_LAG:
+            if(config.time_constant + dt > 0)
+                pos(i) += dt / (config.time_constant + dt) * (target - pos(i));
+            break;
+        case PLANT_SATURATING:
+            pos(i) += std::max(-config.max_speed * dt, std::min(config.max_speed * dt, target - pos(i)));
+            break;
+        case PLANT_COMPLIANT_OFFSET:
+            pos(i) = target;
+            if(elapsed >= config.offset_delay)
+                pos(i) += config.offset(i);
+            break;
+        default:
+            pos(i) = target;
+            break;
+        }
+        state[i].position = pos(i);
+        state[i].speed    = dt > 0 ? (pos(i) - prev) / dt : 0;
+    }
+    elapsed += dt;
+}
+
+}
@@ -0,0 +1,39 @@
+#ifndef PLANT_MODEL_HPP
+#define PLANT_MODEL_HPP
+
+#include "trajectory_generationTypes.hpp"
+#include <base/commands/Joints.hpp>
+#include <base/samples/Joints.hpp>
+
+namespace trajectory_generation{
+
+/** Simple dynamic model of a joint space plant that is driven by the commands of a trajectory generator. Commands without
+ *  valid position (velocity based interpolators with convert_to_position set to false) are integrated from the commanded speed.*/
+class PlantModel{
+public:
+    PlantModel();
+
+    /** Set the model and the number of joints and reset the plant to the initial position. Returns false if the configuration
+     *  is invalid. Allocates memory, so call this only at configuration time*/
+    bool configure(const PlantModelConfig& config, const size_t n_dof);
+
+    /** Reset the plant to the initial position*/
+    void reset();
+
+    /** Advance the plant by dt seconds with the given command and write the new plant state (position and speed) to state.
+     *  The command has to contain n_dof elements in the configured joint order*/
+    void step(const base::commands::Joints& command, const double dt, base::samples::Joints& state);
+
+    /** Current plant positions*/
+    const base::VectorXd& position() const {return pos;}
+
+protected:
+    PlantModelConfig config;
+    base::VectorXd pos;
+    base::VectorXd reference; /** Commanded positions, integrated from the commanded speed if the command contains no positions*/
+    double elapsed; /** Simulated time since the first step*/
+};
+
+}
+
+#endif
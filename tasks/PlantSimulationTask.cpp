@@ -0,0 +1,82 @@
+/* Generated from orogen/lib/orogen/templates/tasks/Task.cpp */
+
+#include "PlantSimulationTask.hpp"
+#include <base-logging/Logging.hpp>
+
+using namespace trajectory_generation;
+
+bool PlantSimulationTask::configureHook(){
+    if (! PlantSimulationTaskBase::configureHook())
+        return false;
+
+    const joint_control_base::MotionConstraints constraints = _motion_constraints.get();
+    if(constraints.size() != constraints.names.size()){
+        LOG_ERROR("Number of elements in motion constraints must be same as size of the names vector");
+        return false;
+    }
+    n_dof = constraints.size();
+    if(!plant.configure(_plant.get(), n_dof)){
+        LOG_ERROR("%s: Invalid plant configuration. Initial position and offset have to have the same size as the motion constraints, "
+                  "time_constant and offset_delay must not be negative, max_speed has to be positive", this->getName().c_str());
+        return false;
+    }
+    checker.configure(constraints, _check_tolerance.get(), _check_jerk.get());
+
+    command.resize(n_dof);
+    joint_state.resize(n_dof);
+    joint_state.names = constraints.names;
+    _joint_state.setDataSample(joint_state);
+    _simulation_result.setDataSample(checker.getResult());
+    return true;
+}
+
+bool PlantSimulationTask::startHook(){
+    if (! PlantSimulationTaskBase::startHook())
+        return false;
+    resetSimulation();
+    return true;
+}
+
+void PlantSimulationTask::updateHook(){
+    PlantSimulationTaskBase::updateHook();
+
+    double computation_time;
+    while(_computation_time.read(computation_time) == RTT::NewData)
+        checker.addComputationTime(computation_time);
+
+    while(_command.read(command) == RTT::NewData){
+        if(command.size() != n_dof){
+            LOG_ERROR("%s: Received command with %i elements, expected %i", this->getName().c_str(), (int)command.size(), (int)n_dof);
+            continue;
+        }
+        const double dt = last_command_time.isNull() ? 0 : (command.time - last_command_time).toSeconds();
+        last_command_time = command.time;
+
+        plant.step(command, dt, joint_state);
+        checker.update(command, joint_state, dt);
+
+        // Use the time of the command, so that the plant runs on the same clock as the trajectory generator
+        joint_state.time = command.time;
+        _joint_state.write(joint_state);
+
+        PlantSimulationResult result = checker.getResult();
+        result.time = command.time;
+        _simulation_result.write(result);
+    }
+}
+
+void PlantSimulationTask::resetSimulation(){
+    plant.reset();
+    checker.reset();
+    last_command_time = base::Time();
+    writeInitialState();
+}
+
+void PlantSimulationTask::writeInitialState(){
+    for(size_t i = 0; i < n_dof; i++){
+        joint_state[i].position = plant.position()(i);
+        joint_state[i].speed = 0;
+    }
+    joint_state.time = base::Time();
+    _joint_state.write(joint_state);
+}
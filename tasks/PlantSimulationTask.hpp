@@ -0,0 +1,45 @@
+/* Generated from orogen/lib/orogen/templates/tasks/Task.hpp */
+
+#ifndef TRAJECTORY_GENERATION_PLANTSIMULATIONTASK_TASK_HPP
+#define TRAJECTORY_GENERATION_PLANTSIMULATIONTASK_TASK_HPP
+
+#include "trajectory_generation/PlantSimulationTaskBase.hpp"
+#include "PlantModel.hpp"
+#include "TrajectoryChecker.hpp"
+
+namespace trajectory_generation{
+
+/** Simulated joint space plant for closed-loop tests of the trajectory generators. Applies each received command to a plant model,
+ *  writes the resulting joint state and checks the commands for continuity and compliance with the motion constraints.*/
+class PlantSimulationTask : public PlantSimulationTaskBase
+{
+    friend class PlantSimulationTaskBase;
+
+    PlantModel plant;                        /** Dynamic model of the plant*/
+    TrajectoryChecker checker;               /** Checks of the received commands*/
+    base::commands::Joints command;          /** From input port: Command of the trajectory generator*/
+    base::samples::Joints joint_state;       /** To output port: Simulated joint state*/
+    base::Time last_command_time;            /** Time stamp of the previous command, null if no command has been received yet*/
+    size_t n_dof;
+
+    /** Write the current plant position to the joint_state port*/
+    void writeInitialState();
+
+protected:
+    /** Reset plant and check results*/
+    virtual void resetSimulation();
+
+public:
+    PlantSimulationTask(std::string const& name = "trajectory_generation::PlantSimulationTask") : PlantSimulationTaskBase(name), n_dof(0){}
+    PlantSimulationTask(std::string const& name, RTT::ExecutionEngine* engine) : PlantSimulationTaskBase(name, engine), n_dof(0){}
+    ~PlantSimulationTask(){}
+    bool configureHook();
+    bool startHook();
+    void updateHook();
+    void errorHook(){PlantSimulationTaskBase::errorHook();}
+    void stopHook(){PlantSimulationTaskBase::stopHook();}
+    void cleanupHook(){PlantSimulationTaskBase::cleanupHook();}
+};
+}
+
+#endif
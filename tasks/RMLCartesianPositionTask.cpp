@@ -2,97 +2,104 @@
 
 #include "RMLCartesianPositionTask.hpp"
 #include <base-logging/Logging.hpp>
+#include "RMLTaskCycle.hpp"
 #include "Conversions.hpp"
+#include "FixedSizeConversions.hpp"
 
 using namespace trajectory_generation;
 
 bool RMLCartesianPositionTask::configureHook(){
-    if(_motion_constraints.get().size() != 6){
-        LOG_ERROR("Size of motion constraint must be 6, but is %i", _motion_constraints.get().size());
+    if(_motion_constraints.get().size() != CARTESIAN_DOF){
+        LOG_ERROR("Size of motion constraint must be %i, but is %i", CARTESIAN_DOF, _motion_constraints.get().size());
         return false;
     }
 
     rml_flags = new RMLPositionFlags();
-    rml_input_parameters = new RMLPositionInputParameters(_motion_constraints.get().size());
-    rml_output_parameters = new RMLPositionOutputParameters(_motion_constraints.get().size());
+    rml_input_parameters = new RMLPositionInputParameters(CARTESIAN_DOF);
+    rml_output_parameters = new RMLPositionOutputParameters(CARTESIAN_DOF);
+    query_snapshot = new RMLPositionInputParameters(CARTESIAN_DOF);
+
+    if(!workspace_limits.configure(_workspace_constraints.get())){
+        LOG_ERROR("%s: Invalid workspace constraints: Normals must be non-zero, radii and tolerance positive and max_iterations > 0",
+                  this->getName().c_str());
+        return configureFailed();
+    }
 
     if (! RMLCartesianPositionTaskBase::configureHook())
         return false;
+    if(!configureMode<Mode>())
+        return configureFailed();
     return true;
 }
 
+bool RMLCartesianPositionTask::startHook(){
+    if (! RMLCartesianPositionTaskBase::startHook())
+        return false;
+    warmUp<Mode>();
+    return true;
+}
 
-void RMLCartesianPositionTask::updateMotionConstraints(const MotionConstraint& constraint,
-                                                       const size_t idx,
-                                                       RMLInputParameters* new_input_parameters){
-    motionConstraint2RmlTypes(constraint, idx, *(RMLPositionInputParameters*)new_input_parameters);
+void RMLCartesianPositionTask::updateHook(){
+    RMLCartesianPositionTaskBase::updateHook();
+    runCycle(*this);
 }
 
-bool RMLCartesianPositionTask::updateCurrentState(RMLInputParameters* new_input_parameters){
+
+bool RMLCartesianPositionTask::updateCurrentState(RMLPositionInputParameters& new_input_parameters){
     RTT::FlowStatus fs = _cartesian_state.readNewest(cartesian_state);
     if(fs == RTT::NewData && !has_current_state){
-        cartesianState2RmlTypes(cartesian_state, *new_input_parameters);
+        if(cartesianState2RmlTypes(cartesian_state, new_input_parameters, validation_error) != VALIDATION_OK){
+            reportValidationError(_cartesian_state.getName());
+            return false;
+        }
         current_sample.frame_id = cartesian_state.frame_id;
-        rmlTypes2CartesianState(*new_input_parameters, current_sample);
+        rmlTypes2CartesianState(new_input_parameters, current_sample);
         has_current_state = true;
     }
     if(fs != RTT::NoData){
-        current_sample.time = base::Time::now();
+        current_sample.time = now();
         _current_sample.write(current_sample);
     }
     return has_current_state;
 }
 
-bool RMLCartesianPositionTask::updateTarget(RMLInputParameters* new_input_parameters){
+bool RMLCartesianPositionTask::updateTarget(RMLPositionInputParameters& new_input_parameters){
     RTT::FlowStatus fs = _target.readNewest(target);
     if(fs == RTT::NewData){
-        has_target = true;
-        target2RmlTypes(target, *(RMLPositionInputParameters*)new_input_parameters);
-#ifdef USING_REFLEXXES_TYPE_IV
+        if(!workspace_limits.empty() && target.hasValidPosition() && !workspace_limits.project(target.position)){
+            validation_error.status = VALIDATION_WORKSPACE_LIMITS;
+            validation_error.name = "position";
+            validation_error.value = base::NaN<double>();
+            reportValidationError(_target.getName());
+            return has_target;
+        }
+        // Invalid samples are rejected without modifying the input parameters, i.e. the previous target remains active
+        if(target2RmlTypes(target, new_input_parameters, validation_error) != VALIDATION_OK){
+            reportValidationError(_target.getName());
+            return has_target;
+        }
+        has_target = target_changed = true;
         // Crop at limits if POSITIONAL_LIMITS_ACTIVELY_PREVENT is selected, otherwise RML will throw a positional limits error
-        if(rml_flags->PositionalLimitsBehavior == POSITIONAL_LIMITS_ACTIVELY_PREVENT)
-            cropTargetAtPositionLimits(*(RMLPositionInputParameters*)new_input_parameters);
-#endif
+        if(positional_limits_behavior == POSITIONAL_LIMITS_ACTIVELY_PREVENT)
+            cropTargetAtPositionLimits(min_position, max_position, new_input_parameters, limit_violations);
     }
     return has_target;
 }
 
-ReflexxesResultValue RMLCartesianPositionTask::performOTG(RMLInputParameters* new_input_parameters,
-                                                          RMLOutputParameters* new_output_parameters,
-                                                          RMLFlags *rml_flags){
-
-    int result = rml_api->RMLPosition( *(RMLPositionInputParameters*)new_input_parameters,
-                                       (RMLPositionOutputParameters*)new_output_parameters,
-                                       *(RMLPositionFlags*)rml_flags );
-
-    // Always feed back the new state as the current state. This means that the current robot position
-    // is completely ignored. However, on a real robot, using the current position as input in RML will NOT work!
-    *new_input_parameters->CurrentPositionVector     = *new_output_parameters->NewPositionVector;
-    *new_input_parameters->CurrentVelocityVector     = *new_output_parameters->NewVelocityVector;
-    *new_input_parameters->CurrentAccelerationVector = *new_output_parameters->NewAccelerationVector;
-
-    return (ReflexxesResultValue)result;
-}
-
-void RMLCartesianPositionTask::writeCommand(const RMLOutputParameters& new_output_parameters){
-    rmlTypes2Command((RMLPositionOutputParameters&)new_output_parameters, command);
-    rmlTypes2CartesianState(*rml_input_parameters, current_sample);
-    current_sample.time = command.time = base::Time::now();
+void RMLCartesianPositionTask::writeCommand(const RMLPositionOutputParameters& new_output_parameters){
+    rmlTypes2PositionCommand(new_output_parameters, command, current_sample);
+    current_sample.time = command.time = now();
     command.frame_id = target.targetFrame;
     _command.write(command);
 }
 
-void RMLCartesianPositionTask::printParams(const RMLInputParameters& in, const RMLOutputParameters& out){
-    ((RMLPositionInputParameters&  )in).Echo();
-    ((RMLPositionOutputParameters& )out).Echo();
-}
-
-const ReflexxesInputParameters& RMLCartesianPositionTask::convertRMLInputParams(const RMLInputParameters &in, ReflexxesInputParameters& out){
-    rmlTypes2InputParams((RMLPositionInputParameters&)in, out);
-    return out;
+void RMLCartesianPositionTask::presizeSamples(){
+    _command.setDataSample(command);
+    _current_sample.setDataSample(current_sample);
 }
 
-const ReflexxesOutputParameters& RMLCartesianPositionTask::convertRMLOutputParams(const RMLOutputParameters &in, ReflexxesOutputParameters& out){
-    rmlTypes2OutputParams((RMLPositionOutputParameters&)in, out);
-    return out;
+std::vector<TargetEvaluation> RMLCartesianPositionTask::evaluateTargets(const std::vector<base::samples::RigidBodyState>& targets){
+    return evaluatePositionTargets(targets.size(), [&](size_t i, RMLPositionInputParameters& params, InputValidationError& error){
+        return target2RmlTypes(targets[i], params, error);
+    });
 }
@@ -4,46 +4,43 @@
 #define TRAJECTORY_GENERATION_RMLCARTESIANPOSITIONTASK_TASK_HPP
 
 #include "trajectory_generation/RMLCartesianPositionTaskBase.hpp"
+#include "WorkspaceLimits.hpp"
 
 namespace trajectory_generation{
 
 class RMLCartesianPositionTask : public RMLCartesianPositionTaskBase
 {
     friend class RMLCartesianPositionTaskBase;
+    friend class RMLTask;
 
     base::samples::RigidBodyStateSE3 cartesian_state;  /** Current Cartesian state. Will only be used for initializing RML */
     base::samples::RigidBodyStateSE3 current_sample;   /** Current Cartesian interpolator status (position/speed)*/
     base::samples::RigidBodyState target;              /** Target Cartesian position or speed.  */
     base::samples::RigidBodyStateSE3 command;          /** Commanded Cartesian position/speed.  */
+    WorkspaceLimits workspace_limits;                  /** Constraints on the target position*/
 
 protected:
-    /** Update the motion constraints of a particular element*/
-    virtual void updateMotionConstraints(const MotionConstraint& constraint,
-                                         const size_t idx,
-                                         RMLInputParameters* new_input_parameters);
+    typedef PositionMode Mode;
 
     /** Read the current state from port and return position and flow status*/
-    virtual bool updateCurrentState(RMLInputParameters* new_input_parameters);
+    bool updateCurrentState(RMLPositionInputParameters& new_input_parameters);
 
     /** Update the RML input parameters with the new target */
-    virtual bool updateTarget(RMLInputParameters* new_input_parameters);
+    bool updateTarget(RMLPositionInputParameters& new_input_parameters);
 
     /** Perform one step of online trajectory generation (call the RML algorithm with the given parameters). Return the RML result value*/
-    virtual ReflexxesResultValue performOTG(RMLInputParameters* new_input_parameters,
-                                            RMLOutputParameters* new_output_parameters,
-                                            RMLFlags *rml_flags);
+    ReflexxesResultValue performOTG(RMLPositionInputParameters& new_input_parameters,
+                                    RMLPositionOutputParameters& new_output_parameters,
+                                    const RMLPositionFlags& rml_flags){return stepOTG<Mode>(new_input_parameters, new_output_parameters, rml_flags);}
 
     /** Write the generated trajectory to port*/
-    virtual void writeCommand(const RMLOutputParameters& new_output_parameters);
+    void writeCommand(const RMLPositionOutputParameters& new_output_parameters);
 
-    /** Call echo() method for rml input and output parameters*/
-    virtual void printParams(const RMLInputParameters& in, const RMLOutputParameters& out);
+    /** Pre-size the port samples, so that the first writes do not allocate memory*/
+    virtual void presizeSamples();
 
-    /** Convert from RMLInputParameters to orogen type*/
-    virtual const ReflexxesInputParameters& convertRMLInputParams(const RMLInputParameters &in, ReflexxesInputParameters& out);
-
-    /** Convert from RMLOutputParameters to orogen type*/
-    virtual const ReflexxesOutputParameters& convertRMLOutputParams(const RMLOutputParameters &in, ReflexxesOutputParameters& out);
+    /** Compute the time needed to reach each of the given targets from the current interpolator state*/
+    virtual std::vector<TargetEvaluation> evaluateTargets(const std::vector<base::samples::RigidBodyState>& targets);
 
 
 public:
@@ -51,8 +48,8 @@ public:
     RMLCartesianPositionTask(std::string const& name, RTT::ExecutionEngine* engine) : RMLCartesianPositionTaskBase(name, engine){}
     ~RMLCartesianPositionTask(){}
     bool configureHook();
-    bool startHook(){return RMLCartesianPositionTaskBase::startHook();}
-    void updateHook(){RMLCartesianPositionTaskBase::updateHook();}
+    bool startHook();
+    void updateHook();
     void errorHook(){RMLCartesianPositionTaskBase::errorHook();}
     void stopHook(){RMLCartesianPositionTaskBase::stopHook();}
     void cleanupHook(){RMLCartesianPositionTaskBase::cleanupHook();}
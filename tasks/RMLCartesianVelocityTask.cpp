@@ -2,19 +2,21 @@
 
 #include "RMLCartesianVelocityTask.hpp"
 #include <base-logging/Logging.hpp>
+#include "RMLTaskCycle.hpp"
 #include "Conversions.hpp"
+#include "FixedSizeConversions.hpp"
 
 using namespace trajectory_generation;
 
 bool RMLCartesianVelocityTask::configureHook(){
-    if(_motion_constraints.get().size() != 6){
-        LOG_ERROR("Size of motion constraint must be 6, but is %i", _motion_constraints.get().size());
+    if(_motion_constraints.get().size() != CARTESIAN_DOF){
+        LOG_ERROR("Size of motion constraint must be %i, but is %i", CARTESIAN_DOF, _motion_constraints.get().size());
         return false;
     }
 
     rml_flags = new RMLVelocityFlags();
-    rml_input_parameters = new RMLVelocityInputParameters(_motion_constraints.get().size());
-    rml_output_parameters = new RMLVelocityOutputParameters(_motion_constraints.get().size());
+    rml_input_parameters = new RMLVelocityInputParameters(CARTESIAN_DOF);
+    rml_output_parameters = new RMLVelocityOutputParameters(CARTESIAN_DOF);
 
     no_reference_timeout = _no_reference_timeout.get();
     if(base::isNaN(no_reference_timeout))
@@ -23,19 +25,30 @@ bool RMLCartesianVelocityTask::configureHook(){
 
     if (! RMLCartesianVelocityTaskBase::configureHook())
         return false;
+    if(!configureMode<Mode>())
+        return configureFailed();
     return true;
 }
 
-void RMLCartesianVelocityTask::updateMotionConstraints(const MotionConstraint& constraint,
-                                                       const size_t idx,
-                                                       RMLInputParameters* new_input_parameters){
-    motionConstraint2RmlTypes(constraint, idx, *(RMLVelocityInputParameters*)new_input_parameters);
+bool RMLCartesianVelocityTask::startHook(){
+    if (! RMLCartesianVelocityTaskBase::startHook())
+        return false;
+    warmUp<Mode>();
+    return true;
+}
+
+void RMLCartesianVelocityTask::updateHook(){
+    RMLCartesianVelocityTaskBase::updateHook();
+    runCycle(*this);
 }
 
-bool RMLCartesianVelocityTask::updateCurrentState(RMLInputParameters* new_input_parameters){
+bool RMLCartesianVelocityTask::updateCurrentState(RMLVelocityInputParameters& new_input_parameters){
     RTT::FlowStatus fs = _cartesian_state.readNewest(cartesian_state);
     if(fs == RTT::NewData && !has_current_state){
-        cartesianState2RmlTypes(cartesian_state, *new_input_parameters);
+        if(cartesianState2RmlTypes(cartesian_state, new_input_parameters, validation_error) != VALIDATION_OK){
+            reportValidationError(_cartesian_state.getName());
+            return false;
+        }
         current_sample.frame_id = cartesian_state.frame_id;
         current_sample = cartesian_state;
         has_current_state = true;
@@ -47,62 +60,37 @@ bool RMLCartesianVelocityTask::updateCurrentState(RMLInputParameters* new_input_
     return has_current_state;
 }
 
-bool RMLCartesianVelocityTask::updateTarget(RMLInputParameters* new_input_parameters){
+bool RMLCartesianVelocityTask::updateTarget(RMLVelocityInputParameters& new_input_parameters){
     RTT::FlowStatus fs = _target.readNewest(target);
     if(fs == RTT::NewData){
-        has_target = true;
-        target2RmlTypes(target, *(RMLVelocityInputParameters*)new_input_parameters);
-#ifdef USING_REFLEXXES_TYPE_IV
+        // Invalid samples are rejected without modifying the input parameters, i.e. the previous target remains active
+        if(target2RmlTypes(target, new_input_parameters, validation_error) != VALIDATION_OK){
+            reportValidationError(_target.getName());
+            return has_target;
+        }
+        has_target = target_changed = true;
         // Workaround: If an element is close to a position limit and the target velocity is pointing in direction of the limit, the sychronization time is computed by
         // reflexxes as if the constrained joint could move freely in the direction of the limit. This leads to incorrect synchronization time for all other elements.
         // Set the target velocity to zero in this case!
-        if(rml_flags->PositionalLimitsBehavior == POSITIONAL_LIMITS_ACTIVELY_PREVENT)
-            fixRmlSynchronizationBug(cycle_time, *(RMLVelocityInputParameters*)new_input_parameters);
-#endif
+        if(positional_limits_behavior == POSITIONAL_LIMITS_ACTIVELY_PREVENT)
+            fixRmlSynchronizationBug(cycle_time, min_position, max_position, new_input_parameters, limit_violations);
     }
     return has_target;
 }
 
-ReflexxesResultValue RMLCartesianVelocityTask::performOTG(RMLInputParameters* new_input_parameters,
-                                                          RMLOutputParameters* new_output_parameters,
-                                                          RMLFlags *rml_flags){
-
-    int result = rml_api->RMLVelocity(*(RMLVelocityInputParameters*)new_input_parameters,
-                                      (RMLVelocityOutputParameters*)new_output_parameters,
-                                      *(RMLVelocityFlags*)rml_flags );
-
-    // Always feed back the new state as the current state. This means that the current robot position
-    // is completely ignored. However, on a real robot, using the current position as input in RML will NOT work!
-    *new_input_parameters->CurrentPositionVector     = *new_output_parameters->NewPositionVector;
-    *new_input_parameters->CurrentVelocityVector     = *new_output_parameters->NewVelocityVector;
-    *new_input_parameters->CurrentAccelerationVector = *new_output_parameters->NewAccelerationVector;
-
-    return (ReflexxesResultValue)result;
-}
-
-void RMLCartesianVelocityTask::writeCommand(const RMLOutputParameters& new_output_parameters){
+void RMLCartesianVelocityTask::writeCommand(const RMLVelocityOutputParameters& new_output_parameters){
     if(convert_to_position)
-        rmlTypes2Command((RMLPositionOutputParameters&)new_output_parameters, command);
-    else
-        rmlTypes2Command((RMLVelocityOutputParameters&)new_output_parameters, command);
-
-    rmlTypes2Command((RMLPositionOutputParameters&)new_output_parameters, current_sample);
-    current_sample.time = command.time = base::Time::now();
+        rmlTypes2PositionCommand(new_output_parameters, command, current_sample);
+    else{
+        rmlTypes2Command(new_output_parameters, command);
+        rmlTypes2PositionCommand(new_output_parameters, current_sample);
+    }
+    current_sample.time = command.time = now();
     command.frame_id  = target.targetFrame;
     _command.write(command);
 }
 
-void RMLCartesianVelocityTask::printParams(const RMLInputParameters& in, const RMLOutputParameters& out){
-    ((RMLVelocityInputParameters&  )in).Echo();
-    ((RMLVelocityOutputParameters& )out).Echo();
-}
-
-const ReflexxesInputParameters& RMLCartesianVelocityTask::convertRMLInputParams(const RMLInputParameters &in, ReflexxesInputParameters& out){
-    rmlTypes2InputParams((RMLVelocityInputParameters&)in, out);
-    return out;
-}
-
-const ReflexxesOutputParameters& RMLCartesianVelocityTask::convertRMLOutputParams(const RMLOutputParameters &in, ReflexxesOutputParameters& out){
-    rmlTypes2OutputParams((RMLVelocityOutputParameters&)in, out);
-    return out;
+void RMLCartesianVelocityTask::presizeSamples(){
+    _command.setDataSample(command);
+    _current_sample.setDataSample(current_sample);
 }
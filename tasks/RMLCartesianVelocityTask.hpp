@@ -10,6 +10,7 @@ namespace trajectory_generation{
 class RMLCartesianVelocityTask : public RMLCartesianVelocityTaskBase
 {
     friend class RMLCartesianVelocityTaskBase;
+    friend class RMLTask;
 
     base::samples::RigidBodyStateSE3 cartesian_state;  /** Current Cartesian state. Will only be used for initializing RML */
     base::samples::RigidBodyStateSE3 current_sample;   /** Current Cartesian interpolator status (position/speed)*/
@@ -21,41 +22,32 @@ class RMLCartesianVelocityTask : public RMLCartesianVelocityTaskBase
     bool convert_to_position;
 
 protected:
-    /** Update the motion constraints of a particular element*/
-    virtual void updateMotionConstraints(const MotionConstraint& constraint,
-                                         const size_t idx,
-                                         RMLInputParameters* new_input_parameters);
+    typedef VelocityMode Mode;
 
     /** Read the current state from port and return position and flow status*/
-    virtual bool updateCurrentState(RMLInputParameters* new_input_parameters);
+    bool updateCurrentState(RMLVelocityInputParameters& new_input_parameters);
 
     /** Update the RML input parameters with the new target */
-    virtual bool updateTarget(RMLInputParameters* new_input_parameters);
+    bool updateTarget(RMLVelocityInputParameters& new_input_parameters);
 
     /** Perform one step of online trajectory generation (call the RML algorithm with the given parameters). Return the RML result value*/
-    virtual ReflexxesResultValue performOTG(RMLInputParameters* new_input_parameters,
-                                            RMLOutputParameters* new_output_parameters,
-                                            RMLFlags *rml_flags);
+    ReflexxesResultValue performOTG(RMLVelocityInputParameters& new_input_parameters,
+                                    RMLVelocityOutputParameters& new_output_parameters,
+                                    const RMLVelocityFlags& rml_flags){return stepOTG<Mode>(new_input_parameters, new_output_parameters, rml_flags);}
 
     /** Write the generated trajectory to port*/
-    virtual void writeCommand(const RMLOutputParameters& new_output_parameters);
+    void writeCommand(const RMLVelocityOutputParameters& new_output_parameters);
 
-    /** Call echo() method for rml input and output parameters*/
-    virtual void printParams(const RMLInputParameters& in, const RMLOutputParameters& out);
-
-    /** Convert from RMLInputParameters to orogen type*/
-    virtual const ReflexxesInputParameters& convertRMLInputParams(const RMLInputParameters &in, ReflexxesInputParameters& out);
-
-    /** Convert from RMLOutputParameters to orogen type*/
-    virtual const ReflexxesOutputParameters& convertRMLOutputParams(const RMLOutputParameters &in, ReflexxesOutputParameters& out);
+    /** Pre-size the port samples, so that the first writes do not allocate memory*/
+    virtual void presizeSamples();
 
 public:
     RMLCartesianVelocityTask(std::string const& name = "trajectory_generation::RMLCartesianVelocityTask") : RMLCartesianVelocityTaskBase(name){}
     RMLCartesianVelocityTask(std::string const& name, RTT::ExecutionEngine* engine) : RMLCartesianVelocityTaskBase(name, engine){}
     ~RMLCartesianVelocityTask(){}
     bool configureHook();
-    bool startHook(){return RMLCartesianVelocityTaskBase::startHook();}
-    void updateHook(){RMLCartesianVelocityTaskBase::updateHook();}
+    bool startHook();
+    void updateHook();
     void errorHook(){RMLCartesianVelocityTaskBase::errorHook();}
     void stopHook(){RMLCartesianVelocityTaskBase::stopHook();}
     void cleanupHook(){RMLCartesianVelocityTaskBase::cleanupHook();}
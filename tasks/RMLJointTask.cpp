@@ -0,0 +1,5 @@
+/* Generated from orogen/lib/orogen/templates/tasks/Task.cpp */
+
+#include "RMLJointTask.hpp"
+
+using namespace trajectory_generation;
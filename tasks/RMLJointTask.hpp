@@ -0,0 +1,23 @@
+/* Generated from orogen/lib/orogen/templates/tasks/Task.hpp */
+
+#ifndef TRAJECTORY_GENERATION_RMLJOINTTASK_TASK_HPP
+#define TRAJECTORY_GENERATION_RMLJOINTTASK_TASK_HPP
+
+#include "trajectory_generation/RMLJointTaskBase.hpp"
+
+namespace trajectory_generation{
+
+/** Common properties and ports of the joint space tasks (RMLPositionTask, RMLVelocityTask and RMLMixedTask). Their part of the cycle is
+ *  implemented by the joint space member templates of RMLTask, e.g. configureJointTask(), readJointState() and updateJointTarget()*/
+class RMLJointTask : public RMLJointTaskBase
+{
+    friend class RMLJointTaskBase;
+
+public:
+    RMLJointTask(std::string const& name = "trajectory_generation::RMLJointTask") : RMLJointTaskBase(name){}
+    RMLJointTask(std::string const& name, RTT::ExecutionEngine* engine) : RMLJointTaskBase(name, engine){}
+    ~RMLJointTask(){}
+};
+}
+
+#endif
@@ -0,0 +1,196 @@
+/* Generated from orogen/lib/orogen/templates/tasks/Task.cpp */
+
+#include "RMLMixedTask.hpp"
+#include <base-logging/Logging.hpp>
+#include "RMLTaskCycle.hpp"
+#include "Conversions.hpp"
+
+using namespace trajectory_generation;
+
+RMLMixedTask::RMLMixedTask(std::string const& name)
+    : RMLMixedTaskBase(name), target_merging(false), vel_backend(0), vel_input_parameters(0), vel_output_parameters(0), synchronize_modes(false), mode_sync_time(0), stretch_position(false),
+      mode_sync_pos_backend(0), mode_sync_vel_backend(0), mode_sync_pos_output(0), mode_sync_vel_output(0){
+}
+
+RMLMixedTask::RMLMixedTask(std::string const& name, RTT::ExecutionEngine* engine)
+    : RMLMixedTaskBase(name, engine), target_merging(false), vel_backend(0), vel_input_parameters(0), vel_output_parameters(0), synchronize_modes(false), mode_sync_time(0), stretch_position(false),
+      mode_sync_pos_backend(0), mode_sync_vel_backend(0), mode_sync_pos_output(0), mode_sync_vel_output(0){
+}
+
+bool RMLMixedTask::configureHook(){
+    rml_flags = new RMLPositionFlags();
+    rml_input_parameters = new RMLPositionInputParameters(_motion_constraints.get().size());
+    rml_output_parameters = new RMLPositionOutputParameters(_motion_constraints.get().size());
+    query_snapshot = new RMLPositionInputParameters(_motion_constraints.get().size());
+
+    if (! RMLMixedTaskBase::configureHook())
+        return false;
+    if(_command_preview_length.get() != 0){
+        LOG_ERROR("%s: The command preview is not supported by RMLMixedTask, command_preview_length must be 0", this->getName().c_str());
+        return configureFailed();
+    }
+    if(!configureMode<Mode>() || !configureJointTask(*this))
+        return configureFailed();
+
+    const uint n_dof = motion_constraints.size();
+    vel_input_parameters = new RMLVelocityInputParameters(n_dof);
+    vel_output_parameters = new RMLVelocityOutputParameters(n_dof);
+    memset(vel_input_parameters->SelectionVector->VecData, false, n_dof);
+    for(uint i = 0; i < n_dof; i++)
+        motionConstraint2RmlTypes(motion_constraints[i], i, *vel_input_parameters);
+    vel_flags.SynchronizationBehavior = rml_flags->SynchronizationBehavior;
+#ifdef USING_REFLEXXES_TYPE_IV
+    vel_flags.PositionalLimitsBehavior = rml_flags->PositionalLimitsBehavior;
+#endif
+    vel_backend = createBackend();
+
+    synchronize_modes = _synchronize_modes.get();
+    if(synchronize_modes){
+        mode_sync_pos_backend = createBackend();
+        mode_sync_vel_backend = createBackend();
+        mode_sync_pos_output = new RMLPositionOutputParameters(n_dof);
+        mode_sync_vel_output = new RMLVelocityOutputParameters(n_dof);
+    }
+    mode_sync_time = 0;
+    stretch_position = false;
+
+    return true;
+}
+
+bool RMLMixedTask::startHook(){
+    if (! RMLMixedTaskBase::startHook())
+        return false;
+    warmUp<Mode>();
+    return true;
+}
+
+void RMLMixedTask::updateHook(){
+    RMLMixedTaskBase::updateHook();
+    runCycle(*this);
+}
+
+void RMLMixedTask::cleanupHook(){
+    delete vel_backend;
+    delete vel_input_parameters;
+    delete vel_output_parameters;
+    delete mode_sync_pos_backend;
+    delete mode_sync_vel_backend;
+    delete mode_sync_pos_output;
+    delete mode_sync_vel_output;
+    vel_backend = mode_sync_pos_backend = mode_sync_vel_backend = 0;
+    vel_input_parameters = 0;
+    vel_output_parameters = 0;
+    mode_sync_pos_output = 0;
+    mode_sync_vel_output = 0;
+    RMLMixedTaskBase::cleanupHook();
+}
+
+bool RMLMixedTask::updateCurrentState(RMLPositionInputParameters& new_input_parameters){
+    readJointState(*this, new_input_parameters);
+    return has_current_state;
+}
+
+bool RMLMixedTask::updateTarget(RMLPositionInputParameters& new_input_parameters){
+    return updateJointTarget(*this, new_input_parameters, *vel_input_parameters);
+}
+
+static bool hasSelection(const RMLInputParameters& params){
+    for(uint i = 0; i < params.NumberOfDOFs; i++)
+        if(params.SelectionVector->VecData[i])
+            return true;
+    return false;
+}
+
+void RMLMixedTask::synchronizeModes(RMLPositionInputParameters& in, const RMLPositionFlags& flags){
+    RMLVelocityInputParameters& vel_in = *vel_input_parameters;
+
+    // Execution times of both sets of joints without mutual synchronization. Computed on scratch backends, so that the state of
+    // the actual backends is not affected. Only the faster set of joints is stretched, the slower one is time-optimal anyway
+    if(target_changed){
+        vel_in.MinimumSynchronizationTime = 0;
+        PositionMode::run(*mode_sync_pos_backend, in, *mode_sync_pos_output, flags);
+        VelocityMode::run(*mode_sync_vel_backend, vel_in, *mode_sync_vel_output, vel_flags);
+        const double pos_time = mode_sync_pos_output->SynchronizationTime, vel_time = mode_sync_vel_output->SynchronizationTime;
+        mode_sync_time = std::max(pos_time, vel_time);
+        stretch_position = pos_time < vel_time;
+        vel_in.MinimumSynchronizationTime = stretch_position ? 0 : mode_sync_time;
+    }
+    // Drop the stretch once both sets of joints have reached their targets, it must not affect a recomputation after a change of the current state
+    else if(rml_result_value == RML_FINAL_STATE_REACHED)
+        mode_sync_time = vel_in.MinimumSynchronizationTime = 0;
+
+    // The synchronization time is only computed once per target. The OTG algorithm treats an unchanged MinimumSynchronizationTime as
+    // unchanged input and continues the stretched motion, a shrinking value would trigger a new calculation in every cycle
+    if(stretch_position)
+        in.MinimumSynchronizationTime = std::max(in.MinimumSynchronizationTime, mode_sync_time);
+}
+
+ReflexxesResultValue RMLMixedTask::performOTG(RMLPositionInputParameters& new_input_parameters,
+                                              RMLPositionOutputParameters& new_output_parameters,
+                                              const RMLPositionFlags& rml_flags){
+    RMLVelocityInputParameters& vel_in = *vel_input_parameters;
+    RMLVelocityOutputParameters& vel_out = *vel_output_parameters;
+
+    if(!hasSelection(vel_in))
+        return stepOTG<Mode>(new_input_parameters, new_output_parameters, rml_flags);
+
+    // The velocity controlled joints start from the same state and use the same (possibly per-target or derated) motion constraints
+    *vel_in.CurrentPositionVector     = *new_input_parameters.CurrentPositionVector;
+    *vel_in.CurrentVelocityVector     = *new_input_parameters.CurrentVelocityVector;
+    *vel_in.CurrentAccelerationVector = *new_input_parameters.CurrentAccelerationVector;
+    *vel_in.MaxAccelerationVector     = *new_input_parameters.MaxAccelerationVector;
+    *vel_in.MaxJerkVector             = *new_input_parameters.MaxJerkVector;
+#ifdef USING_REFLEXXES_TYPE_IV
+    *vel_in.MaxPositionVector = *new_input_parameters.MaxPositionVector;
+    *vel_in.MinPositionVector = *new_input_parameters.MinPositionVector;
+#endif
+    // See fixRmlSynchronizationBug()
+    if(target_changed && positional_limits_behavior == POSITIONAL_LIMITS_ACTIVELY_PREVENT)
+        fixRmlSynchronizationBug(cycle_time, min_position, max_position, vel_in, limit_violations);
+
+    // MinimumSynchronizationTime may have been set by a deadline or sync group and is restored after this cycle
+    const double min_sync_time = new_input_parameters.MinimumSynchronizationTime;
+    if(synchronize_modes && hasSelection(new_input_parameters))
+        synchronizeModes(new_input_parameters, rml_flags);
+    else
+        vel_in.MinimumSynchronizationTime = 0;
+
+    const int vel_result = VelocityMode::run(*vel_backend, vel_in, vel_out, vel_flags);
+    const bool vel_fallback = needsFallback(vel_result) && runFallback<VelocityMode>(vel_in, vel_out, vel_flags, vel_result);
+    const ReflexxesResultValue pos_result = stepOTG<Mode>(new_input_parameters, new_output_parameters, rml_flags);
+    // The output is only valid if both sets of joints either succeeded or have been handled by the fallback
+    const bool pos_failed = pos_result < 0 && pos_result != RML_ERROR_SYNCHRONIZATION && !fallback_active;
+    const bool vel_failed = vel_result < 0 && vel_result != RML_ERROR_SYNCHRONIZATION && !vel_fallback;
+    if(pos_failed || vel_failed)
+        fallback_active = false;
+    else if(vel_fallback)
+        fallback_active = true;
+    new_input_parameters.MinimumSynchronizationTime = min_sync_time;
+
+    // Merge the velocity controlled joints into the output and feed back their new state as well
+    for(uint i = 0; i < vel_in.NumberOfDOFs; i++){
+        if(!vel_in.SelectionVector->VecData[i])
+            continue;
+        new_output_parameters.NewPositionVector->VecData[i]     = new_input_parameters.CurrentPositionVector->VecData[i]     = vel_out.NewPositionVector->VecData[i];
+        new_output_parameters.NewVelocityVector->VecData[i]     = new_input_parameters.CurrentVelocityVector->VecData[i]     = vel_out.NewVelocityVector->VecData[i];
+        new_output_parameters.NewAccelerationVector->VecData[i] = new_input_parameters.CurrentAccelerationVector->VecData[i] = vel_out.NewAccelerationVector->VecData[i];
+        new_output_parameters.ExecutionTimes->VecData[i]        = vel_out.ExecutionTimes->VecData[i];
+    }
+
+    if(pos_result < 0)
+        return pos_result;
+    if(vel_result < 0)
+        return (ReflexxesResultValue)vel_result;
+    if(pos_result == RML_WORKING || vel_result == RML_WORKING)
+        return RML_WORKING;
+    return RML_FINAL_STATE_REACHED;
+}
+
+void RMLMixedTask::writeCommand(const RMLPositionOutputParameters& new_output_parameters){
+    rmlTypes2Command(new_output_parameters, command);
+    writeJointCommand(*this);
+}
+
+void RMLMixedTask::presizeSamples(){
+    presizeJointSamples(*this);
+}
@@ -0,0 +1,78 @@
+/* Generated from orogen/lib/orogen/templates/tasks/Task.hpp */
+
+#ifndef TRAJECTORY_GENERATION_RMLMIXEDTASK_TASK_HPP
+#define TRAJECTORY_GENERATION_RMLMIXEDTASK_TASK_HPP
+
+#include "trajectory_generation/RMLMixedTaskBase.hpp"
+#include "JointTrajectoryGenerator.hpp"
+
+namespace trajectory_generation{
+
+/** Mixed position/velocity based trajectory generation in joint space. The task is position based (rml_input_parameters are
+ *  RMLPositionInputParameters). Velocity controlled joints are deselected there and computed by a second, velocity based OTG
+ *  instance, which starts from the same state and uses the same motion constraints. Its output is merged into the position
+ *  based output before the new state is fed back.*/
+class RMLMixedTask : public RMLMixedTaskBase
+{
+    friend class RMLMixedTaskBase;
+    friend class RMLTask;
+
+    base::samples::Joints joint_state;    /** From input port: Current joint state. Will only be used for initializing RML */
+    base::samples::Joints current_sample; /** From input port: Current joint interpolator status (position/speed/acceleration)*/
+    ConstrainedJointsCmd target;          /** From input port: Target joint position or speed. Contains only samples that passed validation*/
+    ConstrainedJointsCmd new_target;      /** From input port: Most recent target sample. Swapped with target if valid, read buffer if merging or arbitrating*/
+    base::commands::Joints command;       /** To output port: Commanded joint position, speed and acceleration*/
+    NameLayoutStats layout_stats;         /** To output port: Statistics of the joint state name layout of generator*/
+    JointTrajectoryGenerator<PositionMode> generator; /** State handling, target conversion and position limits. Operates on rml_input_parameters*/
+    bool target_merging;                  /** Merge partial targets into the current one instead of replacing it*/
+
+    OTGBackend* vel_backend;                           /** OTG algorithm for the velocity controlled joints*/
+    RMLVelocityInputParameters* vel_input_parameters;  /** Input parameters of vel_backend. Only the velocity controlled joints are selected*/
+    RMLVelocityOutputParameters* vel_output_parameters;/** Output parameters of vel_backend*/
+    RMLVelocityFlags vel_flags;                        /** Input flags of vel_backend*/
+    bool synchronize_modes;                            /** Time-synchronize position and velocity controlled joints*/
+    double mode_sync_time;                             /** Duration of the slower set of joints after the last target change if synchronize_modes is set*/
+    bool stretch_position;                             /** True if the position controlled joints have to be stretched to mode_sync_time, false for the velocity controlled ones*/
+    OTGBackend* mode_sync_pos_backend;                 /** Scratch backends to compute the unsynchronized execution times of a new target*/
+    OTGBackend* mode_sync_vel_backend;
+    RMLPositionOutputParameters* mode_sync_pos_output;
+    RMLVelocityOutputParameters* mode_sync_vel_output;
+
+    /** Stretch the motion of the position and velocity controlled joints (via MinimumSynchronizationTime) so that both end at the same time*/
+    void synchronizeModes(RMLPositionInputParameters& in, const RMLPositionFlags& flags);
+
+protected:
+    typedef PositionMode Mode;
+
+    /** Read the current state from port and return position and flow status*/
+    bool updateCurrentState(RMLPositionInputParameters& new_input_parameters);
+
+    /** Update the RML input parameters of both OTG instances with the new target */
+    bool updateTarget(RMLPositionInputParameters& new_input_parameters);
+
+    /** Perform one step of online trajectory generation for the position and the velocity controlled joints and merge the results.
+     *  Return the combined RML result value*/
+    ReflexxesResultValue performOTG(RMLPositionInputParameters& new_input_parameters,
+                                    RMLPositionOutputParameters& new_output_parameters,
+                                    const RMLPositionFlags& rml_flags);
+
+    /** Write the generated trajectory to port*/
+    void writeCommand(const RMLPositionOutputParameters& new_output_parameters);
+
+    /** Pre-size the port samples, so that the first writes do not allocate memory*/
+    virtual void presizeSamples();
+
+public:
+    RMLMixedTask(std::string const& name = "trajectory_generation::RMLMixedTask");
+    RMLMixedTask(std::string const& name, RTT::ExecutionEngine* engine);
+    ~RMLMixedTask(){}
+    bool configureHook();
+    bool startHook();
+    void updateHook();
+    void errorHook(){RMLMixedTaskBase::errorHook();}
+    void stopHook(){RMLMixedTaskBase::stopHook();}
+    void cleanupHook();
+};
+}
+
+#endif
@@ -2,6 +2,7 @@
 
 #include "RMLPositionTask.hpp"
 #include <base-logging/Logging.hpp>
+#include "RMLTaskCycle.hpp"
 #include "Conversions.hpp"
 
 using namespace trajectory_generation;
@@ -10,96 +11,49 @@ bool RMLPositionTask::configureHook(){
     rml_flags = new RMLPositionFlags();
     rml_input_parameters = new RMLPositionInputParameters(_motion_constraints.get().size());
     rml_output_parameters = new RMLPositionOutputParameters(_motion_constraints.get().size());
+    query_snapshot = new RMLPositionInputParameters(_motion_constraints.get().size());
 
     if (! RMLPositionTaskBase::configureHook())
         return false;
+    if(!configureMode<Mode>() || !configureJointTask(*this) || !configureCommandPreview<Mode>(_command_preview_length.get()))
+        return configureFailed();
     return true;
 }
 
-void RMLPositionTask::updateMotionConstraints(const MotionConstraint& constraint,
-                                              const size_t idx,
-                                              RMLInputParameters* new_input_parameters){
-    motionConstraint2RmlTypes(constraint, idx, *(RMLPositionInputParameters*)new_input_parameters);
+bool RMLPositionTask::startHook(){
+    if (! RMLPositionTaskBase::startHook())
+        return false;
+    warmUp<Mode>();
+    return true;
 }
 
-bool RMLPositionTask::updateCurrentState(RMLInputParameters* new_input_parameters){
-    RTT::FlowStatus fs = _joint_state.readNewest(joint_state);
-    if(fs == RTT::NewData && !has_current_state){
-        jointState2RmlTypes(joint_state, motion_constraints.names, *rml_flags, *new_input_parameters);
-        current_sample.names = motion_constraints.names;
-        rmlTypes2JointState(*new_input_parameters, current_sample);
-        has_current_state = true;
-    }
-    if(fs != RTT::NoData){
-        current_sample.time = base::Time::now();
-        _current_sample.write(current_sample);
-    }
-    return has_current_state;
+void RMLPositionTask::updateHook(){
+    RMLPositionTaskBase::updateHook();
+    runCycle(*this);
 }
 
-bool RMLPositionTask::updateTarget(RMLInputParameters* new_input_parameters){
-    RTT::FlowStatus fs_target = _target.readNewest(target);
-    RTT::FlowStatus fs_constr_target = _constrained_target.readNewest(target);
-
-    if(fs_constr_target != RTT::NoData && fs_target != RTT::NoData)
-        throw std::runtime_error("There is data on both, the target AND the constrained_target port. You should use only one of the two ports!");
-
-    RTT::FlowStatus fs = RTT::NoData;
-    if(fs_target != RTT::NoData)
-        fs = fs_target;
-    else if(fs_constr_target != RTT::NoData)
-        fs = fs_constr_target;
-
-    if(fs == RTT::NewData){
-        has_target = true;
-        target.validate();
-        target2RmlTypes(target, motion_constraints, *(RMLPositionInputParameters*)new_input_parameters);
-#ifdef USING_REFLEXXES_TYPE_IV
-        // Crop at limits if POSITIONAL_LIMITS_ACTIVELY_PREVENT is selected, otherwise RML will throw a positional limits error
-        if(rml_flags->PositionalLimitsBehavior == POSITIONAL_LIMITS_ACTIVELY_PREVENT)
-            cropTargetAtPositionLimits(*(RMLPositionInputParameters*)new_input_parameters);
-#endif
-    }
-
-    return has_target;
-}
-
-ReflexxesResultValue RMLPositionTask::performOTG(RMLInputParameters* new_input_parameters,
-                                                 RMLOutputParameters* new_output_parameters,
-                                                 RMLFlags *rml_flags){
-
-    int result = rml_api->RMLPosition( *(RMLPositionInputParameters*)new_input_parameters,
-                                       (RMLPositionOutputParameters*)new_output_parameters,
-                                       *(RMLPositionFlags*)rml_flags );
-
-    // Always feed back the new state as the current state. This means that the current robot position
-    // is completely ignored. However, on a real robot, using the current position as input in RML will NOT work!
-    *new_input_parameters->CurrentPositionVector     = *new_output_parameters->NewPositionVector;
-    *new_input_parameters->CurrentVelocityVector     = *new_output_parameters->NewVelocityVector;
-    *new_input_parameters->CurrentAccelerationVector = *new_output_parameters->NewAccelerationVector;
-
-    return (ReflexxesResultValue)result;
+bool RMLPositionTask::updateCurrentState(RMLPositionInputParameters& new_input_parameters){
+    readJointState(*this, new_input_parameters);
+    return has_current_state;
 }
 
-void RMLPositionTask::writeCommand(const RMLOutputParameters& new_output_parameters){
-    rmlTypes2Command((RMLPositionOutputParameters&)new_output_parameters, command);
-    rmlTypes2JointState(*rml_input_parameters, current_sample);
-    current_sample.time = command.time = base::Time::now();
-    command.names = motion_constraints.names;
-    _command.write(command);
+bool RMLPositionTask::updateTarget(RMLPositionInputParameters& new_input_parameters){
+    return updateJointTarget(*this, new_input_parameters);
 }
 
-void RMLPositionTask::printParams(const RMLInputParameters& in, const RMLOutputParameters& out){
-    ((RMLPositionInputParameters&  )in).Echo();
-    ((RMLPositionOutputParameters& )out).Echo();
+void RMLPositionTask::writeCommand(const RMLPositionOutputParameters& new_output_parameters){
+    rmlTypes2Command(new_output_parameters, command);
+    writeJointCommand(*this);
+    writeCommandPreview<Mode>(_command_preview, command.time, true);
 }
 
-const ReflexxesInputParameters& RMLPositionTask::convertRMLInputParams(const RMLInputParameters &in, ReflexxesInputParameters& out){
-    rmlTypes2InputParams((RMLPositionInputParameters&)in, out);
-    return out;
+void RMLPositionTask::presizeSamples(){
+    presizeJointSamples(*this);
+    _command_preview.setDataSample(command_preview);
 }
 
-const ReflexxesOutputParameters& RMLPositionTask::convertRMLOutputParams(const RMLOutputParameters &in, ReflexxesOutputParameters& out){
-    rmlTypes2OutputParams((RMLPositionOutputParameters&)in, out);
-    return out;
+std::vector<TargetEvaluation> RMLPositionTask::evaluateTargets(const std::vector<ConstrainedJointsCmd>& targets){
+    return evaluatePositionTargets(targets.size(), [&](size_t i, RMLPositionInputParameters& params, InputValidationError& error){
+        return target2RmlTypes(targets[i], motion_constraints, params, error);
+    });
 }
@@ -4,54 +4,54 @@
 #define TRAJECTORY_GENERATION_RMLPOSITIONTASK_TASK_HPP
 
 #include "trajectory_generation/RMLPositionTaskBase.hpp"
+#include "JointTrajectoryGenerator.hpp"
 
 namespace trajectory_generation{
 
 class RMLPositionTask : public RMLPositionTaskBase
 {
     friend class RMLPositionTaskBase;
+    friend class RMLTask;
 
     base::samples::Joints joint_state;    /** From input port: Current joint state. Will only be used for initializing RML */
     base::samples::Joints current_sample; /** From input port: Current joint interpolator status (position/speed/acceleration)*/
-    ConstrainedJointsCmd target;          /** From input port: Target joint position or speed.  */
+    ConstrainedJointsCmd target;          /** From input port: Target joint position or speed. Contains only samples that passed validation*/
+    ConstrainedJointsCmd new_target;      /** From input port: Most recent target sample. Swapped with target if valid, read buffer if merging or arbitrating*/
     base::commands::Joints command;       /** To output port: Commanded joint position or speed.  */
+    NameLayoutStats layout_stats;         /** To output port: Statistics of the joint state name layout of generator*/
+    JointTrajectoryGenerator<PositionMode> generator; /** State handling, target conversion and position limits. Operates on rml_input_parameters*/
+    bool target_merging;                  /** Merge partial targets into the current one instead of replacing it*/
 
 protected:
-    /** Update the motion constraints of a particular element*/
-    virtual void updateMotionConstraints(const MotionConstraint& constraint,
-                                         const size_t idx,
-                                         RMLInputParameters* new_input_parameters);
+    typedef PositionMode Mode;
 
     /** Read the current state from port and return position and flow status*/
-    virtual bool updateCurrentState(RMLInputParameters* new_input_parameters);
+    bool updateCurrentState(RMLPositionInputParameters& new_input_parameters);
 
     /** Update the RML input parameters with the new target */
-    virtual bool updateTarget(RMLInputParameters* new_input_parameters);
+    bool updateTarget(RMLPositionInputParameters& new_input_parameters);
 
     /** Perform one step of online trajectory generation (call the RML algorithm with the given parameters). Return the RML result value*/
-    virtual ReflexxesResultValue performOTG(RMLInputParameters* new_input_parameters,
-                                            RMLOutputParameters* new_output_parameters,
-                                            RMLFlags *rml_flags);
+    ReflexxesResultValue performOTG(RMLPositionInputParameters& new_input_parameters,
+                                    RMLPositionOutputParameters& new_output_parameters,
+                                    const RMLPositionFlags& rml_flags){return stepOTG<Mode>(new_input_parameters, new_output_parameters, rml_flags);}
 
     /** Write the generated trajectory to port*/
-    virtual void writeCommand(const RMLOutputParameters& new_output_parameters);
+    void writeCommand(const RMLPositionOutputParameters& new_output_parameters);
 
-    /** Call echo() method for rml input and output parameters*/
-    virtual void printParams(const RMLInputParameters& in, const RMLOutputParameters& out);
+    /** Pre-size the port samples, so that the first writes do not allocate memory*/
+    virtual void presizeSamples();
 
-    /** Convert from RMLInputParameters to orogen type*/
-    virtual const ReflexxesInputParameters& convertRMLInputParams(const RMLInputParameters &in, ReflexxesInputParameters& out);
-
-    /** Convert from RMLOutputParameters to orogen type*/
-    virtual const ReflexxesOutputParameters& convertRMLOutputParams(const RMLOutputParameters &in, ReflexxesOutputParameters& out);
+    /** Compute the time needed to reach each of the given targets from the current interpolator state*/
+    virtual std::vector<TargetEvaluation> evaluateTargets(const std::vector<ConstrainedJointsCmd>& targets);
 
 public:
     RMLPositionTask(std::string const& name = "trajectory_generation::RMLPositionTask") : RMLPositionTaskBase(name){}
     RMLPositionTask(std::string const& name, RTT::ExecutionEngine* engine) : RMLPositionTaskBase(name){}
     ~RMLPositionTask(){}
     bool configureHook();
-    bool startHook(){return RMLPositionTaskBase::startHook();}
-    void updateHook(){RMLPositionTaskBase::updateHook();}
+    bool startHook();
+    void updateHook();
     void errorHook(){RMLPositionTaskBase::errorHook();}
     void stopHook(){RMLPositionTaskBase::stopHook();}
     void cleanupHook(){RMLPositionTaskBase::cleanupHook();}
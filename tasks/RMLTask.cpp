@@ -2,15 +2,41 @@
 
 #include "RMLTask.hpp"
 #include <base-logging/Logging.hpp>
+#include "Conversions.hpp"
+#include <rtt/os/MutexLock.hpp>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
 
 using namespace trajectory_generation;
 
+static std::string wcetPathName(const unsigned int path){
+    static const char* names[] = {"new_target", "position_limits", "synchronization", "derating", "fallback", "error"};
+    std::string name;
+    for(unsigned int i = 0; i < sizeof(names) / sizeof(names[0]); i++){
+        if(path & (1 << i))
+            name += (name.empty() ? "" : "+") + std::string(names[i]);
+    }
+    return name.empty() ? "steady" : name;
+}
+
 RMLTask::RMLTask(std::string const& name)
-    : RMLTaskBase(name){
+    : RMLTaskBase(name), otg_backend(0), rml_input_parameters(0), rml_output_parameters(0), rml_flags(0),
+      query_snapshot(0), has_query_snapshot(false), query_requested(false), target_changed(false),
+      sync_backend(0), sync_output(0), trajectory_cache(0),
+      simulated_clock(false), pending_cycles(0), preview_backend(0), preview_input(0), preview_output(0),
+      fallback_mode(OTG_FALLBACK_NONE), fallback_backend(0), fallback_stop_input(0), fallback_stop_output(0), fallback_active(false),
+      wcet_tracking(false), wcet_input(0), memory_locked(false){
 }
 
 RMLTask::RMLTask(std::string const& name, RTT::ExecutionEngine* engine)
-    : RMLTaskBase(name, engine){
+    : RMLTaskBase(name, engine), otg_backend(0), rml_input_parameters(0), rml_output_parameters(0), rml_flags(0),
+      query_snapshot(0), has_query_snapshot(false), query_requested(false), target_changed(false),
+      sync_backend(0), sync_output(0), trajectory_cache(0),
+      simulated_clock(false), pending_cycles(0), preview_backend(0), preview_input(0), preview_output(0),
+      fallback_mode(OTG_FALLBACK_NONE), fallback_backend(0), fallback_stop_input(0), fallback_stop_output(0), fallback_active(false),
+      wcet_tracking(false), wcet_input(0), memory_locked(false){
 }
 
 RMLTask::~RMLTask(){
@@ -19,30 +45,104 @@ RMLTask::~RMLTask(){
 bool RMLTask::configureHook(){
 
     if (! RMLTaskBase::configureHook())
-        return false;
+        return configureFailed();
 
     cycle_time = this->getPeriod();
 
     motion_constraints = _motion_constraints.get();
     if(motion_constraints.size() != motion_constraints.names.size()){
         LOG_ERROR("Number of elements in motion constraints must be same as size of the names vector");
-        return false;
+        return configureFailed();
+    }
+    for(size_t i = 0; i < motion_constraints.size(); i++){
+        if(validateMotionConstraint(motion_constraints[i], motion_constraints.names[i], validation_error) != VALIDATION_OK){
+            LOG_ERROR("Invalid motion constraint for element %s (validation status %i, value %f)",
+                      validation_error.name.c_str(), validation_error.status, validation_error.value);
+            return configureFailed();
+        }
     }
-    for(size_t i = 0; i < motion_constraints.size(); i++)
-        updateMotionConstraints(motion_constraints[i], i, rml_input_parameters);
 
     rml_flags->SynchronizationBehavior = _synchronization_behavior.get();
+    positional_limits_behavior = _positional_limits_behavior.get();
+    positionLimits(motion_constraints, min_position, max_position);
 #ifdef USING_REFLEXXES_TYPE_IV
     rml_flags->PositionalLimitsBehavior = _positional_limits_behavior.get();
 #endif
 
-    rml_api = new ReflexxesAPI(motion_constraints.size(), cycle_time);
+    otg_backend = createBackend();
+    trajectory_cache_stats = TrajectoryCacheStats();
     rml_result_value = RML_NOT_INITIALIZED;
+    validation_error = InputValidationError();
+    validation_error.port.reserve(MAX_VALIDATION_NAME_LENGTH);
+    validation_error.name.reserve(MAX_VALIDATION_NAME_LENGTH);
+    validation_log_time = base::Time();
+    suppressed_validation_logs = 0;
+    has_query_snapshot = query_requested = false;
     has_current_state = has_target = false;
+    limit_violations.resize(motion_constraints.size());
+    reported_limit_violations.resize(motion_constraints.size());
+    limit_violation_status = LimitViolations();
+    limit_violation_status.names = motion_constraints.names;
+    limit_violation_status.violated.resize(motion_constraints.size());
+
+    deadline.reset();
+
+    const DeratingConfig derating_config = _derating.get();
+    if(!(derating_config.time_constant >= 0) || !(derating_config.min_factor > 0 && derating_config.min_factor <= 1) || !(derating_config.resolution >= 0)){
+        LOG_ERROR("%s: Invalid derating config: time_constant and resolution must be >= 0, min_factor must be within (0,1]", this->getName().c_str());
+        return configureFailed();
+    }
+    derating.configure(motion_constraints.names, derating_config);
+    derating_status = derating.getStatus();
+
+    fallback_mode = _otg_fallback.get();
+    fallback_active = false;
+    fallback_status = OTGFallbackStatus();
+    if(fallback_mode != OTG_FALLBACK_NONE){
+        fallback_backend = createBackend(OTG_BACKEND_SCURVE);
+        fallback_stop_input = new RMLVelocityInputParameters(motion_constraints.size());
+        fallback_stop_output = new RMLVelocityOutputParameters(motion_constraints.size());
+        fallback_stop_flags.SynchronizationBehavior = rml_flags->SynchronizationBehavior;
+#ifdef USING_REFLEXXES_TYPE_IV
+        fallback_stop_flags.PositionalLimitsBehavior = rml_flags->PositionalLimitsBehavior;
+#endif
+    }
+
+    wcet_tracking = _wcet_tracking.get();
+    wcet_stats = WCETStats();
+    if(wcet_tracking){
+        // One record per path, updated in place in the cycle
+        const size_t n_dof = motion_constraints.size();
+        wcet_stats.paths.resize(WCET_ERROR << 1);
+        for(size_t i = 0; i < wcet_stats.paths.size(); i++){
+            wcet_stats.paths[i].path = wcetPathName(i);
+            wcet_stats.paths[i].input = ReflexxesInputParameters(n_dof);
+        }
+    }
+
+    tracer.configure(_cycle_tracing.get());
+
+    simulated_clock = _simulated_clock.get();
+    simulated_time = base::Time::fromSeconds(0);
+    timestamp = base::Time();
+    pending_cycles = 0;
+
+    if(!_shared_memory_command.get().empty() && !shm_command.open(_shared_memory_command.get(), motion_constraints.names))
+        return configureFailed();
 
     input_parameters = ReflexxesInputParameters(rml_input_parameters->NumberOfDOFs);
     output_parameters = ReflexxesOutputParameters(rml_input_parameters->NumberOfDOFs);
 
+    // Lock after all buffers have been allocated, so that they are faulted in now and not in the first cycles
+    if(_warm_up.get().lock_memory){
+        if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0){
+            LOG_ERROR("%s: Failed to lock memory: %s. Check the RLIMIT_MEMLOCK of the process or disable warm_up.lock_memory",
+                      this->getName().c_str(), strerror(errno));
+            return configureFailed();
+        }
+        memory_locked = true;
+    }
+
     return true;
 }
 
@@ -53,38 +153,16 @@ bool RMLTask::startHook(){
 }
 
 void RMLTask::updateHook(){
-
-    base::Time start_time = base::Time::now();
-    if(!timestamp.isNull())
-        _actual_cycle_time.write((start_time - timestamp).toSeconds());
-    timestamp = start_time;
-
     RMLTaskBase::updateHook();
+}
 
-    if(!updateCurrentState(rml_input_parameters)){
-        if(state() != NO_CURRENT_STATE)
-            state(NO_CURRENT_STATE);
-        return;
-    }
-
-    if(!updateTarget(rml_input_parameters)){
-        if(state() != NO_TARGET)
-            state(NO_TARGET);
-        return;
-    }
-
-    if(state() == NO_TARGET || state() == NO_CURRENT_STATE)
-        state(RUNNING);
-
-    rml_result_value = performOTG(rml_input_parameters, rml_output_parameters, rml_flags);
-    handleResultValue(rml_result_value);
-
-    writeCommand(*rml_output_parameters);
-
-    // write debug data
-    _rml_input_parameters.write(convertRMLInputParams(*rml_input_parameters, input_parameters));
-    _rml_output_parameters.write(convertRMLOutputParams(*rml_output_parameters, output_parameters));
-    _computation_time.write((base::Time::now() - start_time).toSeconds());
+bool RMLTask::step(boost::uint32_t cycles){
+    if(!simulated_clock || !isRunning())
+        return false;
+    pending_cycles += cycles;
+    // Run updateHook() also if the task is not periodic
+    this->trigger();
+    return true;
 }
 
 void RMLTask::errorHook(){
@@ -93,55 +171,345 @@ void RMLTask::errorHook(){
 
 void RMLTask::stopHook(){
     RMLTaskBase::stopHook();
+
+    // No cycles will serve snapshot requests until restart, so keep the final interpolator state for target evaluations
+    if(query_snapshot && rml_result_value != RML_NOT_INITIALIZED){
+        RTT::os::MutexLock lock(query_mutex);
+        *query_snapshot = static_cast<const RMLPositionInputParameters&>(*rml_input_parameters);
+        has_query_snapshot = true;
+    }
 }
 
 void RMLTask::cleanupHook(){
     RMLTaskBase::cleanupHook();
 
+    // Wait for a running target evaluation, it uses the snapshot, the flags and the motion constraints
+    {
+        RTT::os::MutexLock lock(query_mutex);
+        delete query_snapshot;
+        query_snapshot = 0;
+        has_query_snapshot = query_requested = false;
+    }
+
+    // The lock affects the whole process, so this also unlocks the memory of other components that requested it
+    if(memory_locked)
+        munlockall();
+    memory_locked = false;
+
     motion_constraints.clear();
-    delete rml_api;
+    shm_command.close();
+    sync_member.leave();
+    delete sync_backend;
+    delete sync_output;
+    sync_backend = 0;
+    sync_output = 0;
+    delete fallback_backend;
+    delete fallback_stop_input;
+    delete fallback_stop_output;
+    fallback_backend = 0;
+    fallback_stop_input = 0;
+    fallback_stop_output = 0;
+    delete wcet_input;
+    wcet_input = 0;
+    delete preview_backend;
+    delete preview_input;
+    delete preview_output;
+    preview_backend = 0;
+    preview_input = 0;
+    preview_output = 0;
+    command_preview.clear();
+    command_preview.times.clear();
+    delete otg_backend;
+    otg_backend = 0;
+    trajectory_cache = 0;
     delete rml_input_parameters;
     delete rml_output_parameters;
     delete rml_flags;
+    rml_input_parameters = 0;
+    rml_output_parameters = 0;
+    rml_flags = 0;
 }
 
-void RMLTask::handleResultValue(ReflexxesResultValue result_value){
+bool RMLTask::configureFailed(){
+    cleanupHook();
+    return false;
+}
 
-    _rml_result_value.write(result_value);
+void RMLTask::storePreviewSample(const RMLOutputParameters& out, const size_t idx, const bool positions){
+    for(size_t i = 0; i < command_preview.size(); i++){
+        base::JointState& sample = command_preview[i][idx];
+        sample.position     = positions ? out.NewPositionVector->VecData[i] : base::NaN<double>();
+        sample.speed        = out.NewVelocityVector->VecData[i];
+        sample.acceleration = out.NewAccelerationVector->VecData[i];
+    }
+}
 
-    switch(result_value){
-    case RML_WORKING:{
-        if(state() != FOLLOWING)
-            state(FOLLOWING);
-        break;
+bool RMLTask::configureSyncGroup(PositionMode){
+    if(_sync_group.get().empty())
+        return true;
+    if(!sync_member.join(_sync_group.get())){
+        LOG_ERROR("%s: Sync group %s is full (max. %i members)", this->getName().c_str(), _sync_group.get().c_str(), SyncGroup::MAX_MEMBERS);
+        return false;
+    }
+    sync_backend = createBackend();
+    sync_output = new RMLPositionOutputParameters(motion_constraints.size());
+    return true;
+}
+
+bool RMLTask::configureSyncGroup(VelocityMode){
+    if(_sync_group.get().empty())
+        return true;
+    LOG_ERROR("%s: Sync groups are only supported by position based tasks", this->getName().c_str());
+    return false;
+}
+
+bool RMLTask::configureTrajectoryCache(PositionMode){
+    const TrajectoryCacheConfig config = _trajectory_cache.get();
+    if(config.size == 0)
+        return true;
+    if(!(config.quantization > 0)){
+        LOG_ERROR("%s: The trajectory cache requires quantization > 0", this->getName().c_str());
+        return false;
     }
-    case RML_FINAL_STATE_REACHED:{
-        if(state() != REACHED)
-            state(REACHED);
-        break;
+    otg_backend = trajectory_cache = new TrajectoryCache(otg_backend, motion_constraints.size(), config);
+    return true;
+}
+
+bool RMLTask::configureTrajectoryCache(VelocityMode){
+    if(_trajectory_cache.get().size == 0)
+        return true;
+    LOG_ERROR("%s: The trajectory cache is only supported by position based tasks", this->getName().c_str());
+    return false;
+}
+
+void RMLTask::synchronizeWithGroup(RMLPositionInputParameters& in){
+    // Compute and publish the unsynchronized arrival time of a new target. Use the scratch backend, so that the state of the
+    // active OTG algorithm is not affected
+    if(target_changed){
+        in.MinimumSynchronizationTime = 0;
+        if(sync_backend->RMLPosition(in, sync_output, static_cast<const RMLPositionFlags&>(*rml_flags)) < 0)
+            return;
+        sync_member.publish(timestamp, sync_output->SynchronizationTime);
     }
-    case ReflexxesAPI::RML_ERROR_SYNCHRONIZATION:
-        // Ignore this error. It occurs from time to time without having any effect
-        break;
-#ifdef USING_REFLEXXES_TYPE_IV
-    case RML_ERROR_POSITIONAL_LIMITS:{
 
-        if(rml_flags->PositionalLimitsBehavior == RMLFlags::POSITIONAL_LIMITS_ERROR_MSG_ONLY){
-            LOG_ERROR("RML target position out of bounds. Modify your target position and/or positional limits or "
-                      "choose POSITIONAL_LIMITS_IGNORE/POSITIONAL_LIMITS_ACTIVELY_PREVENT to avoid this error");
-            error(RML_ERROR);
-            printParams(*rml_input_parameters, *rml_output_parameters);
+    // Tolerate differences of half a cycle, otherwise the members might trigger each other's recomputation in every cycle
+    sync_member.update(timestamp, !target_changed && rml_result_value == RML_FINAL_STATE_REACHED, cycle_time / 2, in.MinimumSynchronizationTime);
+}
+
+void RMLTask::readDeadline(const bool supported){
+    base::Time arrival_time;
+    if(_target_arrival_time.readNewest(arrival_time) != RTT::NewData)
+        return;
+    if(!arrival_time.isNull() && !supported){
+        LOG_ERROR("%s: Deadlines are only supported by position based tasks without sync group", this->getName().c_str());
+        DeadlineStatus status;
+        status.time = timestamp;
+        status.arrival_time = arrival_time;
+        status.state = DEADLINE_REJECTED;
+        _deadline_status.write(status);
+        return;
+    }
+    deadline.request(timestamp, arrival_time);
+    if(arrival_time.isNull())
+        _deadline_status.write(deadline.getStatus());
+}
+
+void RMLTask::applyDeadline(RMLPositionInputParameters& in){
+    readDeadline(!sync_member.isJoined());
+    if(deadline.apply(timestamp, target_changed, cycle_time, in.MinimumSynchronizationTime))
+        _deadline_status.write(deadline.getStatus());
+}
+
+void RMLTask::evaluateDeadline(RMLPositionInputParameters& in, const RMLPositionOutputParameters& out){
+    _deadline_status.write(deadline.evaluate(timestamp, rml_result_value, out, cycle_time, in.MinimumSynchronizationTime));
+}
+
+void RMLTask::updateQuerySnapshot(const RMLPositionInputParameters& in){
+    // The snapshot is only copied if a target evaluation asks for it. Never wait for a running evaluation here,
+    // the request will be served in the next cycle instead
+    RTT::os::MutexTryLock lock(query_mutex);
+    if(lock.isSuccessful() && query_requested){
+        *query_snapshot = in;
+        has_query_snapshot = true;
+        query_requested = false;
+    }
+}
+
+OTGBackend* RMLTask::createBackend(const OTGBackendType type){
+    OTGBackend* backend = createOTGBackend(type, motion_constraints.size(), cycle_time);
+    backend->setPositionLimits(min_position, max_position, positional_limits_behavior);
+    return backend;
+}
+
+std::vector<TargetEvaluation> RMLTask::evaluatePositionTargets(const size_t n,
+    std::function<ValidationStatus(size_t, RMLPositionInputParameters&, InputValidationError&)> set_target){
+
+    std::vector<TargetEvaluation> evaluations(n);
+    {
+        RTT::os::MutexLock lock(query_mutex);
+        if(!query_snapshot)
+            return evaluations;
+        query_requested = true;
+    }
+
+    // The snapshot is taken by the next cycle. If no cycle is run meanwhile (e.g. because the task is stopped or has no target),
+    // the interpolator state has not changed and the last snapshot is still valid
+    const base::Time wait_until = base::Time::now() + base::Time::fromSeconds(2 * cycle_time + MAX_QUERY_SNAPSHOT_DELAY);
+    while(base::Time::now() < wait_until){
+        {
+            RTT::os::MutexLock lock(query_mutex);
+            if(!query_requested)
+                break;
         }
-        break;
+        usleep(std::max(cycle_time / 4, 1e-4) * 1e6);
     }
-#endif
-    default:{
+
+    // Evaluate while holding the lock: updateHook() never waits for it, and cleanupHook() cannot release the snapshot,
+    // the flags and the motion constraints meanwhile
+    RTT::os::MutexLock lock(query_mutex);
+    query_requested = false;
+    if(!query_snapshot)
+        return evaluations;
+    if(!has_query_snapshot){
+        LOG_ERROR("%s: Cannot evaluate targets, since the interpolator has not been initialized yet", this->getName().c_str());
+        return evaluations;
+    }
+
+    const uint n_dof = query_snapshot->GetNumberOfDOFs();
+    RMLPositionInputParameters candidate(n_dof);
+    RMLPositionOutputParameters out(n_dof);
+    ViolationMask violations(n_dof);
+    InputValidationError error;
+    OTGBackend* backend = createBackend();
+    for(size_t i = 0; i < n; i++){
+        TargetEvaluation& evaluation = evaluations[i];
+        candidate = *query_snapshot;
+        evaluation.validation = set_target(i, candidate, error);
+        if(evaluation.validation != VALIDATION_OK)
+            continue;
+        // Targets beyond the position limits cannot be reached: They would be cropped (POSITIONAL_LIMITS_ACTIVELY_PREVENT) or rejected
+        // (POSITIONAL_LIMITS_ERROR_MSG_ONLY) by the cycle, with any backend
+        if(positional_limits_behavior != POSITIONAL_LIMITS_IGNORE){
+            checkLimits(min_position.data(), max_position.data(), candidate.TargetPositionVector->VecData, n_dof, violations);
+            for(uint j = 0; j < n_dof && violations.any() && evaluation.validation == VALIDATION_OK; j++){
+                if(violations.test(j) && candidate.SelectionVector->VecData[j])
+                    evaluation.validation = VALIDATION_POSITION_LIMITS;
+            }
+            if(evaluation.validation != VALIDATION_OK)
+                continue;
+        }
+        evaluation.result = (ReflexxesResultValue)backend->RMLPosition(candidate, &out, static_cast<const RMLPositionFlags&>(*rml_flags));
+        evaluation.feasible = evaluation.result >= 0;
+        if(!evaluation.feasible)
+            continue;
+        evaluation.execution_time = out.SynchronizationTime;
+        for(uint j = 0; j < n_dof; j++){
+            if(candidate.SelectionVector->VecData[j])
+                evaluation.execution_time = std::max(evaluation.execution_time, out.ExecutionTimes->VecData[j]);
+        }
+    }
+    delete backend;
+    return evaluations;
+}
+
+void RMLTask::reportValidationError(const std::string& port){
+    validation_error.time = now();
+    validation_error.port = port;
+    _input_validation_error.write(validation_error);
+
+    // Invalid samples usually arrive in every cycle until the sender is fixed, so do not flood the log
+    if(!validation_log_time.isNull() && (validation_error.time - validation_log_time).toSeconds() < 1.0){
+        suppressed_validation_logs++;
+        return;
+    }
+    LOG_ERROR("%s: Rejected sample on port %s: element '%s' is invalid (validation status %i, value %f). %u rejections not logged since the last message",
+              this->getName().c_str(), port.c_str(), validation_error.name.c_str(), validation_error.status, validation_error.value, suppressed_validation_logs);
+    validation_log_time = validation_error.time;
+    suppressed_validation_logs = 0;
+}
+
+void RMLTask::updateDeratingFactors(){
+    if(_derating_factors.read(derating_factors) == RTT::NewData &&
+       derating.setFactors(derating_factors, validation_error) != VALIDATION_OK)
+        reportValidationError(_derating_factors.getName());
+}
+
+bool RMLTask::needsFallback(const int result) const{
+    if(!fallback_backend || result >= 0 || result == ReflexxesAPI::RML_ERROR_SYNCHRONIZATION)
+        return false;
+    // The user explicitly asked for an error in this case
+    if(result == RML_ERROR_POSITIONAL_LIMITS && positional_limits_behavior == POSITIONAL_LIMITS_ERROR_MSG_ONLY)
+        return false;
+    return true;
+}
+
+bool RMLTask::controlledStop(const RMLInputParameters& in, RMLOutputParameters& out){
+    RMLVelocityInputParameters& stop_in = *fallback_stop_input;
+    *stop_in.SelectionVector           = *in.SelectionVector;
+    *stop_in.CurrentPositionVector     = *in.CurrentPositionVector;
+    *stop_in.CurrentVelocityVector     = *in.CurrentVelocityVector;
+    *stop_in.CurrentAccelerationVector = *in.CurrentAccelerationVector;
+    *stop_in.MaxAccelerationVector     = *in.MaxAccelerationVector;
+    *stop_in.MaxJerkVector             = *in.MaxJerkVector;
 #ifdef USING_REFLEXXES_TYPE_IV
-        LOG_ERROR("Error in online trajectory generation algorithm: %s", rml_output_parameters->GetErrorString());
+    *stop_in.MaxPositionVector         = *in.MaxPositionVector;
+    *stop_in.MinPositionVector         = *in.MinPositionVector;
 #endif
-        printParams(*rml_input_parameters, *rml_output_parameters);
-        error(RML_ERROR);
-        break;
+    for(uint i = 0; i < stop_in.NumberOfDOFs; i++)
+        stop_in.TargetVelocityVector->VecData[i] = 0;
+
+    if(fallback_backend->RMLVelocity(stop_in, fallback_stop_output, fallback_stop_flags) < 0)
+        return false;
+    *out.NewPositionVector     = *fallback_stop_output->NewPositionVector;
+    *out.NewVelocityVector     = *fallback_stop_output->NewVelocityVector;
+    *out.NewAccelerationVector = *fallback_stop_output->NewAccelerationVector;
+    return true;
+}
+
+void RMLTask::updateFallbackStatus(){
+    const bool was_active = fallback_status.active;
+    fallback_status.cycles++;
+    fallback_status.active = fallback_active;
+    if(fallback_active){
+        fallback_status.fallback_cycles++;
+        if(!was_active)
+            fallback_status.activations++;
+    }
+    else
+        fallback_status.mode = OTG_FALLBACK_NONE;
+    fallback_status.fallback_rate = (double)fallback_status.fallback_cycles / fallback_status.cycles;
+    if(fallback_active || was_active){
+        fallback_status.time = timestamp;
+        _otg_fallback_status.write(fallback_status);
     }
+}
+
+bool RMLTask::configureTargetArbitration(const TargetArbitrationConfig& config, const bool target_merging){
+    if(config.enabled && target_merging){
+        LOG_ERROR("%s: Target arbitration and target merging cannot be enabled at the same time", this->getName().c_str());
+        return false;
+    }
+    if(!target_arbiter.configure(config)){
+        LOG_ERROR("%s: Target arbitration timeouts must be positive and finite", this->getName().c_str());
+        return false;
     }
+    return true;
+}
+
+void RMLTask::writeLimitViolations(){
+    if(limit_violations == reported_limit_violations)
+        return;
+    reported_limit_violations = limit_violations;
+    limit_violation_status.time = timestamp;
+    limit_violation_status.count = limit_violations.count();
+    for(size_t i = 0; i < limit_violation_status.violated.size(); i++)
+        limit_violation_status.violated[i] = limit_violations.test(i);
+    _limit_violations.write(limit_violation_status);
+}
+
+void RMLTask::writeCycleTrace(){
+    if(!tracer.isEnabled())
+        return;
+    tracer.endCycle();
+    _cycle_trace.write(tracer.getTrace());
 }
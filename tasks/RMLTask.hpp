@@ -7,7 +7,21 @@
 #include <joint_control_base/MotionConstraint.hpp>
 #include <joint_control_base/ConstrainedJointsCmd.hpp>
 #include <base/Time.hpp>
+#include <base/JointsTrajectory.hpp>
 #include <ReflexxesAPI.h>
+#include <rtt/os/Mutex.hpp>
+#include <functional>
+#include "OTGBackend.hpp"
+#include "LimitKernels.hpp"
+#include "SharedMemoryCommand.hpp"
+#include "SyncGroup.hpp"
+#include "DeadlineTracker.hpp"
+#include "TrajectoryCache.hpp"
+#include "OTGMode.hpp"
+#include "ConstraintDerating.hpp"
+#include "CycleTracer.hpp"
+#include "TargetArbiter.hpp"
+#include "JointTrajectoryGenerator.hpp"
 
 /* TODOs (D.M, 2016/06/28):
  *
@@ -35,11 +49,19 @@ class RMLTask : public RMLTaskBase
 {
     friend class RMLTaskBase;
 protected:
+    /** Max. time in seconds that evaluatePositionTargets() waits for a new snapshot in addition to two cycles*/
+    static constexpr double MAX_QUERY_SNAPSHOT_DELAY = 0.01;
+    /** Capacity reserved for the port and element name of validation_error*/
+    static const size_t MAX_VALIDATION_NAME_LENGTH = 128;
+
     MotionConstraints motion_constraints;        /** Motion constraints that define the properties of the output trajectory*/
-    ReflexxesAPI* rml_api;                       /** Interface to the Online Trajectory Generation algorithms of the Reflexxes Motion Libraries*/
+    OTGBackend* otg_backend;                     /** Online Trajectory Generation algorithm (Reflexxes or built-in)*/
     RMLInputParameters *rml_input_parameters;    /** Input parameters for the OTG algorithm (target, constraints, flags, ...).*/
     RMLOutputParameters *rml_output_parameters;  /** Output parameters of the OTG algorithm (new states, errors, ...).*/
     RMLFlags* rml_flags;                         /** Input flags for the RML algorithm.*/
+    PositionalLimitsBehavior positional_limits_behavior; /** Behavior at the position limits, also available without Reflexxes Type IV*/
+    std::vector<double> min_position;            /** Position limits of the motion constraints, -inf/+inf if not set. See positionLimits()*/
+    std::vector<double> max_position;
     ReflexxesResultValue rml_result_value;       /** Current result value of RML, will be RML_NOT_INITIALIZED in the beginning*/
     ReflexxesInputParameters input_parameters;   /** RMLInputParameters do not work with orogen, so use own type*/
     ReflexxesOutputParameters output_parameters; /** RMLOutputParameters do not work with orogen, so use own type*/
@@ -47,37 +69,244 @@ protected:
     double cycle_time;                           /** Cycle time for interpolation*/
     bool has_current_state;                      /** True if an initial state could be read from port*/
     bool has_target;                             /** True if a target could be read from port*/
+    ViolationMask limit_violations;              /** DOF that violated (or have been cropped at) their limits in the current cycle*/
+    ViolationMask reported_limit_violations;     /** Last value of limit_violations that has been written to port*/
+    LimitViolations limit_violation_status;      /** To output port: limit_violations by element name*/
+    InputValidationError validation_error;       /** Reason for the rejection of the last invalid input sample*/
+    base::Time validation_log_time;              /** Time at which the last rejection has been logged*/
+    unsigned int suppressed_validation_logs;     /** Number of rejections that have not been logged since validation_log_time*/
+    RMLPositionInputParameters *query_snapshot;  /** Copy of the interpolator state for target evaluation. Only allocated by position based tasks*/
+    bool has_query_snapshot;                     /** True if query_snapshot contains a valid interpolator state*/
+    bool query_requested;                        /** Set by evaluatePositionTargets() to request a new snapshot in the next cycle*/
+    RTT::os::Mutex query_mutex;                  /** Protects query_snapshot, has_query_snapshot and query_requested. Never blocks in updateHook()*/
+    SharedCommandWriter shm_command;             /** Optional shared memory output of the interpolator state*/
+    bool target_changed;                         /** True if a new target has been accepted in the current cycle*/
+    SyncGroupMember sync_member;                 /** Membership in the group of tasks that shall reach their targets simultaneously, if used*/
+    OTGBackend* sync_backend;                    /** Scratch backend to compute the unsynchronized execution time of a new target*/
+    RMLPositionOutputParameters* sync_output;    /** Output of sync_backend*/
+    TrajectoryCache* trajectory_cache;           /** Same object as otg_backend if the trajectory cache is enabled, 0 otherwise*/
+    TrajectoryCacheStats trajectory_cache_stats; /** To output port: Statistics of trajectory_cache*/
+    DeadlineTracker deadline;                    /** Requested arrival time of the current and the next target*/
+    ConstraintDerating derating;                 /** Scales the max. speed, acceleration and jerk of the RML input parameters*/
+    DeratingFactors derating_factors;            /** From input port: New derating factors*/
+    DeratingFactors derating_status;             /** To output port: Currently applied derating factors*/
+    bool simulated_clock;                        /** If true, time is taken from simulated_time and cycles are run by the step operation*/
+    base::Time simulated_time;                   /** Current time of the simulated clock*/
+    boost::uint32_t pending_cycles;              /** Number of cycles requested by the step operation that have not been run yet*/
+    OTGBackend* preview_backend;                 /** Scratch backend to compute command_preview, 0 if the preview is disabled*/
+    RMLInputParameters* preview_input;           /** Input parameters of preview_backend*/
+    RMLOutputParameters* preview_output;         /** Output parameters of preview_backend*/
+    base::JointsTrajectory command_preview;      /** To output port: Next setpoints of the interpolator, starting with the current command*/
+    OTGFallbackMode fallback_mode;               /** Behavior if the OTG algorithm returns an error*/
+    OTGBackend* fallback_backend;                /** Built-in S-curve generator used by the fallback, 0 if the fallback is disabled*/
+    RMLVelocityInputParameters* fallback_stop_input;   /** Input parameters of the controlled stop*/
+    RMLVelocityOutputParameters* fallback_stop_output; /** Output parameters of the controlled stop*/
+    RMLVelocityFlags fallback_stop_flags;        /** Flags of the controlled stop*/
+    bool fallback_active;                        /** True if the output of the current cycle has been generated by the fallback*/
+    OTGFallbackStatus fallback_status;           /** To output port: Status of the fallback*/
+    bool wcet_tracking;                          /** Record the worst-case computation time of each code path of the OTG cycle*/
+    RMLInputParameters* wcet_input;              /** Copy of the OTG input of the current cycle before the step, 0 if wcet_tracking is not set*/
+    WCETStats wcet_stats;                        /** To output port: Worst case of each code path, indexed by the combination of WCETPathFlags*/
+    CycleTracer tracer;                          /** Per-stage timing of the current cycle, disabled if cycle_tracing is not set*/
+    TargetArbiter target_arbiter;                /** Selection between target and constrained_target port (joint space tasks)*/
+    ConstrainedJointsCmd arbitration_samples[2]; /** Most recent sample of each target source, indexed by TargetSource - 1*/
+    bool memory_locked;                          /** True if the process memory has been locked (mlockall) in configureHook()*/
+
+    /** Mode specific part of the configuration: Set the motion constraints of the RML input parameters and set up the trajectory cache,
+     *  the WCET seed buffer and the sync group. Call from configureHook() of the task after RMLTask::configureHook() with Task::Mode.
+     *  Returns false on error. Defined in RMLTaskCycle.hpp*/
+    template<class Mode> bool configureMode();
+
+    /** Perform one step of online trajectory generation (call the OTG algorithm with the given parameters) and feed back the new state
+     *  as the current state. Return the RML result value. If the OTG algorithm fails and the fallback succeeds, out contains the output
+     *  of the fallback, fallback_active is set and the error is returned*/
+    template<class Mode> ReflexxesResultValue stepOTG(typename Mode::InputParameters& in,
+                                                      typename Mode::OutputParameters& out,
+                                                      const typename Mode::Flags& flags);
+
+    /** Perform one cycle of online trajectory generation. The hooks of the given task are called without virtual dispatch and with the
+     *  typed RML parameter objects of Task::Mode (PositionMode or VelocityMode). Task has to implement:
+     *
+     *  - bool updateCurrentState(Mode::InputParameters& in): Read the current state from port and return true if a valid state is available
+     *  - bool updateTarget(Mode::InputParameters& in): Update the RML input parameters with the new target and return true if a target is available
+     *  - ReflexxesResultValue performOTG(Mode::InputParameters& in, Mode::OutputParameters& out, const Mode::Flags& flags): Usually stepOTG<Mode>()
+     *  - void writeCommand(const Mode::OutputParameters& out): Write the generated trajectory to port
+     *
+     *  On the simulated clock, all pending cycles are run and the clock is advanced by cycle_time before each of them.
+     *  Defined in RMLTaskCycle.hpp, call it from updateHook() of the task.*/
+    template<class Task> void runCycle(Task& task);
+
+    /** Perform one cycle of online trajectory generation at the given time. See runCycle()*/
+    template<class Task> void runSingleCycle(Task& task, const base::Time& time);
+
+    /** Call echo() method for rml input and output parameters. Defined in RMLTaskCycle.hpp*/
+    template<class Mode> void printParams();
+
+    /** Release everything that has been allocated in configureHook() so far (shared memory segment, sync group slot, RML parameters, ...)
+     *  and return false. RTT does not call cleanupHook() if configureHook() fails, so use this on all errors after the first allocation.*/
+    bool configureFailed();
+
+    /** Pre-size the task specific port samples (command, current sample, ...), so that the first writes do not allocate memory.
+     *  Must not change the behavior of the task.*/
+    virtual void presizeSamples() = 0;
+
+    /** Handle result of the OTG algorithm. Handle errors. Defined in RMLTaskCycle.hpp*/
+    template<class Mode> void handleResultValue(ReflexxesResultValue result_value);
+
+    /** Join the configured sync group, if any. Only position based OTG supports sync groups, returns false on error. See configureMode()*/
+    bool configureSyncGroup(PositionMode);
+    bool configureSyncGroup(VelocityMode);
+
+    /** Wrap otg_backend into the trajectory cache, if configured. Only position based OTG supports the cache, returns false on error.
+     *  See configureMode()*/
+    bool configureTrajectoryCache(PositionMode);
+    bool configureTrajectoryCache(VelocityMode);
+
+    /** Stretch the current motion (via MinimumSynchronizationTime) so that it ends at the same time as the motions of all other
+     *  members of the sync group. Publishes the arrival time of a new target to the group. The stretch is reset when the target is
+     *  replaced or has been reached.*/
+    void synchronizeWithGroup(RMLPositionInputParameters& in);
+    void synchronizeWithGroup(RMLVelocityInputParameters&){}
+
+    /** Read new derating factors from port and pass them to derating. Invalid samples are rejected*/
+    void updateDeratingFactors();
+
+    /** Read a new deadline from port, arm it with the next accepted target and stretch the motion (via MinimumSynchronizationTime) so
+     *  that it ends at the deadline. Writes the deadline status if the deadline of the previous target is dropped by a new target.
+     *  Velocity based OTG rejects all deadlines*/
+    void applyDeadline(RMLPositionInputParameters& in);
+    void applyDeadline(RMLVelocityInputParameters&){readDeadline(false);}
+
+    /** Read a new deadline from port and write the deadline status if it is rejected (supported is false) or cleared*/
+    void readDeadline(const bool supported);
+
+    /** Compare the expected arrival time of the current motion with the deadline and write the deadline status. Drops the deadline
+     *  once it has been reached or has passed*/
+    void evaluateDeadline(RMLPositionInputParameters& in, const RMLPositionOutputParameters& out);
+    void evaluateDeadline(RMLVelocityInputParameters&, const RMLVelocityOutputParameters&){}
+
+    /** Copy the interpolator state to query_snapshot if a target evaluation asks for it. Position based OTG only*/
+    void updateQuerySnapshot(const RMLPositionInputParameters& in);
+    void updateQuerySnapshot(const RMLVelocityInputParameters&){}
+
+    /** Create a new OTG backend of the given type with the configured number of DOF, cycle time and position limits.
+     *  The caller takes ownership of the returned object.*/
+    OTGBackend* createBackend(const OTGBackendType type);
+
+    /** Create a new OTG backend of the configured type, see createBackend(type)*/
+    OTGBackend* createBackend(){return createBackend(_otg_backend.get());}
+
+    /** True if the given result of the OTG algorithm shall be handled by the fallback*/
+    bool needsFallback(const int result) const;
+
+    /** Generate the output of the current cycle with the fallback, after the OTG algorithm has failed with the given result. The new state is
+     *  written to out, in is not modified. Returns false if the fallback failed as well.*/
+    template<class Mode> bool runFallback(const typename Mode::InputParameters& in,
+                                          typename Mode::OutputParameters& out,
+                                          const typename Mode::Flags& flags,
+                                          const int result);
+
+    /** Decelerate all selected elements of in to zero speed and write the new state to out. Returns false on failure*/
+    bool controlledStop(const RMLInputParameters& in, RMLOutputParameters& out);
+
+    /** Update the fallback statistics after the OTG step and write them to port if the fallback is or was active*/
+    void updateFallbackStatus();
+
+    /** Record the computation time of the current cycle on the given path (combination of WCETPathFlags, the fallback and error cases are
+     *  added here). If it is a new worst case for this path, wcet_input is stored as its seed and the statistics are written to port.
+     *  Defined in RMLTaskCycle.hpp*/
+    template<class Mode> void updateWCET(unsigned int path, const double computation_time);
+
+    /** Write limit_violations to port if it has changed since the last call*/
+    void writeLimitViolations();
 
-    /** Update the motion constraints of a particular element*/
-    virtual void updateMotionConstraints(const MotionConstraint& constraint,
-                                         const size_t idx,
-                                         RMLInputParameters* new_input_parameters) = 0;
+    /** Finish the trace of the current cycle and write it to port. Does nothing if cycle tracing is disabled*/
+    void writeCycleTrace();
 
-    /** Read the current state from port and return position and flow status*/
-    virtual bool updateCurrentState(RMLInputParameters* new_input_parameters) = 0;
+    /** Validate the target arbitration config of a joint space task and configure target_arbiter. Arbitration and target merging are mutually
+     *  exclusive. Returns false and logs the reason if the configuration is invalid*/
+    bool configureTargetArbitration(const TargetArbitrationConfig& config, const bool target_merging);
 
-    /** Update the RML input parameters with the new target */
-    virtual bool updateTarget(RMLInputParameters* new_input_parameters) = 0;
+    /** Target arbitration (joint space tasks): Read the newest samples of the target and constrained_target port of task and select the active
+     *  source. Returns the sample of the active source if it has to be applied (new sample or handover), 0 otherwise. handover is set if the
+     *  active source has changed in this cycle. In that case, the default motion constraints are restored in in, so that the new source does
+     *  not inherit the constraints of the previous one, and the arbitration status is written to port. Defined in RMLTaskCycle.hpp*/
+    template<class Task> const ConstrainedJointsCmd* arbitrateTarget(Task& task, typename Task::Mode::InputParameters& in, bool& handover);
 
-    /** Perform one step of online trajectory generation (call the RML algorithm with the given parameters). Return the RML result value*/
-    virtual ReflexxesResultValue performOTG(RMLInputParameters* new_input_parameters,
-                                            RMLOutputParameters* new_output_parameters,
-                                            RMLFlags *rml_flags) = 0;
+    /** Joint space tasks: Apply a target sample via task.generator. If merge is set, all other elements keep their RML selection and target.
+     *  The sample is merged into task.target (target_merging property) or replaces it. Invalid samples are rejected and reported with the given
+     *  port name. vel_in are passed on to the generator after in, i.e. the velocity input parameters of RMLMixedTask. Defined in RMLTaskCycle.hpp*/
+    template<class Task, class... VelocityInput> void applyJointTarget(Task& task, const ConstrainedJointsCmd& sample, const std::string& port_name,
+                                                                       typename Task::Mode::InputParameters& in, const bool merge, VelocityInput&... vel_in);
 
-    /** Write the generated trajectory to port*/
-    virtual void writeCommand(const RMLOutputParameters& new_output_parameters) = 0;
+    /** Target merging (joint space tasks): Apply all buffered samples of the target and constrained_target port of task with applyJointTarget().
+     *  Defined in RMLTaskCycle.hpp*/
+    template<class Task, class... VelocityInput> void mergeJointTargets(Task& task, typename Task::Mode::InputParameters& in, VelocityInput&... vel_in);
 
-    /** Call echo() method for rml input and output parameters*/
-    virtual void printParams(const RMLInputParameters& in, const RMLOutputParameters& out) = 0;
+    /** Joint space tasks: Update the RML input parameters with the new target of task, by target merging, target arbitration or from the one
+     *  port that is used. If all arbitrated sources have timed out, the joints stop at the last target position or with zero speed. vel_in
+     *  are passed on to the generator, see applyJointTarget(). Returns true if a target is available. Call from updateTarget() of the task.
+     *  Defined in RMLTaskCycle.hpp*/
+    template<class Task, class... VelocityInput> bool updateJointTarget(Task& task, typename Task::Mode::InputParameters& in, VelocityInput&... vel_in);
 
-    /** Convert from RMLInputParameters to orogen type*/
-    virtual const ReflexxesInputParameters& convertRMLInputParams(const RMLInputParameters &in, ReflexxesInputParameters& out) = 0;
+    /** Joint space tasks: Configure the joint trajectory generator of task (task.generator) with the common properties and the mode specific
+     *  fields of config, set up the pre-sized samples and target merging and arbitration. Call from configureHook() of the task after configureMode().
+     *  Returns false and logs the reason on error. Defined in RMLTaskCycle.hpp*/
+    template<class Task> bool configureJointTask(Task& task, JointTrajectoryGeneratorConfig config = JointTrajectoryGeneratorConfig());
 
-    /** Convert from RMLOutputParameters to orogen type*/
-    virtual const ReflexxesOutputParameters& convertRMLOutputParams(const RMLOutputParameters &in, ReflexxesOutputParameters& out) = 0;
+    /** Joint space tasks: Read the newest joint state of task and pass it to the generator of task. The first valid sample initializes the
+     *  interpolator state in, subsequent samples are fused into it if state feedback is enabled. Writes the current sample if a joint state
+     *  has been read. Returns the flow status of the joint_state port. Defined in RMLTaskCycle.hpp*/
+    template<class Task> RTT::FlowStatus readJointState(Task& task, typename Task::Mode::InputParameters& in);
 
-    /** Handle result of the OTG algorithm. Handle errors.*/
-    void handleResultValue(ReflexxesResultValue result_value);
+    /** Joint space tasks without target merging and arbitration: Read the newest sample of the target or constrained_target port of task into
+     *  task.new_target. port_name is set to the name of the port that provided the sample. If both ports have data and one of them a new sample,
+     *  the sample is rejected with VALIDATION_CONFLICTING_TARGETS (i.e. the previous target remains active) and RTT::OldData is returned. Defined in RMLTaskCycle.hpp*/
+    template<class Task> RTT::FlowStatus readJointTarget(Task& task, const std::string*& port_name);
+
+    /** Joint space tasks: Write the statistics of the joint state name layout of task to port. Defined in RMLTaskCycle.hpp*/
+    template<class Task> void writeLayoutStats(Task& task);
+
+    /** Joint space tasks: Write task.command, which has to contain the output of the current cycle, and update the current sample.
+     *  Defined in RMLTaskCycle.hpp*/
+    template<class Task> void writeJointCommand(Task& task);
+
+    /** Joint space tasks: Pre-size the port samples that all joint space tasks have. Defined in RMLTaskCycle.hpp*/
+    template<class Task> void presizeJointSamples(Task& task);
+
+    /** Evaluate n candidate targets on a scratch OTG backend, starting from a snapshot of the interpolator state. The snapshot is only
+     *  taken on request, i.e. this waits for the next cycle (at most two cycles plus MAX_QUERY_SNAPSHOT_DELAY). set_target(i, params, error)
+     *  has to write candidate i to params. Can be called from any thread.*/
+    std::vector<TargetEvaluation> evaluatePositionTargets(const size_t n,
+        std::function<ValidationStatus(size_t, RMLPositionInputParameters&, InputValidationError&)> set_target);
+
+    /** Allocate the scratch backend and command_preview for the given number of setpoints. 0 disables the preview. Joint space tasks only,
+     *  call from configureHook() after RMLTask::configureHook(). Returns false if length is negative. Defined in RMLTaskCycle.hpp*/
+    template<class Mode> bool configureCommandPreview(const int length);
+
+    /** Compute command_preview by stepping preview_backend from the current interpolator state. The first setpoint is the output of the
+     *  current cycle and has the given time stamp. Call after the OTG step. If positions is false, only speeds and accelerations are given.*/
+    template<class Mode> void updateCommandPreview(const base::Time& time, const bool positions);
+
+    /** Compute command_preview (see updateCommandPreview()) and write it to the given port. Does nothing if the preview is disabled.
+     *  Defined in RMLTaskCycle.hpp*/
+    template<class Mode> void writeCommandPreview(RTT::OutputPort<base::JointsTrajectory>& port, const base::Time& time, const bool positions);
+
+    /** Store the new state of motion in out as setpoint idx of command_preview*/
+    void storePreviewSample(const RMLOutputParameters& out, const size_t idx, const bool positions);
+
+    /** Run dummy OTG cycles and pre-size all port samples, so that the first real cycle runs with steady-state latency. Call from
+     *  startHook() of the task with Task::Mode. Defined in RMLTaskCycle.hpp*/
+    template<class Mode> void warmUp();
+
+    /** Run the given number of dummy OTG cycles on the given backend, using the configured motion constraints. The dummy motion
+     *  starts and ends within the position limits. The task's input/output parameters are not modified. Defined in RMLTaskCycle.hpp*/
+    template<class Mode> void warmUpBackend(OTGBackend* backend, const unsigned int cycles);
+
+    /** Report the rejection of a sample on the given input port. The reason has to be filled in validation_error before.
+     *  Writes validation_error to the input_validation_error port. Does not allocate memory for port and element names up to
+     *  MAX_VALIDATION_NAME_LENGTH characters. Logs at most one message per second, further rejections are only counted*/
+    void reportValidationError(const std::string& port);
 
 public:
     RMLTask(std::string const& name = "trajectory_generation::RMLTask");
@@ -89,7 +318,80 @@ public:
     void errorHook();
     void stopHook();
     void cleanupHook();
+
+    /** Advance the simulated clock by the given number of cycles. Returns false if the task is not running on the simulated clock*/
+    bool step(boost::uint32_t cycles);
+
+    /** Current time of the task: Simulated time if simulated_clock is set, system time otherwise*/
+    base::Time now() const {return simulated_clock ? simulated_time : base::Time::now();}
 };
+
+template<class Mode> ReflexxesResultValue RMLTask::stepOTG(typename Mode::InputParameters& in,
+                                                          typename Mode::OutputParameters& out,
+                                                          const typename Mode::Flags& flags){
+    int result = Mode::run(*otg_backend, in, out, flags);
+    if(needsFallback(result) && runFallback<Mode>(in, out, flags, result))
+        fallback_active = true;
+
+    // Always feed back the new state as the current state. This means that the current robot position
+    // is completely ignored. However, on a real robot, using the current position as input in RML will NOT work!
+    *in.CurrentPositionVector     = *out.NewPositionVector;
+    *in.CurrentVelocityVector     = *out.NewVelocityVector;
+    *in.CurrentAccelerationVector = *out.NewAccelerationVector;
+
+    return (ReflexxesResultValue)result;
+}
+
+template<class Mode> bool RMLTask::runFallback(const typename Mode::InputParameters& in,
+                                               typename Mode::OutputParameters& out,
+                                               const typename Mode::Flags& flags,
+                                               const int result){
+    fallback_status.error = (ReflexxesResultValue)result;
+    if(fallback_mode == OTG_FALLBACK_INDEPENDENT){
+        typename Mode::Flags independent_flags = flags;
+        independent_flags.SynchronizationBehavior = RMLFlags::NO_SYNCHRONIZATION;
+        if(Mode::run(*fallback_backend, in, out, independent_flags) >= 0){
+            fallback_status.mode = OTG_FALLBACK_INDEPENDENT;
+            return true;
+        }
+    }
+    if(!controlledStop(in, out))
+        return false;
+    fallback_status.mode = OTG_FALLBACK_STOP;
+    return true;
+}
+
+template<class Mode> void RMLTask::updateCommandPreview(const base::Time& time, const bool positions){
+    const typename Mode::InputParameters& in   = static_cast<const typename Mode::InputParameters&>(*rml_input_parameters);
+    const typename Mode::OutputParameters& out = static_cast<const typename Mode::OutputParameters&>(*rml_output_parameters);
+    const typename Mode::Flags& flags          = static_cast<const typename Mode::Flags&>(*rml_flags);
+    typename Mode::InputParameters& preview_in   = static_cast<typename Mode::InputParameters&>(*preview_input);
+    typename Mode::OutputParameters& preview_out = static_cast<typename Mode::OutputParameters&>(*preview_output);
+
+    // Continue from the state of the active backend (bypassing the trajectory cache), so that the preview matches the next outputs.
+    // The new state has already been fed back to the input parameters by stepOTG()
+    preview_backend->copyState(trajectory_cache ? *trajectory_cache->getBackend() : *otg_backend);
+    preview_in = in;
+
+    const size_t length = command_preview.times.size();
+    storePreviewSample(out, 0, positions);
+    command_preview.times[0] = time;
+    for(size_t k = 1; k < length; k++){
+        if(Mode::run(*preview_backend, preview_in, preview_out, flags) < 0){
+            // Hold the last valid setpoint, the active OTG will fail in the same way
+            for(size_t i = 0; i < command_preview.size(); i++)
+                command_preview[i][k] = command_preview[i][k-1];
+        }
+        else{
+            *preview_in.CurrentPositionVector     = *preview_out.NewPositionVector;
+            *preview_in.CurrentVelocityVector     = *preview_out.NewVelocityVector;
+            *preview_in.CurrentAccelerationVector = *preview_out.NewAccelerationVector;
+            storePreviewSample(preview_out, k, positions);
+        }
+        command_preview.times[k] = time + base::Time::fromSeconds(k * cycle_time);
+    }
+}
+
 }
 
 #endif
@@ -0,0 +1,526 @@
+#ifndef RML_TASK_CYCLE_HPP
+#define RML_TASK_CYCLE_HPP
+
+#include "RMLTask.hpp"
+#include "Conversions.hpp"
+#include <base-logging/Logging.hpp>
+
+namespace trajectory_generation{
+
+template<class Task> void RMLTask::runCycle(Task& task){
+    if(!simulated_clock){
+        runSingleCycle(task, base::Time::now());
+        return;
+    }
+    // As with the periodic activity, no further cycles are run in the error state
+    for(; pending_cycles > 0 && state() != RML_ERROR; pending_cycles--){
+        simulated_time = simulated_time + base::Time::fromSeconds(cycle_time);
+        runSingleCycle(task, simulated_time);
+    }
+}
+
+template<class Task> void RMLTask::runSingleCycle(Task& task, const base::Time& time){
+    typedef typename Task::Mode Mode;
+    typename Mode::InputParameters& in   = static_cast<typename Mode::InputParameters&>(*rml_input_parameters);
+    typename Mode::OutputParameters& out = static_cast<typename Mode::OutputParameters&>(*rml_output_parameters);
+    const typename Mode::Flags& flags    = static_cast<const typename Mode::Flags&>(*rml_flags);
+
+    // Computation time is always measured on the system clock
+    const base::Time start_time = base::Time::now();
+    if(tracer.isEnabled())
+        tracer.beginCycle(time, start_time);
+    if(!timestamp.isNull())
+        _actual_cycle_time.write((time - timestamp).toSeconds());
+    timestamp = time;
+
+    bool has_input;
+    {
+        ScopedStageTimer stage_timer(tracer, STAGE_CURRENT_STATE);
+        has_input = task.updateCurrentState(in);
+    }
+    if(!has_input){
+        if(state() != NO_CURRENT_STATE)
+            state(NO_CURRENT_STATE);
+        // The initial state might have been rejected because of its position limits
+        writeLimitViolations();
+        writeCycleTrace();
+        return;
+    }
+
+    target_changed = false;
+    {
+        ScopedStageTimer stage_timer(tracer, STAGE_TARGET);
+        has_input = task.updateTarget(in);
+    }
+    if(!has_input){
+        if(state() != NO_TARGET)
+            state(NO_TARGET);
+        writeCycleTrace();
+        return;
+    }
+
+    if(state() == NO_TARGET || state() == NO_CURRENT_STATE)
+        state(RUNNING);
+
+    bool derated;
+    {
+        ScopedStageTimer stage_timer(tracer, STAGE_CONSTRAINTS);
+        // Apply after the target, so that the motion constraints of a new constrained target are derated in the same cycle
+        updateDeratingFactors();
+        derated = derating.apply(in, cycle_time) > 0;
+        if(derated){
+            derating_status = derating.getStatus();
+            derating_status.time = timestamp;
+            _derating_status.write(derating_status);
+        }
+
+        if(sync_member.isJoined())
+            synchronizeWithGroup(in);
+
+        applyDeadline(in);
+    }
+
+    unsigned int wcet_path = 0;
+    if(wcet_tracking){
+        // Keep the input before the step, it becomes the seed of the path if this cycle turns out to be a new worst case
+        static_cast<typename Mode::InputParameters&>(*wcet_input) = in;
+        wcet_path = (target_changed ? WCET_NEW_TARGET : 0) |
+                    (target_changed && limit_violations.any() ? WCET_POSITION_LIMITS : 0) |
+                    (in.MinimumSynchronizationTime > 0 ? WCET_SYNCHRONIZATION : 0) |
+                    (derated ? WCET_DERATING : 0);
+    }
+
+    {
+        ScopedStageTimer stage_timer(tracer, STAGE_OTG);
+        fallback_active = false;
+        rml_result_value = task.performOTG(in, out, flags);
+        handleResultValue<Mode>(rml_result_value);
+        if(fallback_backend)
+            updateFallbackStatus();
+    }
+
+    {
+        ScopedStageTimer stage_timer(tracer, STAGE_MONITORING);
+        writeLimitViolations();
+        if(deadline.isActive())
+            evaluateDeadline(in, out);
+
+        if(trajectory_cache){
+            const TrajectoryCacheStats& stats = trajectory_cache->getStats();
+            if(stats.hits + stats.misses != trajectory_cache_stats.hits + trajectory_cache_stats.misses){
+                trajectory_cache_stats = stats;
+                trajectory_cache_stats.time = timestamp;
+                _trajectory_cache_stats.write(trajectory_cache_stats);
+            }
+        }
+
+        if(query_snapshot)
+            updateQuerySnapshot(in);
+    }
+
+    {
+        ScopedStageTimer stage_timer(tracer, STAGE_WRITE_COMMAND);
+        task.writeCommand(out);
+        if(shm_command.isOpen())
+            shm_command.write(out.NewPositionVector->VecData,
+                              out.NewVelocityVector->VecData,
+                              out.NewAccelerationVector->VecData,
+                              timestamp);
+    }
+
+    {
+        ScopedStageTimer stage_timer(tracer, STAGE_DEBUG_OUTPUT);
+        // write debug data
+        rmlTypes2InputParams(in, input_parameters);
+        rmlTypes2OutputParams(out, output_parameters);
+        _rml_input_parameters.write(input_parameters);
+        _rml_output_parameters.write(output_parameters);
+    }
+    const double computation_time = (base::Time::now() - start_time).toSeconds();
+    _computation_time.write(computation_time);
+    if(wcet_tracking)
+        updateWCET<Mode>(wcet_path, computation_time);
+    writeCycleTrace();
+}
+
+template<class Task> const ConstrainedJointsCmd* RMLTask::arbitrateTarget(Task& task, typename Task::Mode::InputParameters& in, bool& handover){
+    const base::Time time = now();
+    // Samples on the target port never carry motion constraints
+    bool new_data[2];
+    new_data[0] = task._target.readNewest(arbitration_samples[0]) == RTT::NewData;
+    new_data[1] = task._constrained_target.readNewest(arbitration_samples[1]) == RTT::NewData;
+    if(new_data[0])
+        target_arbiter.addSample(TARGET_SOURCE_TARGET, time);
+    if(new_data[1])
+        target_arbiter.addSample(TARGET_SOURCE_CONSTRAINED_TARGET, time);
+
+    const TargetSource previous = target_arbiter.getStatus().active_source;
+    const TargetSource source = target_arbiter.select(time);
+    handover = source != previous;
+    if(handover){
+        for(size_t i = 0; i < motion_constraints.size(); i++)
+            motionConstraint2RmlTypes(motion_constraints[i], i, in);
+        derating.limitsReplaced();
+        task._target_arbitration_status.write(target_arbiter.getStatus());
+    }
+    if(source == TARGET_SOURCE_NONE || !(handover || new_data[source - 1]))
+        return 0;
+    return &arbitration_samples[source - 1];
+}
+
+template<class Task, class... VelocityInput> void RMLTask::applyJointTarget(Task& task, const ConstrainedJointsCmd& sample, const std::string& port_name,
+                                                                           typename Task::Mode::InputParameters& in, const bool merge, VelocityInput&... vel_in){
+    if(task.generator.setTarget(sample, in, vel_in..., limit_violations, validation_error, merge) != VALIDATION_OK){
+        reportValidationError(port_name);
+        return;
+    }
+    derating.limitsReplaced(sample);
+    if(task.target_merging)
+        mergeJointTarget(sample, task.target);
+    else
+        task.target = sample;
+    has_target = target_changed = true;
+}
+
+template<class Task, class... VelocityInput> void RMLTask::mergeJointTargets(Task& task, typename Task::Mode::InputParameters& in, VelocityInput&... vel_in){
+    // Apply all buffered samples, so that the samples of the other publishers are not dropped: First all samples of the target port, then all
+    // samples of the constrained_target port, each port in the order of arrival. If both ports have samples for the same joint in one cycle,
+    // the one of constrained_target wins, regardless of the sample times
+    task.new_target.motion_constraints.clear();
+    while(task._target.read(task.new_target, false) == RTT::NewData)
+        applyJointTarget(task, task.new_target, task._target.getName(), in, has_target, vel_in...);
+    while(task._constrained_target.read(task.new_target, false) == RTT::NewData)
+        applyJointTarget(task, task.new_target, task._constrained_target.getName(), in, has_target, vel_in...);
+}
+
+template<class Task, class... VelocityInput> bool RMLTask::updateJointTarget(Task& task, typename Task::Mode::InputParameters& in, VelocityInput&... vel_in){
+    if(task.target_merging){
+        mergeJointTargets(task, in, vel_in...);
+        return has_target;
+    }
+
+    if(target_arbiter.isEnabled()){
+        // Only the samples of the active source are applied. On handover, the last sample of the new source becomes the target
+        bool handover;
+        const ConstrainedJointsCmd* sample = arbitrateTarget(task, in, handover);
+        if(sample){
+            const TargetSource source = target_arbiter.getStatus().active_source;
+            applyJointTarget(task, *sample, source == TARGET_SOURCE_TARGET ? task._target.getName() : task._constrained_target.getName(), in, false,
+                             vel_in...);
+        }
+        else if(handover && has_target){
+            // All sources have timed out: Stop at the last target position (position controlled joints) instead of passing it with the last
+            // target speed, or with zero speed (velocity controlled joints). The default motion constraints have been restored by
+            // arbitrateTarget, so the constraints of the timed out sample are not applied again
+            for(size_t i = 0; i < task.target.size(); i++)
+                task.target[i].speed = 0;
+            task.target.motion_constraints.clear();
+            const TargetSource source = target_arbiter.getStatus().previous_source;
+            if(task.generator.setTarget(task.target, in, vel_in..., limit_violations, validation_error) != VALIDATION_OK)
+                reportValidationError(source == TARGET_SOURCE_TARGET ? task._target.getName() : task._constrained_target.getName());
+            else
+                target_changed = true;
+        }
+        return has_target;
+    }
+
+    const std::string* port_name;
+    if(readJointTarget(task, port_name) == RTT::NewData){
+        // Invalid samples are rejected without modifying the input parameters, i.e. the previous target remains active. With
+        // POSITIONAL_LIMITS_ACTIVELY_PREVENT, target positions are cropped at the position limits and target speeds pointing towards a close
+        // position limit are set to zero by the generator (Type IV)
+        if(task.generator.setTarget(task.new_target, in, vel_in..., limit_violations, validation_error) != VALIDATION_OK){
+            reportValidationError(*port_name);
+            return has_target;
+        }
+        std::swap(task.target, task.new_target);
+        derating.limitsReplaced(task.target);
+        has_target = target_changed = true;
+    }
+    return has_target;
+}
+
+template<class Task> bool RMLTask::configureJointTask(Task& task, JointTrajectoryGeneratorConfig config){
+    // The task runs its own OTG cycle on rml_input_parameters, so the generator is configured without backend
+    config.motion_constraints = motion_constraints;
+    config.cycle_time = cycle_time;
+    config.otg_backend = _otg_backend.get();
+    config.synchronization_behavior = _synchronization_behavior.get();
+    config.positional_limits_behavior = positional_limits_behavior;
+    config.state_feedback = task._state_feedback.get();
+    if(!task.generator.configure(config, false)){
+        LOG_ERROR("%s: Failed to configure the joint trajectory generator", this->getName().c_str());
+        return false;
+    }
+    // Size the samples now, so that the first read/write in the cycle does not allocate memory
+    task.joint_state.resize(motion_constraints.size());
+    task.command.resize(motion_constraints.size());
+    task.command.names = motion_constraints.names;
+
+    task.target_merging = task._target_merging.get();
+    if(!configureTargetArbitration(task._target_arbitration.get(), task.target_merging))
+        return false;
+    // Merged targets contain all configured joints (unset until a sample for the joint arrives), so that merging never grows the sample
+    if(task.target_merging){
+        task.target.names = motion_constraints.names;
+        task.target.elements.assign(motion_constraints.size(), base::JointState());
+        task.target.motion_constraints.assign(motion_constraints.size(), MotionConstraint());
+    }
+    // The fed back state never continues a cached trajectory, so the cache would miss (and restart its recording) in every cycle
+    if(config.state_feedback.enabled && trajectory_cache){
+        LOG_ERROR("%s: The trajectory cache cannot be combined with state feedback", this->getName().c_str());
+        return false;
+    }
+    return true;
+}
+
+template<class Task> RTT::FlowStatus RMLTask::readJointState(Task& task, typename Task::Mode::InputParameters& in){
+    RTT::FlowStatus fs = task._joint_state.readNewest(task.joint_state);
+    if(fs == RTT::NewData){
+        const NameLayoutCache& layout = task.generator.getJointStateLayout();
+        const uint64_t lookups = layout.hits() + layout.misses();
+        ValidationStatus status = task.generator.setCurrentState(task.joint_state, now(), in, limit_violations, validation_error);
+        if(layout.hits() + layout.misses() != lookups)
+            writeLayoutStats(task);
+        if(status != VALIDATION_OK){
+            reportValidationError(task._joint_state.getName());
+            return fs;
+        }
+        if(!has_current_state){
+            task.current_sample.names = motion_constraints.names;
+            rmlTypes2JointState(in, task.current_sample);
+            has_current_state = true;
+        }
+    }
+    if(fs != RTT::NoData && has_current_state){
+        task.current_sample.time = now();
+        task._current_sample.write(task.current_sample);
+    }
+    return fs;
+}
+
+template<class Task> RTT::FlowStatus RMLTask::readJointTarget(Task& task, const std::string*& port_name){
+    RTT::FlowStatus fs_target = task._target.readNewest(task.new_target);
+    RTT::FlowStatus fs_constr_target = task._constrained_target.readNewest(task.new_target);
+
+    // Two publishers without arbitration or merging: Use only one of the two ports, or enable target_arbitration or target_merging
+    if(fs_constr_target != RTT::NoData && fs_target != RTT::NoData){
+        if(fs_target == RTT::NewData || fs_constr_target == RTT::NewData){
+            validation_error.status = VALIDATION_CONFLICTING_TARGETS;
+            validation_error.name.clear();
+            validation_error.value = base::NaN<double>();
+            reportValidationError(fs_constr_target == RTT::NewData ? task._constrained_target.getName() : task._target.getName());
+        }
+        port_name = &task._constrained_target.getName();
+        return RTT::OldData;
+    }
+
+    if(fs_target != RTT::NoData){
+        port_name = &task._target.getName();
+        return fs_target;
+    }
+    port_name = &task._constrained_target.getName();
+    return fs_constr_target;
+}
+
+template<class Task> void RMLTask::writeLayoutStats(Task& task){
+    task.layout_stats.time   = now();
+    task.layout_stats.hits   = task.generator.getJointStateLayout().hits();
+    task.layout_stats.misses = task.generator.getJointStateLayout().misses();
+    task._joint_state_layout_stats.write(task.layout_stats);
+}
+
+template<class Task> void RMLTask::writeJointCommand(Task& task){
+    rmlTypes2JointState(*rml_input_parameters, task.current_sample);
+    task.current_sample.time = task.command.time = now();
+    task.command.names = motion_constraints.names;
+    task._command.write(task.command);
+}
+
+template<class Mode> void RMLTask::writeCommandPreview(RTT::OutputPort<base::JointsTrajectory>& port, const base::Time& time, const bool positions){
+    if(!preview_backend)
+        return;
+    updateCommandPreview<Mode>(time, positions);
+    port.write(command_preview);
+}
+
+template<class Task> void RMLTask::presizeJointSamples(Task& task){
+    // command has been sized in configureJointTask(). current_sample is only initialized with the first joint state, so use a separate
+    // sample here, the members must not be modified
+    task._command.setDataSample(task.command);
+    base::samples::Joints sample;
+    sample.resize(motion_constraints.size());
+    sample.names = motion_constraints.names;
+    task._current_sample.setDataSample(sample);
+    task._joint_state_layout_stats.setDataSample(task.layout_stats);
+    task._target_arbitration_status.setDataSample(target_arbiter.getStatus());
+}
+
+template<class Mode> bool RMLTask::configureMode(){
+    typename Mode::InputParameters& in = static_cast<typename Mode::InputParameters&>(*rml_input_parameters);
+    for(size_t i = 0; i < motion_constraints.size(); i++)
+        motionConstraint2RmlTypes(motion_constraints[i], i, in);
+
+    if(!configureTrajectoryCache(Mode()) || !configureSyncGroup(Mode()))
+        return false;
+    if(wcet_tracking)
+        wcet_input = new typename Mode::InputParameters(motion_constraints.size());
+    return true;
+}
+
+template<class Mode> bool RMLTask::configureCommandPreview(const int length){
+    if(length < 0){
+        LOG_ERROR("%s: Command preview length must not be negative", this->getName().c_str());
+        return false;
+    }
+    if(length == 0)
+        return true;
+    const size_t n_dof = motion_constraints.size();
+    preview_backend = createBackend();
+    preview_input  = new typename Mode::InputParameters(n_dof);
+    preview_output = new typename Mode::OutputParameters(n_dof);
+    command_preview.names = motion_constraints.names;
+    command_preview.elements.resize(n_dof);
+    for(size_t i = 0; i < n_dof; i++)
+        command_preview[i].resize(length);
+    command_preview.times.resize(length);
+    return true;
+}
+
+template<class Mode> void RMLTask::printParams(){
+    static_cast<typename Mode::InputParameters&>(*rml_input_parameters).Echo();
+    static_cast<typename Mode::OutputParameters&>(*rml_output_parameters).Echo();
+}
+
+template<class Mode> void RMLTask::handleResultValue(ReflexxesResultValue result_value){
+
+    _rml_result_value.write(result_value);
+
+    if(fallback_active){
+        if(state() != FALLBACK)
+            state(FALLBACK);
+        return;
+    }
+
+    switch(result_value){
+    case RML_WORKING:{
+        if(state() != FOLLOWING)
+            state(FOLLOWING);
+        break;
+    }
+    case RML_FINAL_STATE_REACHED:{
+        if(state() != REACHED)
+            state(REACHED);
+        break;
+    }
+    case ReflexxesAPI::RML_ERROR_SYNCHRONIZATION:
+        // Ignore this error. It occurs from time to time without having any effect
+        break;
+    case RML_ERROR_POSITIONAL_LIMITS:{
+        // Returned by Reflexxes Type IV and by the S-curve backend (also with Reflexxes Type II)
+        if(positional_limits_behavior == POSITIONAL_LIMITS_ERROR_MSG_ONLY){
+            LOG_ERROR("RML target position out of bounds. Modify your target position and/or positional limits or "
+                      "choose POSITIONAL_LIMITS_IGNORE/POSITIONAL_LIMITS_ACTIVELY_PREVENT to avoid this error");
+            error(RML_ERROR);
+            printParams<Mode>();
+        }
+        break;
+    }
+    default:{
+#ifdef USING_REFLEXXES_TYPE_IV
+        LOG_ERROR("Error in online trajectory generation algorithm: %s", rml_output_parameters->GetErrorString());
+#endif
+        printParams<Mode>();
+        error(RML_ERROR);
+        break;
+    }
+    }
+}
+
+template<class Mode> void RMLTask::updateWCET(unsigned int path, const double computation_time){
+    if(fallback_active)
+        path |= WCET_FALLBACK;
+    else if(rml_result_value < 0 && rml_result_value != RML_ERROR_SYNCHRONIZATION)
+        path |= WCET_ERROR;
+
+    WCETRecord& record = wcet_stats.paths[path];
+    record.cycles++;
+    if(computation_time <= record.max_computation_time)
+        return;
+
+    record.max_computation_time = computation_time;
+    record.time = timestamp;
+    record.result = rml_result_value;
+    rmlTypes2InputParams(static_cast<const typename Mode::InputParameters&>(*wcet_input), record.input);
+
+    // New worst cases are rare, so the complete statistics are written each time
+    wcet_stats.time = timestamp;
+    wcet_stats.max_computation_time = std::max(wcet_stats.max_computation_time, computation_time);
+    _wcet_stats.write(wcet_stats);
+}
+
+template<class Mode> void RMLTask::warmUp(){
+    const unsigned int cycles = _warm_up.get().cycles;
+    if(cycles > 0){
+        // Bypass the trajectory cache, the dummy motion must not show up in the cache statistics
+        warmUpBackend<Mode>(trajectory_cache ? trajectory_cache->getBackend() : otg_backend, cycles);
+        if(sync_backend)
+            warmUpBackend<Mode>(sync_backend, 1);
+        if(preview_backend)
+            warmUpBackend<Mode>(preview_backend, 1);
+        if(fallback_backend)
+            warmUpBackend<Mode>(fallback_backend, 1);
+    }
+
+    // Touch the parameter objects and pass sized samples to the ports, so that the first cycle neither page faults nor allocates
+    rmlTypes2InputParams(static_cast<const typename Mode::InputParameters&>(*rml_input_parameters), input_parameters);
+    rmlTypes2OutputParams(static_cast<const typename Mode::OutputParameters&>(*rml_output_parameters), output_parameters);
+    _rml_input_parameters.setDataSample(input_parameters);
+    _rml_output_parameters.setDataSample(output_parameters);
+    _input_validation_error.setDataSample(validation_error);
+    _trajectory_cache_stats.setDataSample(trajectory_cache_stats);
+    _deadline_status.setDataSample(deadline.getStatus());
+    _derating_status.setDataSample(derating_status);
+    _otg_fallback_status.setDataSample(fallback_status);
+    _wcet_stats.setDataSample(wcet_stats);
+    _cycle_trace.setDataSample(tracer.getTrace());
+    _limit_violations.setDataSample(limit_violation_status);
+    presizeSamples();
+}
+
+/** Target of the dummy motion of RMLTask::warmUpBackend(): Move to the goal position (position based) or with half of the max. speed (velocity based)*/
+inline void setWarmUpTarget(const MotionConstraint&, const uint idx, const double goal, RMLPositionInputParameters& in){
+    in.TargetPositionVector->VecData[idx] = goal;
+}
+
+inline void setWarmUpTarget(const MotionConstraint& constraint, const uint idx, const double, RMLVelocityInputParameters& in){
+    in.TargetVelocityVector->VecData[idx] = 0.5 * constraint.max.speed;
+}
+
+template<class Mode> void RMLTask::warmUpBackend(OTGBackend* backend, const unsigned int cycles){
+    const uint n_dof = motion_constraints.size();
+    typename Mode::InputParameters in(n_dof);
+    typename Mode::OutputParameters out(n_dof);
+    for(uint i = 0; i < n_dof; i++){
+        const double lo = motion_constraints[i].min.position, hi = motion_constraints[i].max.position;
+        const bool has_lo = !base::isNaN(lo) && !base::isInfinity(lo), has_hi = !base::isNaN(hi) && !base::isInfinity(hi);
+        const double start = has_lo ? (has_hi ? lo + 0.25 * (hi - lo) : lo + 0.5) : (has_hi ? hi - 1.0 : 0.0);
+        const double goal  = has_hi ? (has_lo ? lo + 0.75 * (hi - lo) : hi - 0.5) : start + 0.5;
+        motionConstraint2RmlTypes(motion_constraints[i], i, in);
+        in.SelectionVector->VecData[i] = true;
+        in.CurrentPositionVector->VecData[i] = start;
+        setWarmUpTarget(motion_constraints[i], i, goal, in);
+    }
+
+    const typename Mode::Flags& flags = static_cast<const typename Mode::Flags&>(*rml_flags);
+    for(uint c = 0; c < cycles; c++){
+        Mode::run(*backend, in, out, flags);
+        *in.CurrentPositionVector     = *out.NewPositionVector;
+        *in.CurrentVelocityVector     = *out.NewVelocityVector;
+        *in.CurrentAccelerationVector = *out.NewAccelerationVector;
+    }
+}
+
+}
+
+#endif
@@ -2,6 +2,7 @@
 
 #include "RMLVelocityTask.hpp"
 #include <base-logging/Logging.hpp>
+#include "RMLTaskCycle.hpp"
 #include "Conversions.hpp"
 
 using namespace trajectory_generation;
@@ -14,125 +15,54 @@ bool RMLVelocityTask::configureHook(){
     no_reference_timeout = _no_reference_timeout.get();
     if(base::isNaN(no_reference_timeout))
         no_reference_timeout = base::infinity<double>();
-    convert_to_position = _convert_to_position.get();
-    max_pos_diff = _max_pos_diff.get();
 
     if (! RMLVelocityTaskBase::configureHook())
         return false;
+    JointTrajectoryGeneratorConfig generator_config;
+    generator_config.convert_to_position = _convert_to_position.get();
+    generator_config.max_pos_diff = _max_pos_diff.get();
+    if(!configureMode<Mode>() || !configureJointTask(*this, generator_config) || !configureCommandPreview<Mode>(_command_preview_length.get()))
+        return configureFailed();
+    return true;
+}
 
-    if(max_pos_diff.size() > 0 && max_pos_diff.size() != rml_input_parameters->NumberOfDOFs){
-        LOG_ERROR("%s: Max pos. diff has %i entries but configured number of DOF is %i",
-                  this->getName().c_str(), max_pos_diff.size(), rml_input_parameters->NumberOfDOFs);
+bool RMLVelocityTask::startHook(){
+    if (! RMLVelocityTaskBase::startHook())
         return false;
-    }
-
+    warmUp<Mode>();
     return true;
 }
 
-void RMLVelocityTask::updateMotionConstraints(const MotionConstraint& constraint,
-                                              const size_t idx,
-                                              RMLInputParameters* new_input_parameters){
-    motionConstraint2RmlTypes(constraint, idx, *(RMLVelocityInputParameters*)new_input_parameters);
+void RMLVelocityTask::updateHook(){
+    RMLVelocityTaskBase::updateHook();
+    runCycle(*this);
 }
 
-bool RMLVelocityTask::updateCurrentState(RMLInputParameters* new_input_parameters){
-    RTT::FlowStatus fs = _joint_state.readNewest(joint_state);
-    if(fs == RTT::NewData && !has_current_state){
-        jointState2RmlTypes(joint_state, motion_constraints.names, *rml_flags, *new_input_parameters);
-        current_sample.names = motion_constraints.names;
-        rmlTypes2JointState(*new_input_parameters, current_sample);
-        has_current_state = true;
-    }
-    if(fs != RTT::NoData){
-        current_sample.time = base::Time::now();
-        _current_sample.write(current_sample);
-    }
+bool RMLVelocityTask::updateCurrentState(RMLVelocityInputParameters& new_input_parameters){
+    readJointState(*this, new_input_parameters);
     return has_current_state;
 }
 
-bool RMLVelocityTask::updateTarget(RMLInputParameters* new_input_parameters){
-    RTT::FlowStatus fs_target = _target.readNewest(target);
-    RTT::FlowStatus fs_constr_target = _constrained_target.readNewest(target);
-
-    if(fs_constr_target != RTT::NoData && fs_target != RTT::NoData)
-        throw std::runtime_error("There is data on both, the target AND the constrained_target port. You should use only one of the two ports!");
-
-    RTT::FlowStatus fs = RTT::NoData;
-    if(fs_target != RTT::NoData)
-        fs = fs_target;
-    else if(fs_constr_target != RTT::NoData)
-        fs = fs_constr_target;
-
-    if(fs == RTT::NewData){
-        has_target = true;
-        target.validate();
-        target2RmlTypes(target, motion_constraints, *(RMLVelocityInputParameters*)new_input_parameters);
-#ifdef USING_REFLEXXES_TYPE_IV
-        // Workaround: If an element is close to a position limit and the target velocity is pointing in direction of the limit, the sychronization time is computed by
-        // reflexxes as if the constrained joint could move freely in the direction of the limit. This leads to incorrect synchronization time for all other elements.
-        // Set the target velocity to zero in this case!
-        if(rml_flags->PositionalLimitsBehavior == POSITIONAL_LIMITS_ACTIVELY_PREVENT)
-            fixRmlSynchronizationBug(cycle_time, *(RMLVelocityInputParameters*)new_input_parameters);
-#endif
-    }
-
-
-    return has_target;
-}
-
-void RMLVelocityTask::correctInterpolatorState(RMLInputParameters *in,
-                                               RMLOutputParameters *out,
-                                               const base::samples::Joints &act,
-                                               const base::VectorXd& max_diff){
-
-    target2RmlTypes(target, motion_constraints, *(RMLVelocityInputParameters*)in);
-    for(uint i = 0; i < in->NumberOfDOFs; i++){
-        const base::JointState& js = act.getElementByName(motion_constraints.names[i]);
-        if(fabs(out->NewPositionVector->VecData[i] - js.position) > max_diff(i))
-            in->TargetVelocityVector->VecData[i]     = 0.0;
-    }
+bool RMLVelocityTask::updateTarget(RMLVelocityInputParameters& new_input_parameters){
+    return updateJointTarget(*this, new_input_parameters);
 }
 
-ReflexxesResultValue RMLVelocityTask::performOTG(RMLInputParameters* new_input_parameters, RMLOutputParameters* new_output_parameters, RMLFlags *rml_flags){
-
-    if(convert_to_position && max_pos_diff.size() > 0)
-        correctInterpolatorState(new_input_parameters, new_output_parameters, joint_state, max_pos_diff);
-
-    int result = rml_api->RMLVelocity(*(RMLVelocityInputParameters*)new_input_parameters,
-                                       (RMLVelocityOutputParameters*)new_output_parameters,
-                                      *(RMLVelocityFlags*)rml_flags );
-
-    // Always feed back the new state as the current state. This means that the current robot position
-    // is completely ignored. However, on a real robot, using the current position as input in RML will NOT work!
-    *new_input_parameters->CurrentPositionVector     = *new_output_parameters->NewPositionVector;
-    *new_input_parameters->CurrentVelocityVector     = *new_output_parameters->NewVelocityVector;
-    *new_input_parameters->CurrentAccelerationVector = *new_output_parameters->NewAccelerationVector;
-
-    return (ReflexxesResultValue)result;
-}
-
-void RMLVelocityTask::writeCommand(const RMLOutputParameters& new_output_parameters){
-    if(convert_to_position)
-        rmlTypes2Command((RMLPositionOutputParameters&)new_output_parameters, command);
-    else
-        rmlTypes2Command((RMLVelocityOutputParameters&)new_output_parameters, command);
-    rmlTypes2JointState(*rml_input_parameters, current_sample);
-    current_sample.time = command.time = base::Time::now();
-    command.names = motion_constraints.names;
-    _command.write(command);
-}
+ReflexxesResultValue RMLVelocityTask::performOTG(RMLVelocityInputParameters& new_input_parameters,
+                                                 RMLVelocityOutputParameters& new_output_parameters,
+                                                 const RMLVelocityFlags& rml_flags){
 
-void RMLVelocityTask::printParams(const RMLInputParameters& in, const RMLOutputParameters& out){
-    ((RMLVelocityInputParameters&  )in).Echo();
-    ((RMLVelocityOutputParameters& )out).Echo();
+    // Integrator windup: Stop the joints that cannot follow the interpolator (only if convert_to_position is set and max_pos_diff is given)
+    generator.correctInterpolatorState(new_input_parameters, new_output_parameters);
+    return stepOTG<Mode>(new_input_parameters, new_output_parameters, rml_flags);
 }
 
-const ReflexxesInputParameters& RMLVelocityTask::convertRMLInputParams(const RMLInputParameters &in, ReflexxesInputParameters& out){
-    rmlTypes2InputParams((RMLVelocityInputParameters&)in, out);
-    return out;
+void RMLVelocityTask::writeCommand(const RMLVelocityOutputParameters& new_output_parameters){
+    generator.writeCommand(new_output_parameters, command);
+    writeJointCommand(*this);
+    writeCommandPreview<Mode>(_command_preview, command.time, generator.getConfig().convert_to_position);
 }
 
-const ReflexxesOutputParameters& RMLVelocityTask::convertRMLOutputParams(const RMLOutputParameters &in, ReflexxesOutputParameters& out){
-    rmlTypes2OutputParams((RMLVelocityOutputParameters&)in, out);
-    return out;
+void RMLVelocityTask::presizeSamples(){
+    presizeJointSamples(*this);
+    _command_preview.setDataSample(command_preview);
 }
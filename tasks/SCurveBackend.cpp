@@ -0,0 +1,673 @@
+#include "SCurveBackend.hpp"
+#include <base/Float.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace trajectory_generation{
+
+typedef SCurveBackend::Profile Profile;
+
+namespace{
+
+/** Max. number of bisection steps for the peak velocity/acceleration. Enough to resolve them up to double precision*/
+const int N_BISECTION_STEPS = 64;
+
+/** Relative tolerance of the collinearity check of phase synchronization*/
+const double PHASE_SYNC_EPSILON = 1e-6;
+
+/** Max. distance by which a stretched profile may overshoot the target without cruise phase, before its duration is considered to be
+ *  within an inoperative time interval. Covers the round-off of the bisection*/
+const double STRETCH_OVERSHOOT_TOLERANCE = 1e-9;
+
+/** State of motion of a single DOF*/
+struct DofState{
+    double p, v, a;
+};
+
+/** Current state, target and limits of a single DOF*/
+struct DofGoal{
+    DofState s;
+    double p, v;
+    double V, A, J;
+};
+
+/** Integrate the given state with constant jerk j over time t*/
+inline DofState integrate(const DofState& s, const double j, const double t){
+    DofState n;
+    n.p = s.p + s.v*t + s.a*t*t/2 + j*t*t*t/6;
+    n.v = s.v + s.a*t + j*t*t/2;
+    n.a = s.a + j*t;
+    return n;
+}
+
+/** Velocity that will be reached if the acceleration is brought to zero as fast as possible*/
+inline double zeroAccelerationVelocity(const DofState& s, const double J){
+    return s.v + s.a*fabs(s.a)/(2*J);
+}
+
+inline DofGoal mirrored(const DofGoal& g){
+    DofGoal m = g;
+    m.s.p = -g.s.p;
+    m.s.v = -g.s.v;
+    m.s.a = -g.s.a;
+    m.p = -g.p;
+    m.v = -g.v;
+    return m;
+}
+
+inline void mirror(Profile& pr){
+    pr.p0 = -pr.p0;
+    pr.v0 = -pr.v0;
+    pr.a0 = -pr.a0;
+    for(unsigned int i = 0; i < pr.n_phases; i++)
+        pr.jerk[i] = -pr.jerk[i];
+    pr.p_end = -pr.p_end;
+    pr.v_end = -pr.v_end;
+    pr.peak_velocity = -pr.peak_velocity;
+}
+
+/** Start an empty profile at state s and time t_start*/
+inline void start(Profile& pr, const DofState& s, const double t_start){
+    pr.t_start = t_start;
+    pr.p0 = s.p;
+    pr.v0 = s.v;
+    pr.a0 = s.a;
+    pr.n_phases = 0;
+    pr.t_end = 0;
+    pr.p_end = s.p;
+    pr.v_end = s.v;
+    pr.peak_velocity = base::NaN<double>();
+    pr.braking = false;
+    pr.replan_after_braking = false;
+}
+
+/** Append a phase with jerk j over time t and integrate s accordingly*/
+inline void addPhase(Profile& pr, DofState& s, const double t, const double j){
+    if(!(t > 0))
+        return;
+    pr.duration[pr.n_phases] = t;
+    pr.jerk[pr.n_phases] = j;
+    pr.n_phases++;
+    pr.t_end += t;
+    s = integrate(s, j, t);
+}
+
+/** Append the time-optimal phases that change the velocity of s to v and its acceleration to zero: jerk towards the peak acceleration,
+ *  constant peak acceleration (if the limit A is reached), jerk back to zero acceleration*/
+void addVelocityChange(Profile& pr, DofState& s, const double v, const double A, const double J){
+    const double dir = v >= zeroAccelerationVelocity(s, J) ? 1 : -1;
+    const double a0 = s.a*dir;
+    const double dv = (v - s.v)*dir;
+    double a_peak = sqrt(std::max(J*dv + a0*a0/2, 0.0));
+    double t_hold = 0;
+    if(a_peak > A){
+        a_peak = A;
+        t_hold = std::max((dv - (a0 + A)*fabs(A - a0)/(2*J) - A*A/(2*J))/A, 0.0);
+    }
+    addPhase(pr, s, fabs(a_peak - a0)/J, a_peak >= a0 ? dir*J : -dir*J);
+    addPhase(pr, s, t_hold, 0);
+    addPhase(pr, s, a_peak/J, -dir*J);
+    s.v = v;
+    s.a = 0;
+}
+
+/** Position at which the DOF comes to rest when braking as hard as the acceleration and jerk limits allow*/
+double restPosition(const DofState& s, const double A, const double J){
+    Profile pr;
+    DofState rest = s;
+    start(pr, s, 0);
+    addVelocityChange(pr, rest, 0, A, J);
+    return rest.p;
+}
+
+/** Profile via peak velocity vc: velocity change to vc, cruise with vc over time tc, velocity change to the target velocity. Returns the final state*/
+DofState peakProfile(Profile& pr, const DofGoal& g, const double vc, const double tc){
+    DofState s = g.s;
+    start(pr, s, 0);
+    addVelocityChange(pr, s, vc, g.A, g.J);
+    addPhase(pr, s, tc, 0);
+    addVelocityChange(pr, s, g.v, g.A, g.J);
+    return s;
+}
+
+/** Profile that applies jerk j over time t and then changes the velocity directly to the target velocity. Returns the final state*/
+DofState directProfile(Profile& pr, const DofGoal& g, const double j, const double t){
+    DofState s = g.s;
+    start(pr, s, 0);
+    addPhase(pr, s, t, j);
+    addVelocityChange(pr, s, g.v, g.A, g.J);
+    return s;
+}
+
+/** Velocity based profile with peak acceleration A*/
+void velocityProfile(Profile& pr, const DofGoal& g, const double A){
+    DofState s = g.s;
+    start(pr, s, 0);
+    addVelocityChange(pr, s, g.v, A, g.J);
+    pr.p_end = s.p;
+    pr.v_end = g.v;
+}
+
+/** x between x_below and x_above with f(x) = y, for a monotonic function f with f(x_below) <= y <= f(x_above)*/
+template<class F> double bisect(const F& f, const double y, double x_below, double x_above){
+    for(int i = 0; i < N_BISECTION_STEPS; i++){
+        const double mid = (x_below + x_above)/2;
+        if(mid == x_below || mid == x_above)
+            break;
+        if(f(mid) <= y)
+            x_below = mid;
+        else
+            x_above = mid;
+    }
+    return (x_below + x_above)/2;
+}
+
+/** Time-optimal position based profile for g.v <= zeroAccelerationVelocity(g.s). The distance travelled without cruise phase
+ *  increases monotonically along the following profile families, which join continuously:
+ *  - Cruise at -V
+ *  - Valley: Peak velocity vc from -V up to the target velocity
+ *  - Only if the DOF currently decelerates: Jerk +J for some time, then change the velocity directly to the target velocity
+ *  - Peak: vc from the zero acceleration velocity up to V. If the DOF is faster than V, vc goes down to V instead (the DOF has to
+ *    decelerate twice)
+ *  - Cruise at V*/
+void timeOptimalNormalized(Profile& pr, const DofGoal& g){
+    const double vs = zeroAccelerationVelocity(g.s, g.J);
+    auto peak = [&](const double vc){ return peakProfile(pr, g, vc, 0).p; };
+
+    double vc = -g.V, tc = 0;
+    if(g.p <= peak(-g.V))
+        tc = (g.p - peak(-g.V))/-g.V;
+    else if(g.p <= peak(g.v))
+        vc = bisect(peak, g.p, -g.V, g.v);
+    else{
+        const double t_max = -g.s.a/g.J;
+        auto direct = [&](const double t){ return directProfile(pr, g, g.J, t).p; };
+        if(t_max > 0 && g.p <= direct(t_max)){
+            directProfile(pr, g, g.J, bisect(direct, g.p, 0.0, t_max));
+            return;
+        }
+        vc = g.V;
+        if(g.p > peak(g.V))
+            tc = (g.p - peak(g.V))/g.V;
+        else
+            vc = bisect(peak, g.p, vs, g.V);
+    }
+    peakProfile(pr, g, vc, tc);
+    pr.peak_velocity = vc;
+}
+
+/** Time-optimal profile of position based OTG*/
+void timeOptimalPosition(Profile& pr, const DofGoal& g){
+    if(g.v <= zeroAccelerationVelocity(g.s, g.J))
+        timeOptimalNormalized(pr, g);
+    else{
+        timeOptimalNormalized(pr, mirrored(g));
+        mirror(pr);
+    }
+    pr.p_end = g.p;
+    pr.v_end = g.v;
+}
+
+/** Stretch a position based profile to duration T by moving its peak velocity towards zero. Below the time-optimal peak velocity, the
+ *  profile may change the velocity twice in the same direction, e.g. accelerate to the peak velocity, cruise and accelerate further to the
+ *  target velocity. The duration goes to infinity with the peak velocity going to zero.
+ *  Changing the velocity in two steps travels further than changing it at once, so that the DOF may overshoot the target without cruise
+ *  phase for a range of peak velocities. The durations of that range cannot be reached (inoperative time interval). If T lies within it,
+ *  the profile ends as early as possible after T instead, with the highest peak velocity below at which the target is reached without cruise
+ *  phase. Returns false in this case*/
+bool stretchPosition(Profile& pr, const DofGoal& g, const double T){
+    const double vc_opt = pr.peak_velocity;
+    if(base::isNaN(vc_opt) || vc_opt == 0)
+        return true;
+    auto cruiseTime = [&](const double vc){ return (g.p - peakProfile(pr, g, vc, 0).p)/vc; };
+    auto duration = [&](const double vc){
+        const double tc = cruiseTime(vc);
+        return pr.t_end + tc;
+    };
+    double vc = bisect(duration, T, vc_opt, 0.0);
+    const bool reachable = cruiseTime(vc)*fabs(vc) > -STRETCH_OVERSHOOT_TOLERANCE;
+    if(!reachable){
+        auto overshoot = [&](const double x){ return (peakProfile(pr, g, x, 0).p - g.p)*(vc_opt > 0 ? 1 : -1); };
+        vc = bisect(overshoot, 0.0, 0.0, vc);
+    }
+    peakProfile(pr, g, vc, std::max(cruiseTime(vc), 0.0));
+    pr.peak_velocity = vc;
+    pr.p_end = g.p;
+    pr.v_end = g.v;
+    return reachable;
+}
+
+/** Time-optimal profile of velocity based OTG*/
+void timeOptimalVelocity(Profile& pr, const DofGoal& g){
+    velocityProfile(pr, g, g.A);
+}
+
+/** Stretch a velocity based profile to duration T by lowering its peak acceleration*/
+void stretchVelocity(Profile& pr, const DofGoal& g, const double T){
+    auto duration = [&](const double A){
+        velocityProfile(pr, g, A);
+        return pr.t_end;
+    };
+    velocityProfile(pr, g, bisect(duration, T, g.A, 0.0));
+}
+
+/** Profile that brakes from state s at time t as fast as possible*/
+void brakingProfile(Profile& pr, const DofState& s, const double t, const double A, const double J){
+    DofState rest = s;
+    start(pr, s, t);
+    addVelocityChange(pr, rest, 0, A, J);
+    pr.p_end = rest.p;
+    pr.v_end = 0;
+    pr.braking = true;
+}
+
+/** State of the given profile at time t*/
+DofState sample(const Profile& pr, double t){
+    t -= pr.t_start;
+    if(t >= pr.t_end){
+        DofState s = {pr.p_end + pr.v_end*(t - pr.t_end), pr.v_end, 0};
+        return s;
+    }
+    DofState s = {pr.p0, pr.v0, pr.a0};
+    for(unsigned int i = 0; i < pr.n_phases; i++){
+        if(t <= pr.duration[i])
+            return integrate(s, pr.jerk[i], t);
+        s = integrate(s, pr.jerk[i], pr.duration[i]);
+        t -= pr.duration[i];
+    }
+    return s;
+}
+
+inline DofState currentState(const RMLInputParameters& in, const unsigned int idx){
+    DofState s;
+    s.p = in.CurrentPositionVector->VecData[idx];
+    s.v = in.CurrentVelocityVector->VecData[idx];
+    s.a = in.CurrentAccelerationVector->VecData[idx];
+    return s;
+}
+
+/** Goal of DOF idx. max_velocity is infinite for velocity based OTG*/
+inline DofGoal dofGoal(const RMLInputParameters& in, const unsigned int idx, const DofState& s, const double target_position, const double max_velocity){
+    DofGoal g;
+    g.s = s;
+    g.p = target_position;
+    g.v = in.TargetVelocityVector->VecData[idx];
+    g.V = max_velocity;
+    g.A = in.MaxAccelerationVector->VecData[idx];
+    g.J = in.MaxJerkVector->VecData[idx];
+    return g;
+}
+
+inline void setNewState(const DofState& s, RMLOutputParameters* out, const unsigned int idx){
+    out->NewPositionVector->VecData[idx]     = s.p;
+    out->NewVelocityVector->VecData[idx]     = s.v;
+    out->NewAccelerationVector->VecData[idx] = s.a;
+}
+
+}
+
+SCurveBackend::SCurveBackend(const unsigned int n_dof, const double cycle_time) :
+    n_dof(n_dof),
+    cycle_time(cycle_time),
+    min_position(n_dof, -base::infinity<double>()),
+    max_position(n_dof, base::infinity<double>()),
+    limits_behavior(POSITIONAL_LIMITS_IGNORE),
+    last_input(6*n_dof + 2, base::NaN<double>()),
+    input(6*n_dof + 2, base::NaN<double>()),
+    last_output(3*n_dof, base::NaN<double>()),
+    profiles(n_dof),
+    direction(n_dof, 0.0),
+    ratio(n_dof, 1.0),
+    synchronization_time(0),
+    elapsed_time(0),
+    phase_synchronized(false){
+    const DofState rest = {0, 0, 0};
+    for(unsigned int i = 0; i < n_dof; i++)
+        start(profiles[i], rest, 0);
+}
+
+void SCurveBackend::setPositionLimits(const std::vector<double>& min_pos,
+                                      const std::vector<double>& max_pos,
+                                      const PositionalLimitsBehavior behavior){
+    if(min_pos.size() != n_dof || max_pos.size() != n_dof)
+        throw std::invalid_argument("Size of position limits does not match number of DOF");
+    min_position = min_pos;
+    max_position = max_pos;
+    limits_behavior = behavior;
+}
+
+void SCurveBackend::copyState(const OTGBackend& other){
+    const SCurveBackend* source = dynamic_cast<const SCurveBackend*>(&other);
+    // Vectors of equal size are copied without allocating memory
+    if(source && source != this && source->n_dof == n_dof)
+        *this = *source;
+}
+
+void SCurveBackend::holdState(const RMLInputParameters& in, RMLOutputParameters* out, const unsigned int idx){
+    out->NewPositionVector->VecData[idx]     = in.CurrentPositionVector->VecData[idx];
+    out->NewVelocityVector->VecData[idx]     = in.CurrentVelocityVector->VecData[idx];
+    out->NewAccelerationVector->VecData[idx] = in.CurrentAccelerationVector->VecData[idx];
+    out->ExecutionTimes->VecData[idx]        = 0;
+}
+
+bool SCurveBackend::inputChanged(const RMLInputParameters& in, const RMLDoubleVector* target_position, const RMLDoubleVector* max_velocity, const int sync_behavior){
+    for(unsigned int i = 0; i < n_dof; i++){
+        double* elem = &input[6*i];
+        elem[0] = in.SelectionVector->VecData[i];
+        elem[1] = target_position ? target_position->VecData[i] : 0;
+        elem[2] = in.TargetVelocityVector->VecData[i];
+        elem[3] = max_velocity ? max_velocity->VecData[i] : 0;
+        elem[4] = in.MaxAccelerationVector->VecData[i];
+        elem[5] = in.MaxJerkVector->VecData[i];
+    }
+    input[6*n_dof]     = in.MinimumSynchronizationTime;
+    input[6*n_dof + 1] = sync_behavior;
+
+    bool changed = !std::equal(input.begin(), input.end(), last_input.begin());
+    for(unsigned int i = 0; i < n_dof && !changed; i++)
+        changed = last_output[3*i]   != in.CurrentPositionVector->VecData[i] ||
+                  last_output[3*i+1] != in.CurrentVelocityVector->VecData[i] ||
+                  last_output[3*i+2] != in.CurrentAccelerationVector->VecData[i];
+    last_input.swap(input);
+    return changed;
+}
+
+void SCurveBackend::storeOutput(const RMLOutputParameters& out){
+    for(unsigned int i = 0; i < n_dof; i++){
+        last_output[3*i]   = out.NewPositionVector->VecData[i];
+        last_output[3*i+1] = out.NewVelocityVector->VecData[i];
+        last_output[3*i+2] = out.NewAccelerationVector->VecData[i];
+    }
+}
+
+bool SCurveBackend::validLimits(const RMLInputParameters& in, const RMLDoubleVector* max_velocity){
+    for(unsigned int i = 0; i < n_dof; i++){
+        if(!in.SelectionVector->VecData[i])
+            continue;
+        if(!(in.MaxAccelerationVector->VecData[i] > 0) || !(in.MaxJerkVector->VecData[i] > 0))
+            return false;
+        if(max_velocity && !(max_velocity->VecData[i] > 0 && fabs(in.TargetVelocityVector->VecData[i]) <= max_velocity->VecData[i]))
+            return false;
+    }
+    return true;
+}
+
+double SCurveBackend::targetPosition(const RMLDoubleVector& target_position, const unsigned int idx) const{
+    if(limits_behavior == POSITIONAL_LIMITS_IGNORE)
+        return target_position.VecData[idx];
+    return std::max(std::min(target_position.VecData[idx], max_position[idx]), min_position[idx]);
+}
+
+int SCurveBackend::phaseReference(const RMLInputParameters& in, const double* const vectors[], const unsigned int n_vectors){
+    // Reference is the DOF with the largest entry in the first vector that is not zero
+    int ref = -1;
+    const double* ref_vector = 0;
+    for(unsigned int v = 0; v < n_vectors && ref < 0; v++){
+        double max_abs = 0;
+        for(unsigned int i = 0; i < n_dof; i++){
+            if(in.SelectionVector->VecData[i] && fabs(vectors[v][i]) > max_abs){
+                max_abs = fabs(vectors[v][i]);
+                ref = i;
+            }
+        }
+        ref_vector = vectors[v];
+    }
+    if(ref < 0){
+        // All DOF are at rest in their target state
+        for(unsigned int i = 0; i < n_dof; i++)
+            ratio[i] = 0;
+        for(unsigned int i = 0; i < n_dof && ref < 0; i++)
+            if(in.SelectionVector->VecData[i])
+                ref = i;
+        if(ref >= 0)
+            ratio[ref] = 1;
+        return ref;
+    }
+
+    for(unsigned int i = 0; i < n_dof; i++){
+        ratio[i] = ref_vector[i]/ref_vector[ref];
+        if(!in.SelectionVector->VecData[i])
+            continue;
+        for(unsigned int v = 0; v < n_vectors; v++){
+            const double scaled = ratio[i]*vectors[v][ref];
+            if(fabs(vectors[v][i] - scaled) > PHASE_SYNC_EPSILON*(fabs(vectors[v][i]) + fabs(scaled)) + 1e-12)
+                return -1;
+        }
+    }
+    return ref;
+}
+
+bool SCurveBackend::plan(const RMLInputParameters& in, const RMLDoubleVector* target_position, const RMLDoubleVector* max_velocity, const int sync_behavior){
+    const bool position_based = target_position != 0;
+    elapsed_time = 0;
+    synchronization_time = 0;
+    phase_synchronized = false;
+
+    int ref = -1;
+    if(sync_behavior == RMLFlags::PHASE_SYNCHRONIZATION_IF_POSSIBLE || sync_behavior == RMLFlags::ONLY_PHASE_SYNCHRONIZATION){
+        for(unsigned int i = 0; i < n_dof; i++)
+            direction[i] = position_based ? targetPosition(*target_position, i) - in.CurrentPositionVector->VecData[i] :
+                                            in.TargetVelocityVector->VecData[i] - in.CurrentVelocityVector->VecData[i];
+        const double* const position_vectors[] = {direction.data(), in.CurrentVelocityVector->VecData,
+                                                  in.CurrentAccelerationVector->VecData, in.TargetVelocityVector->VecData};
+        const double* const velocity_vectors[] = {direction.data(), in.CurrentAccelerationVector->VecData};
+        ref = position_based ? phaseReference(in, position_vectors, 4) : phaseReference(in, velocity_vectors, 2);
+        if(ref < 0 && sync_behavior == RMLFlags::ONLY_PHASE_SYNCHRONIZATION)
+            return false;
+    }
+
+    if(ref >= 0){
+        // All DOF follow the profile of the reference DOF, with the limits of the DOF that limits the common motion most
+        DofGoal g = dofGoal(in, ref, currentState(in, ref), position_based ? targetPosition(*target_position, ref) : 0,
+                            position_based ? max_velocity->VecData[ref] : base::infinity<double>());
+        for(unsigned int i = 0; i < n_dof; i++){
+            if(!in.SelectionVector->VecData[i] || ratio[i] == 0)
+                continue;
+            if(position_based)
+                g.V = std::min(g.V, max_velocity->VecData[i]/fabs(ratio[i]));
+            g.A = std::min(g.A, in.MaxAccelerationVector->VecData[i]/fabs(ratio[i]));
+            g.J = std::min(g.J, in.MaxJerkVector->VecData[i]/fabs(ratio[i]));
+        }
+        g.v = std::max(std::min(g.v, g.V), -g.V);
+
+        Profile& pr = profiles[ref];
+        position_based ? timeOptimalPosition(pr, g) : timeOptimalVelocity(pr, g);
+        // Within an inoperative time interval, the motion ends as early as possible after the min. synchronization time
+        if(in.MinimumSynchronizationTime > pr.t_end && position_based)
+            stretchPosition(pr, g, in.MinimumSynchronizationTime);
+        else if(in.MinimumSynchronizationTime > pr.t_end)
+            stretchVelocity(pr, g, in.MinimumSynchronizationTime);
+        synchronization_time = pr.t_end;
+        phase_synchronized = true;
+
+        for(unsigned int i = 0; i < n_dof; i++){
+            if(!in.SelectionVector->VecData[i] || i == (unsigned int)ref)
+                continue;
+            Profile& p = profiles[i];
+            p = pr;
+            p.p0 = in.CurrentPositionVector->VecData[i];
+            p.v0 = ratio[i]*pr.v0;
+            p.a0 = ratio[i]*pr.a0;
+            for(unsigned int k = 0; k < p.n_phases; k++)
+                p.jerk[k] = ratio[i]*pr.jerk[k];
+            p.p_end = position_based ? targetPosition(*target_position, i) : p.p0 + ratio[i]*(pr.p_end - pr.p0);
+            p.v_end = in.TargetVelocityVector->VecData[i];
+        }
+        return true;
+    }
+
+    // Time-optimal profile of each DOF
+    for(unsigned int i = 0; i < n_dof; i++){
+        if(!in.SelectionVector->VecData[i])
+            continue;
+        const DofGoal g = dofGoal(in, i, currentState(in, i), position_based ? targetPosition(*target_position, i) : 0,
+                                  position_based ? max_velocity->VecData[i] : base::infinity<double>());
+        position_based ? timeOptimalPosition(profiles[i], g) : timeOptimalVelocity(profiles[i], g);
+        synchronization_time = std::max(synchronization_time, profiles[i].t_end);
+    }
+    if(!base::isNaN(in.MinimumSynchronizationTime))
+        synchronization_time = std::max(synchronization_time, in.MinimumSynchronizationTime);
+    if(sync_behavior == RMLFlags::NO_SYNCHRONIZATION)
+        return true;
+
+    // Time synchronization: Stretch the faster DOF. If a DOF cannot end at the synchronization time, postpone it to the end of the
+    // DOF's inoperative time interval and stretch the other DOF again
+    bool postponed = true;
+    while(postponed){
+        postponed = false;
+        for(unsigned int i = 0; i < n_dof; i++){
+            if(!in.SelectionVector->VecData[i] || !(profiles[i].t_end < synchronization_time))
+                continue;
+            const DofGoal g = dofGoal(in, i, currentState(in, i), position_based ? targetPosition(*target_position, i) : 0,
+                                      position_based ? max_velocity->VecData[i] : base::infinity<double>());
+            if(!position_based)
+                stretchVelocity(profiles[i], g, synchronization_time);
+            else if(!stretchPosition(profiles[i], g, synchronization_time)){
+                synchronization_time = profiles[i].t_end;
+                postponed = true;
+            }
+        }
+    }
+    return true;
+}
+
+bool SCurveBackend::step(const RMLInputParameters& in, RMLOutputParameters* out, const unsigned int idx, const double target_position,
+                         const double max_velocity, const bool position_based){
+    Profile& pr = profiles[idx];
+    const double t = elapsed_time + cycle_time;
+    DofState s = sample(pr, t);
+
+    if(limits_behavior == POSITIONAL_LIMITS_ACTIVELY_PREVENT){
+        const double A = in.MaxAccelerationVector->VecData[idx];
+        const double J = in.MaxJerkVector->VecData[idx];
+        if(pr.braking && pr.replan_after_braking && elapsed_time >= pr.t_start + pr.t_end){
+            // At rest after braking: Plan again towards the target, without synchronization
+            const DofGoal g = dofGoal(in, idx, sample(pr, elapsed_time), target_position, max_velocity);
+            position_based ? timeOptimalPosition(pr, g) : timeOptimalVelocity(pr, g);
+            pr.t_start = elapsed_time;
+            s = sample(pr, t);
+        }
+        // Brake instead if the DOF could not stop before the limits after this cycle (and moves further out)
+        const DofState current = sample(pr, elapsed_time);
+        const double rest = restPosition(s, A, J);
+        const double current_rest = restPosition(current, A, J);
+        if(!pr.braking && ((rest > max_position[idx] && rest > current_rest) || (rest < min_position[idx] && rest < current_rest))){
+            const bool final_state_reached = elapsed_time >= pr.t_start + pr.t_end;
+            brakingProfile(pr, current, elapsed_time, A, J);
+            pr.replan_after_braking = !(position_based && final_state_reached);
+            s = sample(pr, t);
+        }
+    }
+
+    setNewState(s, out, idx);
+    out->ExecutionTimes->VecData[idx] = std::max(pr.t_start + pr.t_end - elapsed_time, 0.0);
+    return t >= pr.t_start + pr.t_end && (!pr.braking || !pr.replan_after_braking);
+}
+
+int SCurveBackend::RMLPosition(const RMLPositionInputParameters& in,
+                               RMLPositionOutputParameters* out,
+                               const RMLPositionFlags& flags){
+    if(in.GetNumberOfDOFs() != n_dof || out->GetNumberOfDOFs() != n_dof)
+        return RML_ERROR_NUMBER_OF_DOFS;
+    if(!validLimits(in, in.MaxVelocityVector)){
+        for(unsigned int i = 0; i < n_dof; i++)
+            holdState(in, out, i);
+        return RML_ERROR_INVALID_INPUT_VALUES;
+    }
+
+    bool limits_violated = false;
+    for(unsigned int i = 0; i < n_dof; i++)
+        if(in.SelectionVector->VecData[i] && targetPosition(*in.TargetPositionVector, i) != in.TargetPositionVector->VecData[i])
+            limits_violated = true;
+
+    bool new_calculation = inputChanged(in, in.TargetPositionVector, in.MaxVelocityVector, flags.SynchronizationBehavior);
+    if(new_calculation && !plan(in, in.TargetPositionVector, in.MaxVelocityVector, flags.SynchronizationBehavior)){
+        // Plan again in the next call
+        std::fill(last_input.begin(), last_input.end(), base::NaN<double>());
+        for(unsigned int i = 0; i < n_dof; i++)
+            holdState(in, out, i);
+        return RML_ERROR_NO_PHASE_SYNCHRONIZATION;
+    }
+
+    bool final_state_reached = true;
+    unsigned int slowest_dof = 0;
+    for(unsigned int i = 0; i < n_dof; i++){
+        if(!in.SelectionVector->VecData[i]){
+            holdState(in, out, i);
+            continue;
+        }
+        const bool reached = step(in, out, i, targetPosition(*in.TargetPositionVector, i), in.MaxVelocityVector->VecData[i], true);
+        final_state_reached = final_state_reached && reached;
+        if(out->ExecutionTimes->VecData[i] > out->ExecutionTimes->VecData[slowest_dof])
+            slowest_dof = i;
+    }
+
+    out->ANewCalculationWasPerformed = new_calculation;
+    out->TrajectoryIsPhaseSynchronized = phase_synchronized;
+    out->DOFWithTheGreatestExecutionTime = slowest_dof;
+    out->SynchronizationTime = std::max(synchronization_time - elapsed_time, 0.0);
+    elapsed_time += cycle_time;
+    storeOutput(*out);
+
+    if(limits_violated && limits_behavior == POSITIONAL_LIMITS_ERROR_MSG_ONLY)
+        return RML_ERROR_POSITIONAL_LIMITS;
+    return final_state_reached ? RML_FINAL_STATE_REACHED : RML_WORKING;
+}
+
+int SCurveBackend::RMLVelocity(const RMLVelocityInputParameters& in,
+                               RMLVelocityOutputParameters* out,
+                               const RMLVelocityFlags& flags){
+    if(in.GetNumberOfDOFs() != n_dof || out->GetNumberOfDOFs() != n_dof)
+        return RML_ERROR_NUMBER_OF_DOFS;
+    if(!validLimits(in, 0)){
+        for(unsigned int i = 0; i < n_dof; i++)
+            holdState(in, out, i);
+        return RML_ERROR_INVALID_INPUT_VALUES;
+    }
+
+    bool limits_violated = false;
+    for(unsigned int i = 0; i < n_dof; i++){
+        const double p = in.CurrentPositionVector->VecData[i];
+        if(in.SelectionVector->VecData[i] && limits_behavior != POSITIONAL_LIMITS_IGNORE && (p > max_position[i] || p < min_position[i]))
+            limits_violated = true;
+    }
+
+    bool new_calculation = inputChanged(in, 0, 0, flags.SynchronizationBehavior);
+    if(new_calculation && !plan(in, 0, 0, flags.SynchronizationBehavior)){
+        std::fill(last_input.begin(), last_input.end(), base::NaN<double>());
+        for(unsigned int i = 0; i < n_dof; i++){
+            holdState(in, out, i);
+            out->PositionValuesAtTargetVelocity->VecData[i] = in.CurrentPositionVector->VecData[i];
+        }
+        return RML_ERROR_NO_PHASE_SYNCHRONIZATION;
+    }
+
+    bool final_state_reached = true;
+    unsigned int slowest_dof = 0;
+    for(unsigned int i = 0; i < n_dof; i++){
+        if(!in.SelectionVector->VecData[i]){
+            holdState(in, out, i);
+            out->PositionValuesAtTargetVelocity->VecData[i] = in.CurrentPositionVector->VecData[i];
+            continue;
+        }
+        const bool reached = step(in, out, i, 0, base::infinity<double>(), false);
+        final_state_reached = final_state_reached && reached;
+        out->PositionValuesAtTargetVelocity->VecData[i] = profiles[i].p_end;
+        if(out->ExecutionTimes->VecData[i] > out->ExecutionTimes->VecData[slowest_dof])
+            slowest_dof = i;
+    }
+
+    out->ANewCalculationWasPerformed = new_calculation;
+    out->TrajectoryIsPhaseSynchronized = phase_synchronized;
+    out->DOFWithTheGreatestExecutionTime = slowest_dof;
+    out->SynchronizationTime = std::max(synchronization_time - elapsed_time, 0.0);
+    elapsed_time += cycle_time;
+    storeOutput(*out);
+
+    if(limits_violated && limits_behavior == POSITIONAL_LIMITS_ERROR_MSG_ONLY)
+        return RML_ERROR_POSITIONAL_LIMITS;
+    return final_state_reached ? RML_FINAL_STATE_REACHED : RML_WORKING;
+}
+
+}
@@ -0,0 +1,112 @@
+#ifndef SCURVE_BACKEND_HPP
+#define SCURVE_BACKEND_HPP
+
+#include "OTGBackend.hpp"
+
+namespace trajectory_generation{
+
+/** Built-in time-optimal, jerk-limited online trajectory generator.
+ *
+ *  Whenever the input changes, the time-optimal profile of every DOF is computed: up to seven phases of constant jerk (+J, 0 or -J), which
+ *  change the current velocity and acceleration to a peak velocity, cruise with it and change it to the target velocity (standard 7-phase
+ *  S-curve). The peak velocity is found by bisection on the travelled distance. In the following cycles, the profiles are only sampled, so the
+ *  motion ends exactly in the target state and the velocity, acceleration and jerk limits also hold between the samples.
+ *
+ *  Synchronization:
+ *  - Time synchronization: The profiles of the faster DOF are stretched to the synchronization time by lowering their peak velocity (position
+ *    based OTG) or peak acceleration (velocity based OTG). DOF that cannot be slowed down that much, e.g. because the current velocity has
+ *    to be reduced as fast as possible anyway, reach their target earlier.
+ *  - Phase synchronization: If distance to the target, current velocity, current acceleration and target velocity (velocity based OTG: velocity
+ *    change and current acceleration) of all selected DOF are collinear, all DOF follow one profile that is scaled per DOF, i.e. they move on a
+ *    straight line. Otherwise, time synchronization is used, or RML_ERROR_NO_PHASE_SYNCHRONIZATION is returned with ONLY_PHASE_SYNCHRONIZATION.
+ *
+ *  Limitations compared to Reflexxes:
+ *  - The position limits are given once by setPositionLimits() instead of being part of the input parameters. RML_ERROR_POSITIONAL_LIMITS
+ *    is returned with POSITIONAL_LIMITS_ERROR_MSG_ONLY also if Reflexxes Type II is linked.
+ *  - With POSITIONAL_LIMITS_ACTIVELY_PREVENT, a DOF that could no longer stop before its limit when following its profile for one more cycle
+ *    brakes as fast as possible instead and is re-planned (unsynchronized) once it is at rest.
+ */
+class SCurveBackend : public OTGBackend{
+public:
+    SCurveBackend(const unsigned int n_dof, const double cycle_time);
+
+    virtual void setPositionLimits(const std::vector<double>& min_position,
+                                   const std::vector<double>& max_position,
+                                   const PositionalLimitsBehavior behavior);
+
+    virtual void copyState(const OTGBackend& other);
+
+    virtual int RMLPosition(const RMLPositionInputParameters& in,
+                            RMLPositionOutputParameters* out,
+                            const RMLPositionFlags& flags);
+
+    virtual int RMLVelocity(const RMLVelocityInputParameters& in,
+                            RMLVelocityOutputParameters* out,
+                            const RMLVelocityFlags& flags);
+
+    /** Max. number of constant jerk phases of a profile*/
+    static const unsigned int MAX_PHASES = 7;
+
+    /** Phases of constant jerk of a single DOF*/
+    struct Profile{
+        double t_start;                         /** Start time, relative to the last new calculation*/
+        double p0, v0, a0;                      /** State at t_start*/
+        double duration[MAX_PHASES];
+        double jerk[MAX_PHASES];
+        unsigned int n_phases;
+        double t_end;                           /** Duration of all phases*/
+        double p_end, v_end;                    /** Final state (at zero acceleration). The DOF moves on with v_end afterwards*/
+        double peak_velocity;                   /** Peak velocity of position based OTG, NaN if the profile has none (cannot be stretched)*/
+        bool braking;                           /** Braking because of the position limits*/
+        bool replan_after_braking;              /** Plan again once at rest. False if braking started after the final state was reached*/
+    };
+
+protected:
+    unsigned int n_dof;
+    double cycle_time;
+    std::vector<double> min_position;           /** Lower position limits, -inf if not set*/
+    std::vector<double> max_position;           /** Upper position limits, +inf if not set*/
+    PositionalLimitsBehavior limits_behavior;
+
+    std::vector<double> last_input;             /** Packed input parameters of the previous call. Used to detect changes in the input*/
+    std::vector<double> input;                  /** Packed input parameters of the current call*/
+    std::vector<double> last_output;            /** Packed output state (position/velocity/acceleration) of the previous call*/
+    std::vector<Profile> profiles;              /** Profile of each DOF*/
+    std::vector<double> direction;              /** Distance to the target (velocity based OTG: velocity change) of each DOF*/
+    std::vector<double> ratio;                  /** Ratio of each DOF to the reference DOF for phase synchronization*/
+    double synchronization_time;                /** Synchronization time of the current trajectory*/
+    double elapsed_time;                        /** Time since the last new calculation*/
+    bool phase_synchronized;                    /** Current trajectory is phase synchronized*/
+
+    /** Copy current state to output for all DOF. Used for unselected DOF and on errors*/
+    void holdState(const RMLInputParameters& in, RMLOutputParameters* out, const unsigned int idx);
+
+    /** Pack the given input parameters and check if they differ from the previous call*/
+    bool inputChanged(const RMLInputParameters& in, const RMLDoubleVector* target_position, const RMLDoubleVector* max_velocity, const int sync_behavior);
+
+    /** Store the output state for the change detection in the next call*/
+    void storeOutput(const RMLOutputParameters& out);
+
+    /** Check that the limits and target velocities of all selected DOF are valid*/
+    bool validLimits(const RMLInputParameters& in, const RMLDoubleVector* max_velocity);
+
+    /** Target position of DOF idx, cropped to the position limits unless they are ignored*/
+    double targetPosition(const RMLDoubleVector& target_position, const unsigned int idx) const;
+
+    /** Find the reference DOF of phase synchronization and fill ratio. The given vectors (n_dof values each) have to be collinear for
+     *  all selected DOF. Returns -1 if they are not*/
+    int phaseReference(const RMLInputParameters& in, const double* const vectors[], const unsigned int n_vectors);
+
+    /** Compute the profiles of all selected DOF. Position based OTG if target_position is given, velocity based OTG otherwise.
+     *  Returns false if phase synchronization is required, but not possible*/
+    bool plan(const RMLInputParameters& in, const RMLDoubleVector* target_position, const RMLDoubleVector* max_velocity, const int sync_behavior);
+
+    /** Sample the profile of DOF idx at elapsed_time + cycle_time and write the new state to out. Brakes if the profile would violate
+     *  the position limits. Returns true if the final state has been reached*/
+    bool step(const RMLInputParameters& in, RMLOutputParameters* out, const unsigned int idx, const double target_position,
+              const double max_velocity, const bool position_based);
+};
+
+}
+
+#endif
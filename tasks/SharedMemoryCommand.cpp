@@ -0,0 +1,213 @@
+#include "SharedMemoryCommand.hpp"
+#include <base-logging/Logging.hpp>
+#include <base/Float.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+namespace trajectory_generation{
+
+SharedCommandSegment::SharedCommandSegment() : header(0), data(0), n_dof(0), mapped_size(0){
+}
+
+SharedCommandSegment::~SharedCommandSegment(){
+    unmap();
+}
+
+size_t SharedCommandSegment::segmentSize(const size_t n_dof){
+    // Keep the command data 8-byte aligned
+    size_t header_size = sizeof(SharedCommandHeader) + n_dof * SHARED_COMMAND_NAME_LENGTH;
+    header_size = (header_size + 7) & ~size_t(7);
+    return header_size + 3 * n_dof * sizeof(double);
+}
+
+bool SharedCommandSegment::map(const int fd, const size_t size, const bool writable){
+    void* addr = mmap(0, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if(addr == MAP_FAILED){
+        LOG_ERROR("Unable to map shared memory segment %s: %s", segment_name.c_str(), strerror(errno));
+        return false;
+    }
+    header = (SharedCommandHeader*)addr;
+    mapped_size = size;
+    return true;
+}
+
+void SharedCommandSegment::unmap(){
+    if(header)
+        munmap(header, mapped_size);
+    header = 0;
+    data = 0;
+    n_dof = mapped_size = 0;
+    element_names.clear();
+}
+
+SharedCommandWriter::~SharedCommandWriter(){
+    close();
+}
+
+bool SharedCommandWriter::open(const std::string& name, const std::vector<std::string>& names){
+    close();
+    segment_name = name;
+
+    // Never take over the segment of another writer. Only segments of a crashed writer are removed, they might have a different size.
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if(fd < 0 && errno == EEXIST && isStale(name)){
+        LOG_WARN("Removing shared memory segment %s of a writer process that does not exist anymore", name.c_str());
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if(fd < 0){
+        if(errno == EEXIST)
+            LOG_ERROR("Unable to create shared memory segment %s: The segment is already in use by another writer. "
+                      "Use a different name or, if it has not been created by a writer, remove /dev/shm%s", name.c_str(), name.c_str());
+        else
+            LOG_ERROR("Unable to create shared memory segment %s: %s", name.c_str(), strerror(errno));
+        return false;
+    }
+    const size_t size = segmentSize(names.size());
+    if(ftruncate(fd, size) != 0){
+        LOG_ERROR("Unable to resize shared memory segment %s: %s", name.c_str(), strerror(errno));
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    bool mapped = map(fd, size, true);
+    ::close(fd);
+    if(!mapped){
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    n_dof = names.size();
+    element_names = names;
+    data = (double*)((char*)header + size - 3 * n_dof * sizeof(double));
+    memset((void*)header, 0, size);
+    header->version     = SHARED_COMMAND_VERSION;
+    header->n_dof       = n_dof;
+    header->name_length = SHARED_COMMAND_NAME_LENGTH;
+    header->writer_pid  = getpid();
+    header->sequence.store(0);
+    char* name_table = (char*)header + sizeof(SharedCommandHeader);
+    for(size_t i = 0; i < n_dof; i++)
+        strncpy(name_table + i * SHARED_COMMAND_NAME_LENGTH, names[i].c_str(), SHARED_COMMAND_NAME_LENGTH - 1);
+    for(size_t i = 0; i < 3 * n_dof; i++)
+        data[i] = base::NaN<double>();
+
+    // Readers will only accept the segment once the magic number is set
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = SHARED_COMMAND_MAGIC;
+    return true;
+}
+
+bool SharedCommandWriter::isStale(const std::string& name){
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if(fd < 0)
+        return false;
+    struct stat st;
+    bool stale = false;
+    if(fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(SharedCommandHeader)){
+        void* addr = mmap(0, sizeof(SharedCommandHeader), PROT_READ, MAP_SHARED, fd, 0);
+        if(addr != MAP_FAILED){
+            // Segments that are still being initialized, have another layout or have been created by anything else are never stale
+            const SharedCommandHeader* existing = (const SharedCommandHeader*)addr;
+            stale = existing->magic == SHARED_COMMAND_MAGIC && existing->version == SHARED_COMMAND_VERSION &&
+                    existing->writer_pid > 0 && kill(existing->writer_pid, 0) != 0 && errno == ESRCH;
+            munmap(addr, sizeof(SharedCommandHeader));
+        }
+    }
+    ::close(fd);
+    return stale;
+}
+
+void SharedCommandWriter::close(){
+    if(!isOpen())
+        return;
+    unmap();
+    shm_unlink(segment_name.c_str());
+}
+
+void SharedCommandWriter::write(const double* position, const double* velocity, const double* acceleration, const base::Time& time){
+    const uint64_t seq = header->sequence.load(std::memory_order_relaxed);
+    header->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(data,             position,     n_dof * sizeof(double));
+    memcpy(data + n_dof,     velocity,     n_dof * sizeof(double));
+    memcpy(data + 2 * n_dof, acceleration, n_dof * sizeof(double));
+    header->time = time.toMicroseconds();
+
+    header->sequence.store(seq + 2, std::memory_order_release);
+}
+
+bool SharedCommandReader::open(const std::string& name){
+    close();
+    segment_name = name;
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if(fd < 0){
+        LOG_ERROR("Unable to open shared memory segment %s: %s", name.c_str(), strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SharedCommandHeader)){
+        LOG_ERROR("Shared memory segment %s has not been initialized", name.c_str());
+        ::close(fd);
+        return false;
+    }
+    bool mapped = map(fd, st.st_size, false);
+    ::close(fd);
+    if(!mapped)
+        return false;
+
+    if(header->magic != SHARED_COMMAND_MAGIC || header->version != SHARED_COMMAND_VERSION ||
+       header->name_length != SHARED_COMMAND_NAME_LENGTH || segmentSize(header->n_dof) != mapped_size){
+        LOG_ERROR("Shared memory segment %s has not been initialized or has an incompatible layout", name.c_str());
+        unmap();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    n_dof = header->n_dof;
+    data = (double*)((char*)header + mapped_size - 3 * n_dof * sizeof(double));
+    const char* name_table = (const char*)header + sizeof(SharedCommandHeader);
+    for(size_t i = 0; i < n_dof; i++)
+        element_names.push_back(std::string(name_table + i * SHARED_COMMAND_NAME_LENGTH));
+    buffer.resize(3 * n_dof);
+    last_sequence = 0;
+    return true;
+}
+
+void SharedCommandReader::close(){
+    unmap();
+}
+
+bool SharedCommandReader::read(double* position, double* velocity, double* acceleration, base::Time& time, const int max_retries){
+    for(int i = 0; i < max_retries; i++){
+        const uint64_t seq = header->sequence.load(std::memory_order_acquire);
+        if(seq == last_sequence)
+            return false;
+        if(seq & 1)
+            continue;
+
+        memcpy(buffer.data(), data, 3 * n_dof * sizeof(double));
+        const int64_t t = header->time;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(header->sequence.load(std::memory_order_relaxed) != seq)
+            continue;
+
+        memcpy(position,     buffer.data(),             n_dof * sizeof(double));
+        memcpy(velocity,     buffer.data() + n_dof,     n_dof * sizeof(double));
+        memcpy(acceleration, buffer.data() + 2 * n_dof, n_dof * sizeof(double));
+        time = base::Time::fromMicroseconds(t);
+        last_sequence = seq;
+        return true;
+    }
+    return false;
+}
+
+}
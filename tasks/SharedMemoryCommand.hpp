@@ -0,0 +1,97 @@
+#ifndef SHARED_MEMORY_COMMAND_HPP
+#define SHARED_MEMORY_COMMAND_HPP
+
+#include <base/Time.hpp>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace trajectory_generation{
+
+/** Fixed layout of the shared memory command segment. The header is followed by the element names (n_dof entries of
+ *  SHARED_COMMAND_NAME_LENGTH characters each, zero terminated) and the command data (n_dof positions, followed by n_dof velocities
+ *  and n_dof accelerations). Names and number of DOF are written once when the segment is created, the command data and time are
+ *  updated every cycle and protected by a sequence lock: The sequence number is odd while the writer updates the data.*/
+struct SharedCommandHeader{
+    uint32_t magic;                 /** SHARED_COMMAND_MAGIC once the segment has been initialized*/
+    uint32_t version;               /** SHARED_COMMAND_VERSION*/
+    uint32_t n_dof;                 /** Number of elements*/
+    uint32_t name_length;           /** Size of each entry in the name table*/
+    int32_t writer_pid;             /** Process ID of the writer, used to detect segments left over by a crashed writer*/
+    std::atomic<uint64_t> sequence; /** Incremented before and after each update*/
+    int64_t time;                   /** Time of the command in microseconds since epoch (base::Time)*/
+};
+
+const uint32_t SHARED_COMMAND_MAGIC       = 0x52434d44;
+const uint32_t SHARED_COMMAND_VERSION     = 2;
+const uint32_t SHARED_COMMAND_NAME_LENGTH = 64;
+
+/** Common part of writer and reader: mapping of the shared memory segment*/
+class SharedCommandSegment{
+public:
+    SharedCommandSegment();
+    ~SharedCommandSegment();
+
+    bool isOpen() const {return header != 0;}
+    size_t size() const {return n_dof;}
+    const std::vector<std::string>& names() const {return element_names;}
+
+protected:
+    std::string segment_name;
+    SharedCommandHeader* header;
+    double* data;
+    size_t n_dof;
+    size_t mapped_size;
+    std::vector<std::string> element_names;
+
+    static size_t segmentSize(const size_t n_dof);
+    bool map(const int fd, const size_t size, const bool writable);
+    void unmap();
+};
+
+/** Writes the interpolator output to a shared memory segment (POSIX shm), so that drivers on the same host can read the setpoints
+ *  without data flow marshalling and name lookups. There must be only one writer per segment. Writing never blocks.*/
+class SharedCommandWriter : public SharedCommandSegment{
+public:
+    ~SharedCommandWriter();
+
+    /** Create the segment with the given name, e.g. "/arm_command", and store the element names. Allocates memory, so call this only
+     *  at configuration time. Returns false if the segment cannot be created, in particular if a segment with that name already exists
+     *  and its writer process is still alive. Segments left over by a crashed writer are replaced.*/
+    bool open(const std::string& name, const std::vector<std::string>& names);
+
+    /** Unmap and remove the segment. Does nothing if the segment has not been opened by this writer.*/
+    void close();
+
+    /** Publish a new command. All arrays must have size() elements*/
+    void write(const double* position, const double* velocity, const double* acceleration, const base::Time& time);
+
+protected:
+    /** Returns true if the existing segment with the given name has been created by a writer process that does not exist anymore*/
+    static bool isStale(const std::string& name);
+};
+
+/** Reads commands from a segment that has been created by SharedCommandWriter*/
+class SharedCommandReader : public SharedCommandSegment{
+public:
+    /** Map an existing segment. Returns false if the segment does not exist or has not been initialized yet.
+     *  The element names are available by names() afterwards and do not change while the segment is open.*/
+    bool open(const std::string& name);
+
+    /** Unmap the segment*/
+    void close();
+
+    /** Copy the latest command. All arrays must have size() elements. Returns false if there is no new command since the last call
+     *  or if the writer has been updating the data in all max_retries attempts. The arrays are only modified if true is returned.*/
+    bool read(double* position, double* velocity, double* acceleration, base::Time& time, const int max_retries = 10);
+
+protected:
+    uint64_t last_sequence;
+    std::vector<double> buffer;
+};
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+#include "SyncGroup.hpp"
+#include <map>
+#include <mutex>
+
+namespace trajectory_generation{
+
+static std::mutex registry_mutex;
+static std::map<std::string, SyncGroup*> registry;
+
+SyncGroup::SyncGroup(const std::string& name) : name(name), members(0){
+    for(int i = 0; i < MAX_MEMBERS; i++){
+        used[i] = false;
+        arrival[i].store(0);
+    }
+}
+
+SyncGroup* SyncGroup::join(const std::string& name, int& slot){
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    slot = -1;
+    SyncGroup* group;
+    std::map<std::string, SyncGroup*>::iterator it = registry.find(name);
+    if(it != registry.end())
+        group = it->second;
+    else{
+        group = new SyncGroup(name);
+        registry[name] = group;
+    }
+    for(int i = 0; i < MAX_MEMBERS; i++){
+        if(!group->used[i]){
+            group->used[i] = true;
+            group->arrival[i].store(0);
+            group->members++;
+            slot = i;
+            return group;
+        }
+    }
+    return 0;
+}
+
+void SyncGroup::leave(SyncGroup* group, const int slot){
+    if(!group || slot < 0 || slot >= MAX_MEMBERS)
+        return;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    if(!group->used[slot])
+        return;
+    group->arrival[slot].store(0);
+    group->used[slot] = false;
+    if(--group->members == 0){
+        registry.erase(group->name);
+        delete group;
+    }
+}
+
+void SyncGroup::publish(const int slot, const base::Time& t){
+    arrival[slot].store(t.toMicroseconds(), std::memory_order_release);
+}
+
+base::Time SyncGroup::latestArrival(const base::Time& now) const{
+    int64_t latest = now.toMicroseconds();
+    bool found = false;
+    for(int i = 0; i < MAX_MEMBERS; i++){
+        const int64_t t = arrival[i].load(std::memory_order_acquire);
+        if(t > latest){
+            latest = t;
+            found = true;
+        }
+    }
+    return found ? base::Time::fromMicroseconds(latest) : base::Time();
+}
+
+bool SyncGroupMember::join(const std::string& name){
+    leave();
+    group = SyncGroup::join(name, slot);
+    return group != 0;
+}
+
+void SyncGroupMember::leave(){
+    SyncGroup::leave(group, slot);
+    group = 0;
+    slot = -1;
+    arrival_time = base::Time();
+}
+
+void SyncGroupMember::publish(const base::Time& now, const double duration){
+    arrival_time = now + base::Time::fromSeconds(duration);
+    group->publish(slot, arrival_time);
+}
+
+void SyncGroupMember::update(const base::Time& now, const bool target_reached, const double tolerance, double& min_sync_time){
+    if(arrival_time <= now || target_reached){
+        min_sync_time = 0;
+        return;
+    }
+    const base::Time latest = group->latestArrival(now);
+    if(!latest.isNull() && (latest - arrival_time).toSeconds() > tolerance){
+        min_sync_time = (latest - now).toSeconds();
+        arrival_time = latest;
+    }
+}
+
+}
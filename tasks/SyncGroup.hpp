@@ -0,0 +1,81 @@
+#ifndef SYNC_GROUP_HPP
+#define SYNC_GROUP_HPP
+
+#include <base/Time.hpp>
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+namespace trajectory_generation{
+
+/** Group of trajectory generators within one process that shall reach their targets at the same time. Each member publishes
+ *  the absolute time at which its current motion will end (arrival time) and stretches its own motion to the latest arrival time
+ *  of the group. Publishing and reading are lock-free, joining and leaving a group use a mutex and must only be done at
+ *  configuration time.*/
+class SyncGroup{
+public:
+    /** Max. number of members per group*/
+    static const int MAX_MEMBERS = 16;
+
+    /** Occupy a free slot of the group with the given name, create the group if it does not exist yet. Returns the group and
+     *  stores the slot index in slot. Returns 0 if the group is full*/
+    static SyncGroup* join(const std::string& name, int& slot);
+
+    /** Free the given slot of group. The group is destroyed when its last member leaves*/
+    static void leave(SyncGroup* group, const int slot);
+
+    /** Publish the arrival time of the member in the given slot*/
+    void publish(const int slot, const base::Time& arrival);
+
+    /** Latest arrival time of all members that is after now. Returns base::Time() (null) if no member arrives after now*/
+    base::Time latestArrival(const base::Time& now) const;
+
+    const std::string& getName() const {return name;}
+
+protected:
+    SyncGroup(const std::string& name);
+
+    std::string name;
+    int members;                               /** Number of occupied slots, protected by the registry mutex*/
+    bool used[MAX_MEMBERS];                    /** Occupied slots, protected by the registry mutex*/
+    std::atomic<int64_t> arrival[MAX_MEMBERS]; /** Arrival time in microseconds, 0 if nothing has been published*/
+};
+
+/** Membership of one trajectory generator in a SyncGroup. Keeps the arrival time of the own motion and stretches it (via the minimum
+ *  synchronization time of the OTG algorithm) to the latest arrival of the group. See RMLTask::synchronizeWithGroup()*/
+class SyncGroupMember{
+public:
+    SyncGroupMember() : group(0), slot(-1){}
+    ~SyncGroupMember(){leave();}
+
+    /** Join the group with the given name. Returns false if the group is full*/
+    bool join(const std::string& name);
+
+    /** Leave the group, if any, and forget the arrival time*/
+    void leave();
+
+    bool isJoined() const {return group != 0;}
+
+    /** New target: Publish now + duration (duration of the unsynchronized motion) as arrival time*/
+    void publish(const base::Time& now, const double duration);
+
+    /** Update the minimum synchronization time of the current motion in each cycle. The stretch is dropped (min_sync_time set to 0) once
+     *  the arrival time has passed or the target has been reached, so that it does not affect the next motion. If another member arrives
+     *  more than tolerance seconds later, the motion is stretched to the latest arrival of the group. Otherwise, min_sync_time is kept*/
+    void update(const base::Time& now, const bool target_reached, const double tolerance, double& min_sync_time);
+
+    /** Time at which the own motion ends, including the stretch*/
+    const base::Time& getArrivalTime() const {return arrival_time;}
+
+private:
+    SyncGroup* group;
+    int slot;
+    base::Time arrival_time;
+
+    SyncGroupMember(const SyncGroupMember&);
+    SyncGroupMember& operator=(const SyncGroupMember&);
+};
+
+}
+
+#endif
@@ -0,0 +1,58 @@
+#include "TargetArbiter.hpp"
+
+namespace trajectory_generation{
+
+bool TargetArbiter::configure(const TargetArbitrationConfig& cfg){
+    config = TargetArbitrationConfig();
+    status = TargetArbitrationStatus();
+    last_sample[0] = last_sample[1] = base::Time();
+
+    // Without timeout, a handover back to a lower priority source would resume its last sample, however old it is
+    if(cfg.enabled && !(isValidTimeout(cfg.target_timeout) && isValidTimeout(cfg.constrained_target_timeout)))
+        return false;
+    config = cfg;
+    return true;
+}
+
+void TargetArbiter::addSample(const TargetSource source, const base::Time& now){
+    if(source != TARGET_SOURCE_NONE)
+        last_sample[source - 1] = now;
+}
+
+bool TargetArbiter::isValidTimeout(const double timeout){
+    return timeout > 0 && !base::isInfinity(timeout);
+}
+
+bool TargetArbiter::isAlive(const TargetSource source, const base::Time& now) const{
+    const base::Time& t = last_sample[source - 1];
+    const double timeout = source == TARGET_SOURCE_TARGET ? config.target_timeout : config.constrained_target_timeout;
+    return !t.isNull() && (now - t).toSeconds() <= timeout;
+}
+
+int TargetArbiter::priority(const TargetSource source) const{
+    return source == TARGET_SOURCE_TARGET ? config.target_priority : config.constrained_target_priority;
+}
+
+TargetSource TargetArbiter::select(const base::Time& now){
+    TargetSource selected = TARGET_SOURCE_NONE;
+    if(status.active_source != TARGET_SOURCE_NONE && isAlive(status.active_source, now))
+        selected = status.active_source;
+
+    const TargetSource sources[2] = {TARGET_SOURCE_TARGET, TARGET_SOURCE_CONSTRAINED_TARGET};
+    for(int i = 0; i < 2; i++){
+        if(sources[i] == selected || !isAlive(sources[i], now))
+            continue;
+        if(selected == TARGET_SOURCE_NONE || priority(sources[i]) > priority(selected))
+            selected = sources[i];
+    }
+
+    if(selected != status.active_source){
+        status.previous_source = status.active_source;
+        status.active_source = selected;
+        status.handovers++;
+    }
+    status.time = now;
+    return selected;
+}
+
+}
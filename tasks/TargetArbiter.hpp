@@ -0,0 +1,39 @@
+#ifndef TARGET_ARBITER_HPP
+#define TARGET_ARBITER_HPP
+
+#include "trajectory_generationTypes.hpp"
+
+namespace trajectory_generation{
+
+/** Priority based selection between the target sources of a joint space task (target and constrained_target port), e.g. to let a
+ *  teleoperation input override an autonomous one. A source is alive as long as its last sample is not older than its timeout. The
+ *  alive source with the highest priority is active. Does not allocate memory after configure()*/
+class TargetArbiter{
+public:
+    /** Set the configuration and reset the state. Returns false if arbitration is enabled and a timeout is not positive and finite*/
+    bool configure(const TargetArbitrationConfig& config);
+
+    bool isEnabled() const {return config.enabled;}
+
+    /** Record that a sample of the given source has been received at time now*/
+    void addSample(const TargetSource source, const base::Time& now);
+
+    /** Select the active source at time now. On equal priority, the active source is kept. Returns TARGET_SOURCE_NONE if no source is
+     *  alive. A change of the active source is counted as handover in the status*/
+    TargetSource select(const base::Time& now);
+
+    const TargetArbitrationStatus& getStatus() const {return status;}
+
+private:
+    TargetArbitrationConfig config;
+    TargetArbitrationStatus status;
+    base::Time last_sample[2];    /** Reception time of the last sample of each source, indexed by source - 1*/
+
+    static bool isValidTimeout(const double timeout);
+    bool isAlive(const TargetSource source, const base::Time& now) const;
+    int priority(const TargetSource source) const;
+};
+
+}
+
+#endif
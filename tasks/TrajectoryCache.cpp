@@ -0,0 +1,253 @@
+#include "TrajectoryCache.hpp"
+#include <base/Float.hpp>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <string.h>
+
+namespace trajectory_generation{
+
+namespace{
+
+/** Number of packed input values (without current state) per DOF and in total*/
+#ifdef USING_REFLEXXES_TYPE_IV
+const unsigned int INPUT_PER_DOF = 8;
+const unsigned int INPUT_GLOBAL  = 3;
+#else
+const unsigned int INPUT_PER_DOF = 6;
+const unsigned int INPUT_GLOBAL  = 2;
+#endif
+
+int64_t quantize(const double value, const double resolution){
+    if(base::isNaN(value))
+        return std::numeric_limits<int64_t>::min();
+    const double q = value / resolution;
+    if(q >= 9.2e18)
+        return std::numeric_limits<int64_t>::max();
+    if(q <= -9.2e18)
+        return std::numeric_limits<int64_t>::min() + 1;
+    return llround(q);
+}
+
+/** Bit pattern of value, so that keys compare values exactly (NaN entries, e.g. unset position limits, compare equal)*/
+int64_t bits(const double value){
+    int64_t b;
+    memcpy(&b, &value, sizeof(b));
+    return b;
+}
+
+}
+
+TrajectoryCache::TrajectoryCache(OTGBackend* backend, const unsigned int n_dof, const TrajectoryCacheConfig& config) :
+    backend(backend), n_dof(n_dof), config(config), use_counter(0), playback(0), playback_idx(0), is_recording(false){
+
+    const size_t input_size = INPUT_PER_DOF * n_dof + INPUT_GLOBAL;
+    input.assign(input_size, base::NaN<double>());
+    last_input.assign(input_size, base::NaN<double>());
+    last_state.assign(3 * n_dof, base::NaN<double>());
+    key.resize(input_size);
+
+    entries.resize(config.size + 1);
+    for(size_t i = 0; i < entries.size(); i++){
+        Entry& e = entries[i];
+        e.hash = 0;
+        e.key.resize(key.size());
+        e.start_state.resize(3 * n_dof);
+        e.samples.resize(3 * n_dof * config.max_samples);
+        e.sync_times.resize(config.max_samples);
+        e.results.resize(config.max_samples);
+        e.execution_times.resize(n_dof);
+        e.n_samples = 0;
+        e.last_used = 0;
+    }
+    // The last entry is used as recording buffer
+    recording = entries.back();
+    entries.pop_back();
+}
+
+TrajectoryCache::~TrajectoryCache(){
+    delete backend;
+}
+
+void TrajectoryCache::setPositionLimits(const std::vector<double>& min_position,
+                                        const std::vector<double>& max_position,
+                                        const PositionalLimitsBehavior behavior){
+    backend->setPositionLimits(min_position, max_position, behavior);
+}
+
+bool TrajectoryCache::continuesPreviousCall(const RMLPositionInputParameters& in, const RMLPositionFlags& flags){
+    for(unsigned int i = 0; i < n_dof; i++){
+        double* elem = &input[INPUT_PER_DOF * i];
+        elem[0] = in.SelectionVector->VecData[i];
+        elem[1] = in.TargetPositionVector->VecData[i];
+        elem[2] = in.TargetVelocityVector->VecData[i];
+        elem[3] = in.MaxVelocityVector->VecData[i];
+        elem[4] = in.MaxAccelerationVector->VecData[i];
+        elem[5] = in.MaxJerkVector->VecData[i];
+#ifdef USING_REFLEXXES_TYPE_IV
+        elem[6] = in.MinPositionVector->VecData[i];
+        elem[7] = in.MaxPositionVector->VecData[i];
+#endif
+    }
+    double* global = &input[INPUT_PER_DOF * n_dof];
+    global[0] = in.MinimumSynchronizationTime;
+    global[1] = flags.SynchronizationBehavior;
+#ifdef USING_REFLEXXES_TYPE_IV
+    global[2] = flags.PositionalLimitsBehavior;
+#endif
+
+    // Compare bitwise, so that NaN entries (e.g. unset position limits) compare equal
+    bool same = memcmp(input.data(), last_input.data(), input.size() * sizeof(double)) == 0 &&
+                memcmp(in.CurrentPositionVector->VecData,     &last_state[0],         n_dof * sizeof(double)) == 0 &&
+                memcmp(in.CurrentVelocityVector->VecData,     &last_state[n_dof],     n_dof * sizeof(double)) == 0 &&
+                memcmp(in.CurrentAccelerationVector->VecData, &last_state[2 * n_dof], n_dof * sizeof(double)) == 0;
+    last_input.swap(input);
+    return same;
+}
+
+/** Bitwise comparison of the given start state with the current state of in*/
+static bool sameStartState(const std::vector<double>& start_state, const RMLPositionInputParameters& in, const unsigned int n_dof){
+    return memcmp(in.CurrentPositionVector->VecData,     &start_state[0],         n_dof * sizeof(double)) == 0 &&
+           memcmp(in.CurrentVelocityVector->VecData,     &start_state[n_dof],     n_dof * sizeof(double)) == 0 &&
+           memcmp(in.CurrentAccelerationVector->VecData, &start_state[2 * n_dof], n_dof * sizeof(double)) == 0;
+}
+
+uint64_t TrajectoryCache::computeKey(const RMLPositionInputParameters& in){
+    // Only target position and velocity are quantized. Constraints, limits and flags have to match exactly, since a
+    // cached trajectory might violate constraints that are only slightly lower
+    for(size_t i = 0; i < last_input.size(); i++){
+        const bool target = i < INPUT_PER_DOF * n_dof && (i % INPUT_PER_DOF == 1 || i % INPUT_PER_DOF == 2);
+        key[i] = target ? quantize(last_input[i], config.quantization) : bits(last_input[i]);
+    }
+
+    // 64 bit FNV-1a of the key and the exact start state
+    uint64_t h = 14695981039346656037ULL;
+    for(size_t i = 0; i < key.size(); i++){
+        h ^= (uint64_t)key[i];
+        h *= 1099511628211ULL;
+    }
+    const double* state[3] = {in.CurrentPositionVector->VecData, in.CurrentVelocityVector->VecData, in.CurrentAccelerationVector->VecData};
+    for(unsigned int j = 0; j < 3; j++){
+        for(unsigned int i = 0; i < n_dof; i++){
+            uint64_t bits;
+            memcpy(&bits, &state[j][i], sizeof(bits));
+            h ^= bits;
+            h *= 1099511628211ULL;
+        }
+    }
+    return h;
+}
+
+TrajectoryCache::Entry* TrajectoryCache::find(const uint64_t hash, const RMLPositionInputParameters& in){
+    for(size_t i = 0; i < entries.size(); i++){
+        if(entries[i].last_used > 0 && entries[i].hash == hash && entries[i].key == key && sameStartState(entries[i].start_state, in, n_dof))
+            return &entries[i];
+    }
+    return 0;
+}
+
+void TrajectoryCache::storeRecording(){
+    if(entries.empty())
+        return;
+    Entry* target = &entries[0];
+    for(size_t i = 1; i < entries.size() && target->last_used > 0; i++){
+        if(entries[i].last_used < target->last_used)
+            target = &entries[i];
+    }
+    if(target->last_used > 0)
+        stats.evictions++;
+    else
+        stats.entries++;
+
+    // All entries have buffers of the same size, the replaced entry becomes the new recording buffer
+    std::swap(*target, recording);
+    target->last_used = ++use_counter;
+    recording.last_used = 0;
+}
+
+void TrajectoryCache::storeState(const RMLOutputParameters& out){
+    memcpy(&last_state[0],         out.NewPositionVector->VecData,     n_dof * sizeof(double));
+    memcpy(&last_state[n_dof],     out.NewVelocityVector->VecData,     n_dof * sizeof(double));
+    memcpy(&last_state[2 * n_dof], out.NewAccelerationVector->VecData, n_dof * sizeof(double));
+}
+
+int TrajectoryCache::RMLPosition(const RMLPositionInputParameters& in,
+                                 RMLPositionOutputParameters* out,
+                                 const RMLPositionFlags& flags){
+    if(in.GetNumberOfDOFs() != n_dof || out->GetNumberOfDOFs() != n_dof)
+        return backend->RMLPosition(in, out, flags);
+
+    const bool continued = continuesPreviousCall(in, flags);
+    if(!continued){
+        // New motion: Abort playback and recording and look up the new motion
+        playback = 0;
+        is_recording = false;
+        const uint64_t hash = computeKey(in);
+        playback = find(hash, in);
+        if(playback){
+            stats.hits++;
+            playback->last_used = ++use_counter;
+            playback_idx = 0;
+        }
+        else{
+            stats.misses++;
+            is_recording = config.max_samples > 0;
+            recording.hash = hash;
+            std::copy(key.begin(), key.end(), recording.key.begin());
+            memcpy(&recording.start_state[0],         in.CurrentPositionVector->VecData,     n_dof * sizeof(double));
+            memcpy(&recording.start_state[n_dof],     in.CurrentVelocityVector->VecData,     n_dof * sizeof(double));
+            memcpy(&recording.start_state[2 * n_dof], in.CurrentAccelerationVector->VecData, n_dof * sizeof(double));
+            recording.n_samples = 0;
+        }
+        stats.hit_rate = double(stats.hits) / (stats.hits + stats.misses);
+    }
+
+    if(playback && playback_idx < playback->n_samples){
+        const unsigned int k = playback_idx++;
+        const double* sample = &playback->samples[3 * n_dof * k];
+        memcpy(out->NewPositionVector->VecData,     sample,             n_dof * sizeof(double));
+        memcpy(out->NewVelocityVector->VecData,     sample + n_dof,     n_dof * sizeof(double));
+        memcpy(out->NewAccelerationVector->VecData, sample + 2 * n_dof, n_dof * sizeof(double));
+        memcpy(out->ExecutionTimes->VecData, playback->execution_times.data(), n_dof * sizeof(double));
+        out->SynchronizationTime = playback->sync_times[k];
+        out->ANewCalculationWasPerformed = (k == 0);
+        out->TrajectoryIsPhaseSynchronized = false;
+        out->DOFWithTheGreatestExecutionTime = std::max_element(playback->execution_times.begin(), playback->execution_times.end()) -
+                                               playback->execution_times.begin();
+        storeState(*out);
+        return playback->results[k];
+    }
+    playback = 0;
+
+    const int result = backend->RMLPosition(in, out, flags);
+
+    if(is_recording){
+        if(result < 0 || recording.n_samples >= config.max_samples)
+            is_recording = false;
+        else{
+            const unsigned int k = recording.n_samples++;
+            double* sample = &recording.samples[3 * n_dof * k];
+            memcpy(sample,             out->NewPositionVector->VecData,     n_dof * sizeof(double));
+            memcpy(sample + n_dof,     out->NewVelocityVector->VecData,     n_dof * sizeof(double));
+            memcpy(sample + 2 * n_dof, out->NewAccelerationVector->VecData, n_dof * sizeof(double));
+            recording.sync_times[k] = out->SynchronizationTime;
+            recording.results[k] = result;
+            if(k == 0)
+                memcpy(recording.execution_times.data(), out->ExecutionTimes->VecData, n_dof * sizeof(double));
+            if(result == RML_FINAL_STATE_REACHED){
+                storeRecording();
+                is_recording = false;
+            }
+        }
+    }
+    storeState(*out);
+    return result;
+}
+
+int TrajectoryCache::RMLVelocity(const RMLVelocityInputParameters& in,
+                                 RMLVelocityOutputParameters* out,
+                                 const RMLVelocityFlags& flags){
+    return backend->RMLVelocity(in, out, flags);
+}
+
+}
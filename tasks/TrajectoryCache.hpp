@@ -0,0 +1,95 @@
+#ifndef TRAJECTORY_CACHE_HPP
+#define TRAJECTORY_CACHE_HPP
+
+#include "OTGBackend.hpp"
+#include <vector>
+#include <stdint.h>
+
+namespace trajectory_generation{
+
+/** OTG backend that caches the complete output of position based trajectories and plays them back if the same motion
+ *  (exactly the same start state, constraints, limits and flags, same target up to the configured quantization) is requested again.
+ *  The start state has to match exactly, so that playback continues the current state without a jump. This is the case for
+ *  recurring motions between fixed targets, where each motion starts at the final state of the previous one. A target that differs
+ *  within the quantization is reached by the wrapped backend after the playback.
+ *
+ *  The Reflexxes API does not expose the internal polynomials, so the cache stores the sampled trajectory (new position, velocity
+ *  and acceleration of each cycle) produced by the wrapped backend. A trajectory is recorded from the cycle in which it has been
+ *  calculated until the final state is reached and stored only if it was not interrupted (i.e. the input did not change except for
+ *  the current state being fed back from the previous output). The same applies to playback: If the input changes, playback is
+ *  aborted and the wrapped backend takes over from the current state. All memory is allocated in the constructor, entries are
+ *  replaced in least recently used order. Velocity based OTG is forwarded to the wrapped backend without caching.
+ *  Continuous state feedback prevents cache hits, since the fed back state differs from the previous output in every cycle.*/
+class TrajectoryCache : public OTGBackend{
+public:
+    /** Takes ownership of backend*/
+    TrajectoryCache(OTGBackend* backend, const unsigned int n_dof, const TrajectoryCacheConfig& config);
+    virtual ~TrajectoryCache();
+
+    virtual void setPositionLimits(const std::vector<double>& min_position,
+                                   const std::vector<double>& max_position,
+                                   const PositionalLimitsBehavior behavior);
+
+    virtual int RMLPosition(const RMLPositionInputParameters& in,
+                            RMLPositionOutputParameters* out,
+                            const RMLPositionFlags& flags);
+
+    virtual int RMLVelocity(const RMLVelocityInputParameters& in,
+                            RMLVelocityOutputParameters* out,
+                            const RMLVelocityFlags& flags);
+
+    /** The wrapped backend*/
+    OTGBackend* getBackend() const {return backend;}
+
+    /** Hit/miss statistics. The time stamp is not set*/
+    const TrajectoryCacheStats& getStats() const {return stats;}
+
+protected:
+    struct Entry{
+        uint64_t hash;
+        std::vector<int64_t> key;       /** Quantized target and bit patterns of the remaining input*/
+        std::vector<double> start_state;/** Exact start state: n_dof positions, velocities and accelerations*/
+        std::vector<double> samples;    /** Per cycle: n_dof positions, velocities and accelerations*/
+        std::vector<double> sync_times; /** Per cycle: synchronization time*/
+        std::vector<int> results;       /** Per cycle: result value*/
+        std::vector<double> execution_times;
+        unsigned int n_samples;
+        uint64_t last_used;             /** 0 if the entry is empty*/
+    };
+
+    OTGBackend* backend;
+    unsigned int n_dof;
+    TrajectoryCacheConfig config;
+    std::vector<Entry> entries;
+    TrajectoryCacheStats stats;
+    uint64_t use_counter;
+
+    std::vector<double> input;      /** Packed input (without current state) of the current call*/
+    std::vector<double> last_input; /** Packed input (without current state) of the previous call*/
+    std::vector<double> last_state; /** Output state of the previous call*/
+    std::vector<int64_t> key;       /** Key of the current call*/
+
+    Entry* playback;                /** Entry that is currently played back, 0 if none*/
+    unsigned int playback_idx;      /** Next sample of playback*/
+    Entry recording;                /** Trajectory that is currently recorded. Swapped with the replaced entry when stored*/
+    bool is_recording;
+
+    /** Pack the input parameters (except the current state) and check if they are the same as in the previous call and
+     *  if the current state is the output state of the previous call*/
+    bool continuesPreviousCall(const RMLPositionInputParameters& in, const RMLPositionFlags& flags);
+
+    /** Compute the key (quantized target, all other values exact) of the packed input and the hash of key and exact start state of in. The packed input has to
+     *  be up to date*/
+    uint64_t computeKey(const RMLPositionInputParameters& in);
+
+    /** Entry with the given hash, key and start state, 0 if there is none*/
+    Entry* find(const uint64_t hash, const RMLPositionInputParameters& in);
+
+    /** Store the recording in place of the least recently used entry. Swaps the buffers, so that no data is copied*/
+    void storeRecording();
+    void storeState(const RMLOutputParameters& out);
+};
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+#include "TrajectoryChecker.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace trajectory_generation{
+
+TrajectoryChecker::TrajectoryChecker() : tolerance(0), check_jerk(true), has_prev(false), n_computation_times(0){
+}
+
+void TrajectoryChecker::configure(const joint_control_base::MotionConstraints& c, const double tol, const bool jerk){
+    constraints = c;
+    tolerance = tol;
+    check_jerk = jerk;
+    prev.resize(constraints.size());
+    position.resize(constraints.size());
+    reset();
+}
+
+void TrajectoryChecker::reset(){
+    result = PlantSimulationResult();
+    has_prev = false;
+    n_computation_times = 0;
+}
+
+static void updateMax(const double value, double& max){
+    if(!base::isNaN(value))
+        max = std::max(max, value);
+}
+
+void TrajectoryChecker::update(const base::commands::Joints& command, const base::samples::Joints& plant_state, const double dt){
+    const double limit = 1 + tolerance;
+    bool violation = false;
+    bool position_limit_violation = false;
+
+    for(size_t i = 0; i < constraints.size(); i++){
+        const joint_control_base::MotionConstraint& c = constraints[i];
+        const base::JointState& cmd = command[i];
+
+        const double speed_ratio = std::fabs(cmd.speed) / c.max.speed;
+        const double acc_ratio   = std::fabs(cmd.acceleration) / c.max.acceleration;
+        updateMax(speed_ratio, result.max_speed_ratio);
+        updateMax(acc_ratio, result.max_acceleration_ratio);
+        violation |= speed_ratio > limit || acc_ratio > limit;
+
+        // Integrate in the same way as PlantModel
+        if(!base::isNaN(cmd.position))
+            position[i] = cmd.position;
+        else if(!has_prev)
+            position[i] = plant_state[i].position;
+        else
+            position[i] += cmd.speed * dt;
+
+        if(position[i] > c.max.position + tolerance * std::fabs(c.max.position) ||
+           position[i] < c.min.position - tolerance * std::fabs(c.min.position))
+            position_limit_violation = true;
+
+        if(has_prev && dt > 0){
+            const base::JointState& p = prev[i];
+            const double speed_step_ratio = std::fabs(cmd.speed - p.speed) / (c.max.acceleration * dt);
+            const double position_step_error = std::fabs(cmd.position - p.position - 0.5 * (cmd.speed + p.speed) * dt);
+            const double jerk_ratio = std::fabs(cmd.acceleration - p.acceleration) / (c.max_jerk * dt);
+            updateMax(speed_step_ratio, result.max_speed_step_ratio);
+            updateMax(position_step_error, result.max_position_step_error);
+            updateMax(jerk_ratio, result.max_jerk_ratio);
+            // The trapezoidal integration of the speed is exact for constant acceleration. A jump of the acceleration within the
+            // cycle (at most 2 * max. acceleration, e.g. with Reflexxes Type II) causes an error of at most max. acceleration * dt^2 / 4
+            violation |= speed_step_ratio > limit || position_step_error > limit * c.max.acceleration * dt * dt / 4;
+            violation |= check_jerk && jerk_ratio > limit;
+        }
+
+        updateMax(std::fabs(position[i] - plant_state[i].position), result.max_tracking_error);
+        prev[i] = cmd;
+    }
+
+    has_prev = true;
+    result.cycles++;
+    if(position_limit_violation)
+        result.position_limit_violations++;
+    if(violation || position_limit_violation)
+        result.violations++;
+}
+
+void TrajectoryChecker::addComputationTime(const double t){
+    n_computation_times++;
+    result.mean_computation_time += (t - result.mean_computation_time) / n_computation_times;
+    result.max_computation_time = std::max(result.max_computation_time, t);
+}
+
+}
@@ -0,0 +1,48 @@
+#ifndef TRAJECTORY_CHECKER_HPP
+#define TRAJECTORY_CHECKER_HPP
+
+#include "trajectory_generationTypes.hpp"
+#include <joint_control_base/MotionConstraint.hpp>
+#include <base/commands/Joints.hpp>
+#include <base/samples/Joints.hpp>
+
+namespace trajectory_generation{
+
+/** Checks a sequence of joint commands for continuity and compliance with the motion constraints and compares it with the state of
+ *  the plant that executes the commands. The commands have to contain the elements in the order of the motion constraints.
+ *  Commands without position (pure velocity commands) are integrated from the commanded speed, starting at the plant position of the
+ *  first command, so that the position limits and the tracking error are checked as well. Their continuity is checked by the speed
+ *  and acceleration steps.*/
+class TrajectoryChecker{
+public:
+    TrajectoryChecker();
+
+    /** Set the motion constraints and the relative tolerance of all checks. If check_jerk is false, the acceleration steps are only
+     *  reported, but not counted as violations (e.g. for Reflexxes Type II, which does not limit the jerk). Resets the result*/
+    void configure(const joint_control_base::MotionConstraints& constraints, const double tolerance, const bool check_jerk = true);
+
+    /** Clear the result and the previous command*/
+    void reset();
+
+    /** Check the given command, which has been sent dt seconds after the previous command, and the resulting plant state*/
+    void update(const base::commands::Joints& command, const base::samples::Joints& plant_state, const double dt);
+
+    /** Add a computation time sample of the trajectory generator*/
+    void addComputationTime(const double t);
+
+    const PlantSimulationResult& getResult() const {return result;}
+
+protected:
+    joint_control_base::MotionConstraints constraints;
+    double tolerance;
+    bool check_jerk;
+    base::commands::Joints prev;
+    std::vector<double> position; /** Commanded positions, integrated from the commanded speed if the command contains no positions*/
+    bool has_prev;
+    uint64_t n_computation_times;
+    PlantSimulationResult result;
+};
+
+}
+
+#endif
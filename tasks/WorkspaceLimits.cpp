@@ -0,0 +1,177 @@
+#include "WorkspaceLimits.hpp"
+#include <base/Float.hpp>
+#include <cmath>
+
+namespace trajectory_generation{
+
+WorkspaceLimits::WorkspaceLimits() : n_halfspaces(0), n_spheres(0), tolerance(1e-6), max_iterations(100){
+}
+
+bool WorkspaceLimits::configure(const WorkspaceConstraints& constraints){
+    n_halfspaces = n_spheres = 0;
+
+    // Negated comparison, so that NaN is rejected as well. A tolerance of zero would reject projected positions due to rounding errors
+    if(!(constraints.tolerance > 0) || constraints.max_iterations == 0)
+        return false;
+
+    const int nh = constraints.halfspaces.size();
+    const int ns = constraints.spheres.size();
+    normals.resize(3, nh);
+    offsets.resize(nh);
+    distances.resize(nh);
+    for(int i = 0; i < nh; i++){
+        const WorkspaceHalfspace& h = constraints.halfspaces[i];
+        const double norm = h.normal.norm();
+        if(!(norm > 0) || base::isNaN(h.offset) || std::isinf(norm))
+            return false;
+        normals.col(i) = h.normal / norm;
+        offsets(i) = h.offset / norm;
+    }
+    centers.resize(3, ns);
+    radii.resize(ns);
+    keep_out.resize(ns);
+    for(int i = 0; i < ns; i++){
+        const WorkspaceSphere& s = constraints.spheres[i];
+        if(!(s.radius > 0) || std::isinf(s.radius) || base::isNaN(s.center.norm()))
+            return false;
+        centers.col(i) = s.center;
+        radii(i) = s.radius;
+        keep_out(i) = s.keep_out;
+    }
+    increments.setZero(3, nh + ns);
+
+    tolerance = constraints.tolerance;
+    max_iterations = constraints.max_iterations;
+    n_halfspaces = nh;
+    n_spheres = ns;
+    return true;
+}
+
+bool WorkspaceLimits::containsConvex(const base::Vector3d& p) const{
+    if(n_halfspaces > 0){
+        distances.noalias() = normals.transpose() * p;
+        distances -= offsets;
+        if(distances.maxCoeff() > tolerance)
+            return false;
+    }
+    for(int i = 0; i < n_spheres; i++){
+        if(!keep_out(i) && (p - centers.col(i)).norm() - radii(i) > tolerance)
+            return false;
+    }
+    return true;
+}
+
+bool WorkspaceLimits::containsKeepOut(const base::Vector3d& p) const{
+    for(int i = 0; i < n_spheres; i++){
+        if(keep_out(i) && radii(i) - (p - centers.col(i)).norm() > tolerance)
+            return false;
+    }
+    return true;
+}
+
+bool WorkspaceLimits::contains(const base::Vector3d& p) const{
+    return containsConvex(p) && containsKeepOut(p);
+}
+
+void WorkspaceLimits::projectOntoConstraint(const int idx, base::Vector3d& p) const{
+    if(idx < n_halfspaces){
+        const double d = normals.col(idx).dot(p) - offsets(idx);
+        if(d > 0)
+            p -= d * normals.col(idx);
+    }
+    else{
+        const int i = idx - n_halfspaces;
+        const base::Vector3d diff = p - centers.col(i);
+        const double dist = diff.norm();
+        if(dist > radii(i))
+            p = centers.col(i) + diff * (radii(i) / dist);
+    }
+}
+
+void WorkspaceLimits::projectConvex(base::Vector3d& p, unsigned int& n_passes){
+    if(containsConvex(p))
+        return;
+
+    // Closed form solution if a single convex constraint is violated
+    int n_violated = 0, violated = -1;
+    for(int i = 0; i < n_halfspaces; i++){
+        if(distances(i) > tolerance){
+            n_violated++;
+            violated = i;
+        }
+    }
+    for(int i = 0; i < n_spheres; i++){
+        if(!keep_out(i) && (p - centers.col(i)).norm() - radii(i) > tolerance){
+            n_violated++;
+            violated = n_halfspaces + i;
+        }
+    }
+    if(n_violated == 1){
+        base::Vector3d q = p;
+        projectOntoConstraint(violated, q);
+        // The projection onto one constraint may violate another one, in which case Dykstra is required
+        if(containsConvex(q)){
+            p = q;
+            return;
+        }
+    }
+
+    // Dykstra's alternating projection onto the intersection of all convex constraints. The iterates may become feasible long
+    // before they reach the closest feasible point, so iterate until they do not move anymore
+    increments.setZero();
+    while(n_passes > 0){
+        n_passes--;
+        const base::Vector3d previous = p;
+        for(int i = 0; i < n_halfspaces + n_spheres; i++){
+            if(i >= n_halfspaces && keep_out(i - n_halfspaces))
+                continue;
+            const base::Vector3d y = p + increments.col(i);
+            p = y;
+            projectOntoConstraint(i, p);
+            increments.col(i) = y - p;
+        }
+        if((p - previous).norm() <= tolerance && containsConvex(p))
+            return;
+    }
+}
+
+bool WorkspaceLimits::pushOutOfSpheres(base::Vector3d& p) const{
+    for(int i = 0; i < n_spheres; i++){
+        if(!keep_out(i))
+            continue;
+        const base::Vector3d diff = p - centers.col(i);
+        const double dist = diff.norm();
+        if(dist >= radii(i))
+            continue;
+        // At the center, all directions are equally close, there is no meaningful projection
+        if(!(dist > 0))
+            return false;
+        p = centers.col(i) + diff * (radii(i) / dist);
+    }
+    return true;
+}
+
+bool WorkspaceLimits::project(base::Vector3d& p){
+    // NaN has to be checked first, all comparisons in contains() are false for NaN
+    if(base::isNaN(p.norm()))
+        return false;
+    if(contains(p))
+        return true;
+
+    // Keep-out spheres are not convex: Alternate between the convex set and pushing the position out of the keep-out spheres.
+    // Work on a copy, p must not be modified if the projection fails. All Dykstra projections share max_iterations passes
+    base::Vector3d q = p;
+    unsigned int n_passes = max_iterations;
+    for(unsigned int it = 0; it < max_iterations; it++){
+        projectConvex(q, n_passes);
+        if(!pushOutOfSpheres(q))
+            return false;
+        if(contains(q)){
+            p = q;
+            return true;
+        }
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,65 @@
+#ifndef WORKSPACE_LIMITS_HPP
+#define WORKSPACE_LIMITS_HPP
+
+#include "trajectory_generationTypes.hpp"
+#include <base/Eigen.hpp>
+
+namespace trajectory_generation{
+
+/** Checks Cartesian target positions against the workspace constraints and projects infeasible positions onto the feasible set.
+ *
+ *  The constraint data is normalized and packed into matrices at configuration time, so that checking a position is a single
+ *  matrix-vector product. A violated single constraint is resolved by closed-form projection (half space: along the normal,
+ *  sphere: along the radius). If several convex constraints are violated, Dykstra's alternating projection algorithm is used,
+ *  which converges to the closest feasible point of the intersection. Keep-out spheres are not convex and are resolved by pushing
+ *  the position radially out of the sphere. Positions at the center of a keep-out sphere are rejected.
+ *
+ *  Computation time: Checking a position costs one pass over all constraints. A projection takes at most max_iterations Dykstra passes
+ *  over all constraints in total, also if Dykstra is restarted after pushing the position out of a keep-out sphere, plus at most
+ *  max_iterations pushes. The worst case is reached if the constraints do not intersect. test/benchmark_workspace_limits measures
+ *  typical and worst case.*/
+class WorkspaceLimits{
+public:
+    WorkspaceLimits();
+
+    /** Precompute the constraint data. Allocates memory, so call this only at configuration time. Returns false if the constraints
+     *  are invalid (zero normal, non-positive radius or tolerance, max_iterations = 0)*/
+    bool configure(const WorkspaceConstraints& constraints);
+
+    /** True if no constraints have been configured*/
+    bool empty() const {return n_halfspaces == 0 && n_spheres == 0;}
+
+    /** True if the given position fulfills all constraints*/
+    bool contains(const base::Vector3d& p) const;
+
+    /** Project the given position onto the feasible set. Returns false if no feasible position could be found within the configured
+     *  number of iterations, e.g. because the constraints do not intersect, or if the position is exactly at the center of a keep-out
+     *  sphere, where the direction of the projection is undefined. p is not modified in this case.*/
+    bool project(base::Vector3d& p);
+
+protected:
+    int n_halfspaces;
+    int n_spheres;
+    Eigen::Matrix3Xd normals;          /** Unit normals of the half spaces*/
+    Eigen::VectorXd offsets;           /** Offsets of the half spaces, scaled with the normal*/
+    Eigen::Matrix3Xd centers;          /** Sphere centers*/
+    Eigen::VectorXd radii;
+    Eigen::Matrix<bool,Eigen::Dynamic,1> keep_out;
+    double tolerance;
+    unsigned int max_iterations;
+
+    Eigen::Matrix3Xd increments;       /** Dykstra increments, one per convex constraint*/
+    mutable Eigen::VectorXd distances; /** Scratch buffer for the half space distances*/
+
+    bool containsConvex(const base::Vector3d& p) const;
+    bool containsKeepOut(const base::Vector3d& p) const;
+    /** Project p onto the convex constraints with at most n_passes Dykstra passes. n_passes is decreased by the passes used*/
+    void projectConvex(base::Vector3d& p, unsigned int& n_passes);
+    void projectOntoConstraint(const int idx, base::Vector3d& p) const;
+    /** Push p radially out of all keep-out spheres. Returns false if p is at the center of one of them*/
+    bool pushOutOfSpheres(base::Vector3d& p) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef BENCHMARK_TIMER_HPP
+#define BENCHMARK_TIMER_HPP
+
+#include <time.h>
+#include <algorithm>
+
+namespace trajectory_generation{
+
+/** Measures the time since construction on the monotonic clock, see CycleTracer*/
+class BenchmarkTimer{
+    timespec start;
+public:
+    BenchmarkTimer(){clock_gettime(CLOCK_MONOTONIC, &start);}
+
+    /** Elapsed time in seconds*/
+    double elapsed() const {
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) * 1e-9;
+    }
+};
+
+/** Mean and max. of a series of durations*/
+struct BenchmarkStats{
+    double sum, max;
+    unsigned long n;
+    BenchmarkStats() : sum(0), max(0), n(0){}
+    void add(const double t){sum += t; max = std::max(max, t); n++;}
+    double mean() const {return n > 0 ? sum / n : 0;}
+};
+
+}
+
+#endif
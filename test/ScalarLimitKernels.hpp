@@ -0,0 +1,48 @@
+#ifndef SCALAR_LIMIT_KERNELS_HPP
+#define SCALAR_LIMIT_KERNELS_HPP
+
+#include <vector>
+#include <stddef.h>
+
+namespace trajectory_generation{
+
+/** Scalar per-DOF references of the limit kernels (LimitKernels.hpp), as in the loops they replaced. Used by
+ *  test/test_limit_kernels.cpp to check the kernels and by test/benchmark_limit_kernels.cpp to compare the timing*/
+
+/** Scalar reference of clampToLimits(), as in the former cropTargetAtPositionLimits()*/
+inline void scalarClamp(const double* min, const double* max, double* values, const size_t n, std::vector<bool>& clamped){
+    for(size_t i = 0; i < n; i++){
+        clamped[i] = false;
+        if(values[i] > max[i]){
+            values[i] = max[i];
+            clamped[i] = true;
+        }
+        else if(values[i] < min[i]){
+            values[i] = min[i];
+            clamped[i] = true;
+        }
+    }
+}
+
+/** Scalar reference of checkLimits(), as in the former position limit check of the current state*/
+inline void scalarCheck(const double* min, const double* max, const double* values, const size_t n, std::vector<bool>& violations){
+    for(size_t i = 0; i < n; i++)
+        violations[i] = values[i] > max[i] || values[i] < min[i];
+}
+
+/** Scalar reference of zeroVelocityAtLimits(), as in the former fixRmlSynchronizationBug()*/
+inline void scalarZeroVelocity(const double cycle_time, const double* min, const double* max, const double* position,
+                               double* velocity, const size_t n, std::vector<bool>& modified){
+    for(size_t i = 0; i < n; i++){
+        modified[i] = false;
+        const double next = position[i] + velocity[i] * cycle_time;
+        if(next > max[i] || next < min[i]){
+            velocity[i] = 0;
+            modified[i] = true;
+        }
+    }
+}
+
+}
+
+#endif
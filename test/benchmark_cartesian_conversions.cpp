@@ -0,0 +1,211 @@
+/** Compares the Cartesian conversions (Conversions.hpp, FixedSizeConversions.hpp) with the per-DOF loops and memcpy calls they replaced:
+ *  - Per cycle: Command and current sample of the Cartesian position task, which are converted in every cycle
+ *  - Per sample: Current state, position and velocity target, which are only converted when a new sample arrives
+ *  Both variants produce the same RML parameters and samples, which is checked before timing.
+ *
+ *  Usage: benchmark_cartesian_conversions [number of calls]*/
+
+#include "BenchmarkTimer.hpp"
+#include <Conversions.hpp>
+#include <FixedSizeConversions.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace trajectory_generation;
+
+namespace{
+
+/** Per-DOF reference of cartesianState2RmlTypes(), as before the fixed-size conversions*/
+bool loopState2RmlTypes(const base::samples::RigidBodyStateSE3& cartesian_state, RMLInputParameters& params){
+    if(!cartesian_state.hasValidPose())
+        return false;
+    base::Vector3d euler = quaternion2Euler(cartesian_state.pose.orientation);
+    memcpy(params.CurrentPositionVector->VecData,   cartesian_state.pose.position.data(), sizeof(double)*3);
+    memcpy(params.CurrentPositionVector->VecData+3, euler.data(),                          sizeof(double)*3);
+    memset(params.CurrentVelocityVector->VecData,     0,                                   sizeof(double)*6);
+    memset(params.CurrentAccelerationVector->VecData, 0,                                   sizeof(double)*6);
+    return true;
+}
+
+/** Per-DOF reference of target2RmlTypes(const RigidBodyStateSE3&, RMLPositionInputParameters&, ...)*/
+bool loopTarget2RmlTypes(const base::samples::RigidBodyStateSE3& target, RMLPositionInputParameters& params){
+    base::Vector3d euler = quaternion2Euler(target.pose.orientation);
+    for(int i = 0; i < 3; i++){
+        if(base::isNaN(target.pose.position(i)) || base::isNaN(euler(i)))
+            return false;
+    }
+    for(int i = 0; i < 3; i++)
+        target2RmlTypes(target.pose.position(i), target.twist.linear(i), i, params);
+    for(int i = 0; i < 3; i++)
+        target2RmlTypes(euler(i), target.twist.angular(i), i+3, params);
+    return true;
+}
+
+/** Per-DOF reference of target2RmlTypes(const RigidBodyStateSE3&, RMLVelocityInputParameters&, ...)*/
+bool loopTarget2RmlTypes(const base::samples::RigidBodyStateSE3& target, RMLVelocityInputParameters& params){
+    for(int i = 0; i < 3; i++){
+        if(base::isNaN(target.twist.linear(i)) || base::isNaN(target.twist.angular(i)))
+            return false;
+    }
+    for(int i = 0; i < 3; i++)
+        target2RmlTypes(target.twist.linear(i), i, params);
+    for(int i = 0; i < 3; i++)
+        target2RmlTypes(target.twist.angular(i), i+3, params);
+    return true;
+}
+
+/** Per-DOF reference of rmlTypes2Command(const RMLPositionOutputParameters&, RigidBodyStateSE3&)*/
+void loopCommand(const RMLPositionOutputParameters& params, base::samples::RigidBodyStateSE3& command){
+    base::Vector3d euler;
+    memcpy(command.pose.position.data(), params.NewPositionVector->VecData,   sizeof(double)*3);
+    memcpy(euler.data(),                 params.NewPositionVector->VecData+3, sizeof(double)*3);
+    memcpy(command.twist.linear.data(),  params.NewVelocityVector->VecData,   sizeof(double)*3);
+    memcpy(command.twist.angular.data(), params.NewVelocityVector->VecData+3, sizeof(double)*3);
+    command.pose.orientation = euler2Quaternion(euler);
+}
+
+/** Per-DOF reference of rmlTypes2CartesianState(), which converted the current sample in each cycle*/
+void loopCurrentSample(const RMLInputParameters& params, base::samples::RigidBodyStateSE3& cartesian_state){
+    base::Vector3d euler;
+    memcpy(cartesian_state.pose.position.data(), params.CurrentPositionVector->VecData,   sizeof(double)*3);
+    memcpy(euler.data(),                         params.CurrentPositionVector->VecData+3, sizeof(double)*3);
+    memcpy(cartesian_state.twist.linear.data(),  params.CurrentVelocityVector->VecData,   sizeof(double)*3);
+    memcpy(cartesian_state.twist.angular.data(), params.CurrentVelocityVector->VecData+3, sizeof(double)*3);
+    cartesian_state.pose.orientation = euler2Quaternion(euler);
+}
+
+/** Per-DOF reference of rmlTypes2Command(const RMLVelocityOutputParameters&, RigidBodyStateSE3&)*/
+void loopCommand(const RMLVelocityOutputParameters& params, base::samples::RigidBodyStateSE3& command){
+    memcpy(command.twist.linear.data(),         params.NewVelocityVector->VecData,       sizeof(double)*3);
+    memcpy(command.twist.angular.data(),        params.NewVelocityVector->VecData+3,     sizeof(double)*3);
+    memcpy(command.acceleration.linear.data(),  params.NewAccelerationVector->VecData,   sizeof(double)*3);
+    memcpy(command.acceleration.angular.data(), params.NewAccelerationVector->VecData+3, sizeof(double)*3);
+}
+
+bool equal(const RMLDoubleVector& a, const RMLDoubleVector& b){
+    return memcmp(a.VecData, b.VecData, sizeof(double) * CARTESIAN_DOF) == 0;
+}
+
+bool equal(const base::samples::RigidBodyStateSE3& a, const base::samples::RigidBodyStateSE3& b){
+    return a.pose.position == b.pose.position && a.pose.orientation.coeffs() == b.pose.orientation.coeffs() &&
+           a.twist.linear == b.twist.linear && a.twist.angular == b.twist.angular &&
+           a.acceleration.linear == b.acceleration.linear && a.acceleration.angular == b.acceleration.angular;
+}
+
+struct Data{
+    base::samples::RigidBodyStateSE3 state, target;
+    RMLPositionInputParameters pos_in;
+    RMLVelocityInputParameters vel_in;
+    RMLPositionOutputParameters pos_out;
+    RMLVelocityOutputParameters vel_out;
+    base::samples::RigidBodyStateSE3 pos_command, vel_command, current_sample;
+    InputValidationError error;
+
+    Data() : pos_in(CARTESIAN_DOF), vel_in(CARTESIAN_DOF), pos_out(CARTESIAN_DOF), vel_out(CARTESIAN_DOF){
+        state.twist.linear.setZero();
+        state.twist.angular.setZero();
+        state.acceleration.linear.setZero();
+        state.acceleration.angular.setZero();
+        state.pose.position << 0.3, -0.2, 0.5;
+        state.pose.orientation = Eigen::AngleAxisd(0.3, Eigen::Vector3d(1, 2, 3).normalized());
+        target = state;
+        target.pose.position << 0.5, 0.1, 0.4;
+        target.twist.linear << 0.1, 0.0, -0.1;
+        target.twist.angular << 0.0, 0.2, 0.0;
+        for(unsigned int i = 0; i < CARTESIAN_DOF; i++){
+            pos_out.NewPositionVector->VecData[i] = vel_out.NewPositionVector->VecData[i] = 0.1 * i;
+            pos_out.NewVelocityVector->VecData[i] = vel_out.NewVelocityVector->VecData[i] = -0.05 * i;
+            pos_out.NewAccelerationVector->VecData[i] = vel_out.NewAccelerationVector->VecData[i] = 0.2 * i;
+        }
+        pos_command = vel_command = current_sample = state;
+    }
+
+    /** As RMLCartesianPositionTask::writeCommand(). The new state has been fed back to the input by stepOTG()*/
+    void cycle(){
+        *pos_in.CurrentPositionVector = *pos_out.NewPositionVector;
+        *pos_in.CurrentVelocityVector = *pos_out.NewVelocityVector;
+        rmlTypes2PositionCommand(pos_out, pos_command, current_sample);
+    }
+
+    void cycleLoops(){
+        *pos_in.CurrentPositionVector = *pos_out.NewPositionVector;
+        *pos_in.CurrentVelocityVector = *pos_out.NewVelocityVector;
+        loopCommand(pos_out, pos_command);
+        loopCurrentSample(pos_in, current_sample);
+    }
+
+    void samples(){
+        cartesianState2RmlTypes(state, pos_in, error);
+        target2RmlTypes(target, pos_in, error);
+        target2RmlTypes(target, vel_in, error);
+        rmlTypes2Command(vel_out, vel_command);
+    }
+
+    void samplesLoops(){
+        loopState2RmlTypes(state, pos_in);
+        loopTarget2RmlTypes(target, pos_in);
+        loopTarget2RmlTypes(target, vel_in);
+        loopCommand(vel_out, vel_command);
+    }
+};
+
+bool sameResults(){
+    Data fixed_size, loops;
+    fixed_size.samples();
+    fixed_size.cycle();
+    loops.samplesLoops();
+    loops.cycleLoops();
+    return equal(*fixed_size.pos_in.CurrentPositionVector, *loops.pos_in.CurrentPositionVector) &&
+           equal(*fixed_size.pos_in.CurrentVelocityVector, *loops.pos_in.CurrentVelocityVector) &&
+           equal(*fixed_size.pos_in.TargetPositionVector, *loops.pos_in.TargetPositionVector) &&
+           equal(*fixed_size.pos_in.TargetVelocityVector, *loops.pos_in.TargetVelocityVector) &&
+           equal(*fixed_size.vel_in.TargetVelocityVector, *loops.vel_in.TargetVelocityVector) &&
+           equal(fixed_size.pos_command, loops.pos_command) && equal(fixed_size.vel_command, loops.vel_command) &&
+           equal(fixed_size.current_sample, loops.current_sample);
+}
+
+}
+
+int main(int argc, char** argv){
+    const unsigned int n_calls = argc > 1 ? atoi(argv[1]) : 1000000;
+    if(!sameResults()){
+        printf("The fixed-size conversions and the per-DOF loops produce different results\n");
+        return 1;
+    }
+
+    // The conversions take some 10 ns, so the whole series is timed instead of single calls
+    Data data;
+    BenchmarkTimer cycle_timer;
+    for(unsigned int c = 0; c < n_calls; c++){
+        data.pos_out.NewPositionVector->VecData[3] += 1e-9;
+        data.cycle();
+    }
+    const double cycle = cycle_timer.elapsed() / n_calls;
+    BenchmarkTimer cycle_loop_timer;
+    for(unsigned int c = 0; c < n_calls; c++){
+        data.pos_out.NewPositionVector->VecData[3] += 1e-9;
+        data.cycleLoops();
+    }
+    const double cycle_loops = cycle_loop_timer.elapsed() / n_calls;
+
+    BenchmarkTimer samples_timer;
+    for(unsigned int c = 0; c < n_calls; c++){
+        data.target.pose.position.x() += 1e-9;
+        data.samples();
+    }
+    const double samples = samples_timer.elapsed() / n_calls;
+    BenchmarkTimer samples_loop_timer;
+    for(unsigned int c = 0; c < n_calls; c++){
+        data.target.pose.position.x() += 1e-9;
+        data.samplesLoops();
+    }
+    const double samples_loops = samples_loop_timer.elapsed() / n_calls;
+
+    printf("Mean time of the Cartesian conversions in ns, %u calls\n", n_calls);
+    printf("%12s %14s %14s %10s\n", "", "current", "per-DOF loops", "reduction");
+    printf("%12s %14.1f %14.1f %9.1f%%\n", "per cycle", cycle * 1e9, cycle_loops * 1e9, 100.0 * (1.0 - cycle / cycle_loops));
+    printf("%12s %14.1f %14.1f %9.1f%%   (%f)\n", "per sample", samples * 1e9, samples_loops * 1e9, 100.0 * (1.0 - samples / samples_loops),
+           data.current_sample.pose.position.x() + data.pos_in.TargetPositionVector->VecData[0]);
+    return 0;
+}
@@ -0,0 +1,86 @@
+/** Compares the limit kernels (LimitKernels.hpp) with the scalar per-DOF loops they replaced, for several numbers of DOF.
+ *  Half of the values are outside of their limits. test/test_limit_kernels.cpp checks that both produce the same results.
+ *
+ *  Usage: benchmark_limit_kernels [number of calls]*/
+
+#include "BenchmarkTimer.hpp"
+#include "ScalarLimitKernels.hpp"
+#include <LimitKernels.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace trajectory_generation;
+
+namespace{
+
+struct Data{
+    std::vector<double> min, max, position, velocity, values;
+    Data(const size_t n) : min(n, -1.0), max(n, 1.0), position(n), velocity(n), values(n){
+        for(size_t i = 0; i < n; i++){
+            position[i] = -0.99 + 1.98 * rand() / RAND_MAX;
+            velocity[i] = (i % 2 ? 10.0 : 0.1) * (rand() % 2 ? 1 : -1);
+        }
+    }
+    /** Every second value outside of the limits*/
+    void reset(){
+        for(size_t i = 0; i < values.size(); i++)
+            values[i] = i % 2 ? 2.0 : 0.5;
+    }
+};
+
+void run(const size_t n_dof, const unsigned int n_calls){
+    Data data(n_dof);
+    ViolationMask mask(n_dof);
+    std::vector<bool> flags(n_dof);
+    BenchmarkStats kernel_clamp, scalar_clamp, kernel_zero, scalar_zero;
+    size_t checksum = 0;
+
+    for(unsigned int c = 0; c < n_calls; c++){
+        data.reset();
+        {
+            BenchmarkTimer timer;
+            clampToLimits(data.min.data(), data.max.data(), data.values.data(), n_dof, mask);
+            kernel_clamp.add(timer.elapsed());
+        }
+        checksum += mask.count();
+        data.reset();
+        {
+            BenchmarkTimer timer;
+            scalarClamp(data.min.data(), data.max.data(), data.values.data(), n_dof, flags);
+            scalar_clamp.add(timer.elapsed());
+        }
+        checksum += flags[0];
+
+        std::vector<double> velocity = data.velocity;
+        {
+            BenchmarkTimer timer;
+            zeroVelocityAtLimits(0.001, data.min.data(), data.max.data(), data.position.data(), velocity.data(), n_dof, mask);
+            kernel_zero.add(timer.elapsed());
+        }
+        checksum += mask.count();
+        velocity = data.velocity;
+        {
+            BenchmarkTimer timer;
+            scalarZeroVelocity(0.001, data.min.data(), data.max.data(), data.position.data(), velocity.data(), n_dof, flags);
+            scalar_zero.add(timer.elapsed());
+        }
+        checksum += flags[0];
+    }
+
+    // The timer resolution is in the range of the measured times, so only the mean is meaningful
+    printf("%6zu %14.4f %14.4f %14.4f %14.4f   (%zu)\n", n_dof, kernel_clamp.mean() * 1e6, scalar_clamp.mean() * 1e6,
+           kernel_zero.mean() * 1e6, scalar_zero.mean() * 1e6, checksum);
+}
+
+}
+
+int main(int argc, char** argv){
+    const unsigned int n_calls = argc > 1 ? atoi(argv[1]) : 100000;
+    printf("Mean time per call in us, %u calls\n", n_calls);
+    printf("%6s %14s %14s %14s %14s\n", "DOF", "clamp", "clamp (scalar)", "zero vel.", "zero (scalar)");
+    const size_t n_dofs[] = {7, 40, 100, 500};
+    for(size_t i = 0; i < sizeof(n_dofs) / sizeof(n_dofs[0]); i++)
+        run(n_dofs[i], n_calls);
+    return 0;
+}
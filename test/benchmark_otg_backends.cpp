@@ -0,0 +1,110 @@
+/** Compares the OTG backends on randomized point-to-point motions (position based) and velocity changes (velocity based) of a
+ *  7 DOF arm: Mean and max. computation time per cycle and the duration of the generated motions. Both backends generate time-optimal
+ *  trajectories, so the durations should match.
+ *
+ *  Usage: benchmark_otg_backends [number of motions] [seed]*/
+
+#include "BenchmarkTimer.hpp"
+#include <OTGBackend.hpp>
+#include <OTGMode.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace trajectory_generation;
+
+namespace{
+
+const unsigned int N_DOF = 7;
+const double CYCLE_TIME = 0.001;
+const unsigned int MAX_CYCLES = 100000;
+
+struct Result{
+    BenchmarkStats cycle_time;
+    double motion_time;
+    unsigned int errors;
+    Result() : motion_time(0), errors(0){}
+};
+
+double uniform(const double lo, const double hi){
+    return lo + (hi - lo) * rand() / RAND_MAX;
+}
+
+/** Random constraints and start/target state*/
+template<class Mode> void randomMotion(typename Mode::InputParameters& in);
+
+template<> void randomMotion<PositionMode>(RMLPositionInputParameters& in){
+    for(unsigned int i = 0; i < N_DOF; i++){
+        in.SelectionVector->VecData[i]           = true;
+        in.MaxVelocityVector->VecData[i]         = uniform(0.5, 2.0);
+        in.MaxAccelerationVector->VecData[i]     = uniform(1.0, 5.0);
+        in.MaxJerkVector->VecData[i]             = uniform(5.0, 50.0);
+        in.CurrentPositionVector->VecData[i]     = uniform(-2.0, 2.0);
+        in.CurrentVelocityVector->VecData[i]     = 0;
+        in.CurrentAccelerationVector->VecData[i] = 0;
+        in.TargetPositionVector->VecData[i]      = uniform(-2.0, 2.0);
+        in.TargetVelocityVector->VecData[i]      = 0;
+    }
+}
+
+template<> void randomMotion<VelocityMode>(RMLVelocityInputParameters& in){
+    for(unsigned int i = 0; i < N_DOF; i++){
+        in.SelectionVector->VecData[i]           = true;
+        in.MaxAccelerationVector->VecData[i]     = uniform(1.0, 5.0);
+        in.MaxJerkVector->VecData[i]             = uniform(5.0, 50.0);
+        in.CurrentPositionVector->VecData[i]     = uniform(-2.0, 2.0);
+        in.CurrentVelocityVector->VecData[i]     = uniform(-1.0, 1.0);
+        in.CurrentAccelerationVector->VecData[i] = 0;
+        in.TargetVelocityVector->VecData[i]      = uniform(-1.0, 1.0);
+    }
+}
+
+/** Run each motion until the final state is reached and feed back the new state, like RMLTask::stepOTG()*/
+template<class Mode> Result run(const OTGBackendType type, const unsigned int n_motions, const unsigned int seed){
+    typename Mode::InputParameters in(N_DOF);
+    typename Mode::OutputParameters out(N_DOF);
+    typename Mode::Flags flags;
+    flags.SynchronizationBehavior = RMLFlags::ONLY_TIME_SYNCHRONIZATION;
+    OTGBackend* backend = createOTGBackend(type, N_DOF, CYCLE_TIME);
+
+    Result result;
+    srand(seed);
+    for(unsigned int m = 0; m < n_motions; m++){
+        randomMotion<Mode>(in);
+        for(unsigned int c = 0; c < MAX_CYCLES; c++){
+            BenchmarkTimer timer;
+            const int res = Mode::run(*backend, in, out, flags);
+            result.cycle_time.add(timer.elapsed());
+            *in.CurrentPositionVector     = *out.NewPositionVector;
+            *in.CurrentVelocityVector     = *out.NewVelocityVector;
+            *in.CurrentAccelerationVector = *out.NewAccelerationVector;
+            if(res < 0)
+                result.errors++;
+            if(res != RML_WORKING)
+                break;
+            result.motion_time += CYCLE_TIME;
+        }
+    }
+    delete backend;
+    return result;
+}
+
+void print(const char* name, const Result& result, const unsigned int n_motions){
+    printf("%-28s %12.3f %12.3f %14.4f %8u\n", name, result.cycle_time.mean() * 1e6, result.cycle_time.max * 1e6,
+           result.motion_time / n_motions, result.errors);
+}
+
+}
+
+int main(int argc, char** argv){
+    const unsigned int n_motions = argc > 1 ? atoi(argv[1]) : 200;
+    const unsigned int seed = argc > 2 ? atoi(argv[2]) : 1;
+
+    printf("%u DOF, cycle time %.3f s, %u motions per backend\n", N_DOF, CYCLE_TIME, n_motions);
+    printf("%-28s %12s %12s %14s %8s\n", "backend", "mean [us]", "max [us]", "motion [s]", "errors");
+    print("Reflexxes (position)", run<PositionMode>(OTG_BACKEND_REFLEXXES, n_motions, seed), n_motions);
+    print("S-curve (position)",   run<PositionMode>(OTG_BACKEND_SCURVE,    n_motions, seed), n_motions);
+    print("Reflexxes (velocity)", run<VelocityMode>(OTG_BACKEND_REFLEXXES, n_motions, seed), n_motions);
+    print("S-curve (velocity)",   run<VelocityMode>(OTG_BACKEND_SCURVE,    n_motions, seed), n_motions);
+    return 0;
+}
@@ -0,0 +1,97 @@
+/** Measures the computation time of the Cartesian workspace limits (WorkspaceLimits.hpp) per target:
+ *  - check:       Feasible targets in a box with a keep-in and a keep-out sphere, i.e. only contains()
+ *  - closed form: Targets outside of one side of the box
+ *  - Dykstra:     Targets outside of a corner of the box and the keep-in sphere
+ *  - keep-out:    Targets inside of the keep-out sphere, which is intersecting the box
+ *  - worst case:  Constraints without intersection, so that all max_iterations passes are used before the target is rejected
+ *  test/test_workspace_limits.cpp checks the results. The max. times include preemptions and cache misses of the benchmark process.
+ *
+ *  Usage: benchmark_workspace_limits [number of calls] [max_iterations]*/
+
+#include "BenchmarkTimer.hpp"
+#include <WorkspaceLimits.hpp>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace trajectory_generation;
+
+namespace{
+
+WorkspaceConstraints boxWithSpheres(const unsigned int max_iterations){
+    WorkspaceConstraints constraints;
+    constraints.max_iterations = max_iterations;
+    for(int i = 0; i < 3; i++){
+        WorkspaceHalfspace h;
+        h.normal = base::Vector3d::Unit(i);
+        h.offset = 1.0;
+        constraints.halfspaces.push_back(h);
+        h.normal = -base::Vector3d::Unit(i);
+        constraints.halfspaces.push_back(h);
+    }
+    WorkspaceSphere s;
+    s.center = base::Vector3d::Zero();
+    s.radius = 1.5;
+    s.keep_out = false;
+    constraints.spheres.push_back(s);
+    s.center = base::Vector3d(1, 0, 0);
+    s.radius = 0.3;
+    s.keep_out = true;
+    constraints.spheres.push_back(s);
+    return constraints;
+}
+
+double uniform(const double lo, const double hi){
+    return lo + (hi - lo) * rand() / RAND_MAX;
+}
+
+/** Project n_calls targets from make_target and print mean and max. time per call*/
+template<class MakeTarget> void run(const char* name, WorkspaceLimits& limits, MakeTarget make_target, const unsigned int n_calls){
+    BenchmarkStats stats;
+    unsigned int n_rejected = 0;
+    for(unsigned int c = 0; c < n_calls; c++){
+        base::Vector3d p = make_target();
+        BenchmarkTimer timer;
+        const bool ok = limits.project(p);
+        stats.add(timer.elapsed());
+        n_rejected += !ok;
+    }
+    printf("%-12s %10.3f %10.3f %10u\n", name, stats.mean() * 1e6, stats.max * 1e6, n_rejected);
+}
+
+base::Vector3d feasible(){return base::Vector3d(uniform(-0.5, 0.5), uniform(-0.9, 0.9), uniform(-0.9, 0.9));}
+base::Vector3d outsideSide(){return base::Vector3d(uniform(-0.5, 0.5), uniform(1.1, 1.3), uniform(-0.5, 0.5));}
+base::Vector3d outsideCorner(){return base::Vector3d(uniform(-3, -1.5), uniform(1.5, 3), uniform(1.5, 3));}
+base::Vector3d insideKeepOut(){return base::Vector3d(uniform(0.8, 0.95), uniform(-0.1, 0.1), uniform(-0.1, 0.1));}
+
+}
+
+int main(int argc, char** argv){
+    const unsigned int n_calls = argc > 1 ? atoi(argv[1]) : 100000;
+    const unsigned int max_iterations = argc > 2 ? atoi(argv[2]) : WorkspaceConstraints().max_iterations;
+
+    WorkspaceLimits limits;
+    WorkspaceConstraints constraints = boxWithSpheres(max_iterations);
+    if(!limits.configure(constraints)){
+        fprintf(stderr, "Invalid constraints\n");
+        return 1;
+    }
+    printf("Time per target in us, %u calls, max_iterations = %u\n", n_calls, max_iterations);
+    printf("%-12s %10s %10s %10s\n", "", "mean", "max", "rejected");
+    srand(1);
+    run("check", limits, feasible, n_calls);
+    run("closed form", limits, outsideSide, n_calls);
+    run("Dykstra", limits, outsideCorner, n_calls);
+    run("keep-out", limits, insideKeepOut, n_calls);
+
+    // A half space beyond the box: Dykstra does not converge
+    WorkspaceHalfspace h;
+    h.normal = -base::Vector3d::UnitX();
+    h.offset = -2.0;
+    constraints.halfspaces.push_back(h);
+    if(!limits.configure(constraints)){
+        fprintf(stderr, "Invalid constraints\n");
+        return 1;
+    }
+    run("worst case", limits, outsideCorner, n_calls);
+    return 0;
+}
@@ -0,0 +1,64 @@
+/** Example of the embeddable joint generator (JointTrajectoryGenerator): Moves two joints from zero to the given target positions in-process,
+ *  without any Orocos component, and prints the commanded positions and speeds until the target is reached. A real controller would
+ *  read the joint state from the hardware in each cycle and pass the command to the drivers instead of printing it.
+ *
+ *  Usage: joint_generator_example [target position of joint_0] [target position of joint_1]*/
+
+#include <JointTrajectoryGenerator.hpp>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace trajectory_generation;
+
+int main(int argc, char** argv){
+    const double cycle_time = 0.01;
+
+    JointTrajectoryGeneratorConfig config;
+    config.cycle_time = cycle_time;
+    config.otg_backend = OTG_BACKEND_SCURVE;
+    config.motion_constraints.resize(2);
+    config.motion_constraints.names.resize(2);
+    for(size_t i = 0; i < 2; i++){
+        config.motion_constraints.names[i] = i == 0 ? "joint_0" : "joint_1";
+        config.motion_constraints[i].max.speed = 1.0;
+        config.motion_constraints[i].max.acceleration = 2.0;
+        config.motion_constraints[i].max_jerk = 20.0;
+    }
+
+    // Allocates all memory, the calls in the cycle below do not allocate
+    JointPositionGenerator generator;
+    if(!generator.configure(config))
+        return 1;
+
+    base::samples::Joints joint_state;
+    joint_state.names = config.motion_constraints.names;
+    joint_state.elements.resize(2);
+    joint_state[0].position = joint_state[1].position = 0;
+
+    joint_control_base::ConstrainedJointsCmd target;
+    target.names = config.motion_constraints.names;
+    target.elements.resize(2);
+    target[0].position = argc > 1 ? atof(argv[1]) : 1.0;
+    target[1].position = argc > 2 ? atof(argv[2]) : -0.5;
+
+    base::commands::Joints command;
+    if(generator.setCurrentState(joint_state, base::Time::now()) != VALIDATION_OK || generator.setTarget(target) != VALIDATION_OK){
+        const InputValidationError& error = generator.getValidationError();
+        printf("Invalid input (status %i, element %s, value %f)\n", error.status, error.name.c_str(), error.value);
+        return 1;
+    }
+
+    ReflexxesResultValue result = RML_WORKING;
+    for(double t = cycle_time; result == RML_WORKING; t += cycle_time){
+        result = generator.step(command);
+        if(result < 0){
+            printf("OTG failed with result value %i\n", result);
+            return 1;
+        }
+        printf("%.2f:", t);
+        for(size_t i = 0; i < command.size(); i++)
+            printf(" %s: pos %f, vel %f", config.motion_constraints.names[i].c_str(), command[i].position, command[i].speed);
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+/** Example driver side of the shared memory command (property shared_memory_command): Maps the segment of a running trajectory
+ *  generator, prints the element names and polls the latest command at a fixed rate. A real driver would pass the setpoints to the
+ *  hardware instead of printing them.
+ *
+ *  Usage: shared_command_reader <segment name, e.g. /arm_command> [poll period in seconds]*/
+
+#include <SharedMemoryCommand.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <vector>
+
+using namespace trajectory_generation;
+
+int main(int argc, char** argv){
+    if(argc < 2){
+        printf("Usage: %s <segment name, e.g. /arm_command> [poll period in seconds]\n", argv[0]);
+        return 1;
+    }
+    const double period = argc > 2 ? atof(argv[2]) : 0.01;
+
+    SharedCommandReader reader;
+    if(!reader.open(argv[1]))
+        return 1;
+
+    printf("Segment %s has %i elements:", argv[1], (int)reader.size());
+    for(size_t i = 0; i < reader.size(); i++)
+        printf(" %s", reader.names()[i].c_str());
+    printf("\n");
+
+    // Allocate once, read() does not allocate memory and never blocks the writer
+    std::vector<double> position(reader.size()), velocity(reader.size()), acceleration(reader.size());
+    base::Time time;
+    while(true){
+        if(reader.read(position.data(), velocity.data(), acceleration.data(), time)){
+            printf("%.6f:", time.toSeconds());
+            for(size_t i = 0; i < reader.size(); i++)
+                printf(" %s: pos %f, vel %f, acc %f", reader.names()[i].c_str(), position[i], velocity[i], acceleration[i]);
+            printf("\n");
+        }
+        usleep(period * 1e6);
+    }
+    return 0;
+}
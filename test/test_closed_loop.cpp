@@ -0,0 +1,231 @@
+/** Closed-loop tests of the joint generators (JointTrajectoryGenerator) with the plant models (PlantModel). The commands of randomized
+ *  scenarios are checked by TrajectoryChecker in each cycle, any violation of the motion constraints or of the continuity fails the test.
+ *
+ *  Environment variables:
+ *  - CLOSED_LOOP_SEEDS: Number of random seeds per test (default 100). Each seed runs one scenario per plant model and OTG backend
+ *  - CLOSED_LOOP_CSV:   File to which the results and the computation time of the generator of each scenario are written as CSV*/
+
+#include "BenchmarkTimer.hpp"
+#include <JointTrajectoryGenerator.hpp>
+#include <PlantModel.hpp>
+#include <TrajectoryChecker.hpp>
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+using namespace trajectory_generation;
+
+namespace{
+
+const unsigned int N_DOF = 3;
+const double CYCLE_TIME = 0.01;
+const unsigned int N_CYCLES = 1000;
+const unsigned int DEFAULT_SEEDS = 100;
+const double CHECK_TOLERANCE = 0.01;
+const PlantModelType PLANTS[] = {PLANT_IDEAL, PLANT_FIRST_ORDER_LAG, PLANT_SATURATING, PLANT_COMPLIANT_OFFSET};
+
+double uniform(const double lo, const double hi){
+    return lo + (hi - lo) * rand() / RAND_MAX;
+}
+
+unsigned int numberOfSeeds(){
+    const char* seeds = getenv("CLOSED_LOOP_SEEDS");
+    return seeds && atoi(seeds) > 0 ? atoi(seeds) : DEFAULT_SEEDS;
+}
+
+/** Per-scenario CSV output, not open if CLOSED_LOOP_CSV is not set*/
+std::ofstream& scenarioLog(){
+    static std::ofstream log;
+    static bool initialized = false;
+    if(!initialized){
+        initialized = true;
+        const char* path = getenv("CLOSED_LOOP_CSV");
+        if(path){
+            log.open(path);
+            log << "test,otg_backend,seed,plant,cycles,violations,position_limit_violations,mean_step_time_us,max_step_time_us" << std::endl;
+        }
+    }
+    return log;
+}
+
+PlantModelConfig plantConfig(const PlantModelType type){
+    PlantModelConfig config;
+    config.type = type;
+    config.initial_position.setZero(N_DOF);
+    config.time_constant = 0.1;
+    config.max_speed = 0.2;
+    config.offset.setConstant(N_DOF, 0.05);
+    config.offset_delay = 2.0;
+    return config;
+}
+
+/** Sweeps randomized scenarios of a joint generator against all plant models. The parameter is the OTG backend*/
+class ClosedLoopTest : public testing::TestWithParam<OTGBackendType>{
+protected:
+    JointTrajectoryGeneratorConfig config;
+    PlantModel plant;
+    TrajectoryChecker checker;
+    base::samples::Joints state;
+    base::commands::Joints command;
+    BenchmarkStats step_time;       /** Computation time of the generator per cycle in the last scenario*/
+    BenchmarkStats scenario_times;  /** Max. computation time of each scenario of the current test*/
+
+    void TearDown() override{
+        if(scenario_times.n == 0)
+            return;
+        RecordProperty("scenarios", scenario_times.n);
+        RecordProperty("mean_max_step_time_us", std::to_string(scenario_times.mean() * 1e6));
+        RecordProperty("max_step_time_us", std::to_string(scenario_times.max * 1e6));
+    }
+
+    /** Count the scenario and write it to the CSV output*/
+    void recordScenario(const unsigned int seed, const PlantModelType plant_type, const PlantSimulationResult& result){
+        scenario_times.add(step_time.max);
+        std::ofstream& log = scenarioLog();
+        if(!log.is_open())
+            return;
+        log << testing::UnitTest::GetInstance()->current_test_info()->name() << "," << config.otg_backend << "," << seed << ","
+            << plant_type << "," << result.cycles << "," << result.violations << "," << result.position_limit_violations << ","
+            << step_time.mean() * 1e6 << "," << step_time.max * 1e6 << std::endl;
+    }
+
+    /** Random motion constraints. Reflexxes Type II does not support position limits in velocity based OTG*/
+    void randomConfig(const bool velocity_based){
+        config = JointTrajectoryGeneratorConfig();
+        config.cycle_time = CYCLE_TIME;
+        config.otg_backend = GetParam();
+        config.synchronization_behavior = RMLFlags::ONLY_TIME_SYNCHRONIZATION;
+        config.motion_constraints.resize(N_DOF);
+        config.motion_constraints.names.resize(N_DOF);
+        for(unsigned int i = 0; i < N_DOF; i++){
+            joint_control_base::MotionConstraint& c = config.motion_constraints[i];
+            config.motion_constraints.names[i] = "joint_" + std::to_string(i);
+            c.max.speed        = uniform(0.5, 2.0);
+            c.max.acceleration = uniform(1.0, 5.0);
+            c.max_jerk         = uniform(5.0, 50.0);
+            c.min.position     = -uniform(2.0, 3.0);
+            c.max.position     =  uniform(2.0, 3.0);
+#ifndef USING_REFLEXXES_TYPE_IV
+            if(velocity_based && config.otg_backend == OTG_BACKEND_REFLEXXES)
+                c.min.position = c.max.position = base::NaN<double>();
+#endif
+        }
+    }
+
+    /** Random target within the position limits (position based) or the max. speed (velocity based)*/
+    joint_control_base::ConstrainedJointsCmd randomTarget(const bool velocity_based){
+        joint_control_base::ConstrainedJointsCmd target;
+        target.names = config.motion_constraints.names;
+        target.elements.resize(N_DOF);
+        for(unsigned int i = 0; i < N_DOF; i++){
+            const joint_control_base::MotionConstraint& c = config.motion_constraints[i];
+            if(velocity_based)
+                target[i].speed = uniform(-c.max.speed, c.max.speed);
+            else
+                target[i].position = uniform(-2.0, 2.0);
+        }
+        return target;
+    }
+
+    /** Run one scenario on the given plant and return the check results. A new random target is set every 0.5 to 2 seconds,
+     *  so that most motions are interrupted*/
+    template<class Mode> PlantSimulationResult run(const PlantModelType plant_type, const bool velocity_based){
+        JointTrajectoryGenerator<Mode> generator;
+        EXPECT_TRUE(generator.configure(config));
+        EXPECT_TRUE(plant.configure(plantConfig(plant_type), N_DOF));
+        // Reflexxes Type II limits only the acceleration
+        bool check_jerk = config.otg_backend == OTG_BACKEND_SCURVE;
+#ifdef USING_REFLEXXES_TYPE_IV
+        check_jerk = true;
+#endif
+        checker.configure(config.motion_constraints, CHECK_TOLERANCE, check_jerk);
+
+        state.resize(N_DOF);
+        state.names = config.motion_constraints.names;
+        for(unsigned int i = 0; i < N_DOF; i++){
+            state[i].position = plant.position()(i);
+            state[i].speed = 0;
+        }
+        command.resize(N_DOF);
+
+        step_time = BenchmarkStats();
+        base::Time time = base::Time::fromSeconds(1);
+        unsigned int next_target = 0;
+        for(unsigned int k = 0; k < N_CYCLES; k++){
+            EXPECT_EQ(VALIDATION_OK, generator.setCurrentState(state, time));
+            if(k == next_target){
+                EXPECT_EQ(VALIDATION_OK, generator.setTarget(randomTarget(velocity_based)));
+                next_target += uniform(0.5, 2.0) / CYCLE_TIME;
+            }
+            BenchmarkTimer timer;
+            const ReflexxesResultValue result = generator.step(command);
+            step_time.add(timer.elapsed());
+            EXPECT_GE(result, 0);
+            plant.step(command, CYCLE_TIME, state);
+            checker.update(command, state, CYCLE_TIME);
+            time = time + base::Time::fromSeconds(CYCLE_TIME);
+        }
+        return checker.getResult();
+    }
+
+    template<class Mode> void sweep(const bool velocity_based){
+        const unsigned int n_seeds = numberOfSeeds();
+        for(unsigned int seed = 1; seed <= n_seeds; seed++){
+            srand(seed);
+            randomConfig(velocity_based);
+            for(size_t p = 0; p < sizeof(PLANTS) / sizeof(PLANTS[0]); p++){
+                std::stringstream trace;
+                trace << "seed " << seed << ", plant " << PLANTS[p];
+                SCOPED_TRACE(trace.str());
+                const PlantSimulationResult result = run<Mode>(PLANTS[p], velocity_based);
+                recordScenario(seed, PLANTS[p], result);
+                EXPECT_EQ(N_CYCLES, result.cycles);
+                EXPECT_EQ(0u, result.violations) << "max. speed ratio " << result.max_speed_ratio << ", max. acceleration ratio "
+                    << result.max_acceleration_ratio << ", max. speed step ratio " << result.max_speed_step_ratio << ", max. jerk ratio "
+                    << result.max_jerk_ratio << ", max. position step error " << result.max_position_step_error;
+                EXPECT_EQ(0u, result.position_limit_violations);
+            }
+        }
+    }
+};
+
+TEST_P(ClosedLoopTest, positionCommandsRespectConstraints){
+    sweep<PositionMode>(false);
+}
+
+TEST_P(ClosedLoopTest, velocityCommandsRespectConstraints){
+    sweep<VelocityMode>(true);
+}
+
+TEST_P(ClosedLoopTest, velocityCommandsAsPositionsRespectConstraints){
+    config.convert_to_position = true;
+    sweep<VelocityMode>(true);
+}
+
+/** Velocity commands on a plant that cannot follow the commanded speed: The interpolator must not run away from the plant by more
+ *  than max_pos_diff plus the distance needed to stop*/
+TEST_P(ClosedLoopTest, windupIsLimitedByMaxPosDiff){
+    const double max_pos_diff = 0.1;
+    const unsigned int n_seeds = numberOfSeeds();
+    for(unsigned int seed = 1; seed <= n_seeds; seed++){
+        SCOPED_TRACE("seed " + std::to_string(seed));
+        srand(seed);
+        randomConfig(true);
+        config.convert_to_position = true;
+        config.max_pos_diff.setConstant(N_DOF, max_pos_diff);
+        double stop_distance = 0;
+        for(unsigned int i = 0; i < N_DOF; i++){
+            const joint_control_base::MotionConstraint& c = config.motion_constraints[i];
+            stop_distance = std::max(stop_distance, c.max.speed * (c.max.speed / c.max.acceleration + c.max.acceleration / c.max_jerk + CYCLE_TIME));
+        }
+        const PlantSimulationResult result = run<VelocityMode>(PLANT_SATURATING, true);
+        recordScenario(seed, PLANT_SATURATING, result);
+        EXPECT_EQ(0u, result.violations);
+        EXPECT_LE(result.max_tracking_error, max_pos_diff + stop_distance);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(OTGBackends, ClosedLoopTest, testing::Values(OTG_BACKEND_REFLEXXES, OTG_BACKEND_SCURVE));
+
+}
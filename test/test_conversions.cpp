@@ -0,0 +1,173 @@
+#include <Conversions.hpp>
+#include <gtest/gtest.h>
+
+using namespace trajectory_generation;
+
+namespace{
+
+const unsigned int N_DOF = 3;
+
+/** Recorded worst cases (WCETRecord::input) are replayed by converting them back to the RML types, see test/wcet_replay.cpp*/
+TEST(ConversionsTest, inputParamsRoundTrip){
+    RMLPositionInputParameters in(N_DOF), replayed(N_DOF);
+    for(unsigned int i = 0; i < N_DOF; i++){
+        in.SelectionVector->VecData[i]           = i != 1;
+        in.CurrentPositionVector->VecData[i]     = 0.1 * i;
+        in.CurrentVelocityVector->VecData[i]     = -0.2 * i;
+        in.CurrentAccelerationVector->VecData[i] = 0.3 * i;
+        in.MaxVelocityVector->VecData[i]         = 1.0 + i;
+        in.MaxAccelerationVector->VecData[i]     = 2.0 + i;
+        in.MaxJerkVector->VecData[i]             = 20.0 + i;
+        in.TargetPositionVector->VecData[i]      = -1.0 * i;
+        in.TargetVelocityVector->VecData[i]      = 0.5 * i;
+    }
+    in.MinimumSynchronizationTime = 1.5;
+
+    ReflexxesInputParameters record(N_DOF);
+    rmlTypes2InputParams(in, record);
+    inputParams2RmlTypes(record, replayed);
+
+    for(unsigned int i = 0; i < N_DOF; i++){
+        EXPECT_EQ(in.SelectionVector->VecData[i],           replayed.SelectionVector->VecData[i]);
+        EXPECT_EQ(in.CurrentPositionVector->VecData[i],     replayed.CurrentPositionVector->VecData[i]);
+        EXPECT_EQ(in.CurrentVelocityVector->VecData[i],     replayed.CurrentVelocityVector->VecData[i]);
+        EXPECT_EQ(in.CurrentAccelerationVector->VecData[i], replayed.CurrentAccelerationVector->VecData[i]);
+        EXPECT_EQ(in.MaxVelocityVector->VecData[i],         replayed.MaxVelocityVector->VecData[i]);
+        EXPECT_EQ(in.MaxAccelerationVector->VecData[i],     replayed.MaxAccelerationVector->VecData[i]);
+        EXPECT_EQ(in.MaxJerkVector->VecData[i],             replayed.MaxJerkVector->VecData[i]);
+        EXPECT_EQ(in.TargetPositionVector->VecData[i],      replayed.TargetPositionVector->VecData[i]);
+        EXPECT_EQ(in.TargetVelocityVector->VecData[i],      replayed.TargetVelocityVector->VecData[i]);
+    }
+    EXPECT_EQ(1.5, replayed.MinimumSynchronizationTime);
+}
+
+class JointTargetTest : public testing::Test{
+protected:
+    joint_control_base::MotionConstraints default_constraints;
+    InputValidationError error;
+
+    JointTargetTest(){
+        default_constraints.resize(N_DOF);
+        default_constraints.names.resize(N_DOF);
+        for(unsigned int i = 0; i < N_DOF; i++){
+            default_constraints.names[i] = "joint_" + std::to_string(i);
+            default_constraints[i].max.speed        = 1.0;
+            default_constraints[i].max.acceleration = 2.0;
+            default_constraints[i].max_jerk         = 20.0;
+        }
+    }
+
+    joint_control_base::ConstrainedJointsCmd partialTarget(const std::string& name, const double position){
+        joint_control_base::ConstrainedJointsCmd target;
+        target.names.push_back(name);
+        target.elements.resize(1);
+        target[0].position = position;
+        return target;
+    }
+};
+
+TEST_F(JointTargetTest, mergedTargetKeepsOtherElements){
+    RMLPositionInputParameters in(N_DOF);
+    joint_control_base::ConstrainedJointsCmd target;
+    target.names = default_constraints.names;
+    target.elements.resize(N_DOF);
+    for(unsigned int i = 0; i < N_DOF; i++)
+        target[i].position = 1.0 + i;
+    ASSERT_EQ(VALIDATION_OK, target2RmlTypes(target, default_constraints, in, error));
+
+    ASSERT_EQ(VALIDATION_OK, target2RmlTypes(partialTarget("joint_1", -1.0), default_constraints, in, error, true));
+    for(unsigned int i = 0; i < N_DOF; i++)
+        EXPECT_TRUE(in.SelectionVector->VecData[i]);
+    EXPECT_EQ(1.0, in.TargetPositionVector->VecData[0]);
+    EXPECT_EQ(-1.0, in.TargetPositionVector->VecData[1]);
+    EXPECT_EQ(3.0, in.TargetPositionVector->VecData[2]);
+
+    // Without merging, only the elements of the target are selected
+    ASSERT_EQ(VALIDATION_OK, target2RmlTypes(partialTarget("joint_1", -2.0), default_constraints, in, error));
+    EXPECT_FALSE(in.SelectionVector->VecData[0]);
+    EXPECT_TRUE(in.SelectionVector->VecData[1]);
+    EXPECT_FALSE(in.SelectionVector->VecData[2]);
+}
+
+TEST_F(JointTargetTest, invalidMergedTargetLeavesParamsUntouched){
+    RMLPositionInputParameters in(N_DOF);
+    ASSERT_EQ(VALIDATION_OK, target2RmlTypes(partialTarget("joint_0", 0.5), default_constraints, in, error));
+
+    joint_control_base::ConstrainedJointsCmd invalid = partialTarget("joint_2", 1.0);
+    invalid.names.push_back("unknown");
+    invalid.elements.push_back(invalid[0]);
+    EXPECT_EQ(VALIDATION_UNKNOWN_NAME, target2RmlTypes(invalid, default_constraints, in, error, true));
+    EXPECT_EQ("unknown", error.name);
+    EXPECT_TRUE(in.SelectionVector->VecData[0]);
+    EXPECT_FALSE(in.SelectionVector->VecData[2]);
+    EXPECT_EQ(0.5, in.TargetPositionVector->VecData[0]);
+}
+
+/** Mixed mode: A merged element switches between position and velocity based OTG*/
+TEST_F(JointTargetTest, mergedMixedTargetSwitchesMode){
+    RMLPositionInputParameters pos_in(N_DOF);
+    RMLVelocityInputParameters vel_in(N_DOF);
+    joint_control_base::ConstrainedJointsCmd target = partialTarget("joint_0", 0.5);
+    ASSERT_EQ(VALIDATION_OK, target2RmlTypes(target, default_constraints, pos_in, vel_in, error));
+    EXPECT_TRUE(pos_in.SelectionVector->VecData[0]);
+
+    target[0].position = base::NaN<double>();
+    target[0].speed = 0.2;
+    ASSERT_EQ(VALIDATION_OK, target2RmlTypes(target, default_constraints, pos_in, vel_in, error, true));
+    EXPECT_FALSE(pos_in.SelectionVector->VecData[0]);
+    EXPECT_TRUE(vel_in.SelectionVector->VecData[0]);
+    EXPECT_EQ(0.2, vel_in.TargetVelocityVector->VecData[0]);
+}
+
+TEST_F(JointTargetTest, mergeJointTargetOverwritesAndAppends){
+    joint_control_base::ConstrainedJointsCmd merged = partialTarget("joint_0", 0.5);
+    merged.motion_constraints.resize(1);
+    merged.motion_constraints[0].max.speed = 0.3;
+
+    // Elements without motion constraints in the partial target keep theirs
+    joint_control_base::ConstrainedJointsCmd partial = partialTarget("joint_0", 0.7);
+    partial.time = base::Time::fromSeconds(1);
+    mergeJointTarget(partial, merged);
+    ASSERT_EQ(1u, merged.size());
+    EXPECT_EQ(0.7, merged[0].position);
+    EXPECT_EQ(0.3, merged.motion_constraints[0].max.speed);
+    EXPECT_EQ(partial.time, merged.time);
+
+    partial = partialTarget("joint_2", -0.4);
+    partial.motion_constraints.resize(1);
+    partial.motion_constraints[0].max.speed = 0.6;
+    mergeJointTarget(partial, merged);
+    ASSERT_EQ(2u, merged.size());
+    ASSERT_EQ(2u, merged.motion_constraints.size());
+    EXPECT_EQ("joint_2", merged.names[1]);
+    EXPECT_EQ(-0.4, merged[1].position);
+    EXPECT_EQ(0.6, merged.motion_constraints[1].max.speed);
+    EXPECT_EQ(0.3, merged.motion_constraints[0].max.speed);
+}
+
+/** The tasks presize the merged target with all joints, so that merging in the cycle does not allocate memory*/
+TEST_F(JointTargetTest, presizedMergedTargetDoesNotGrow){
+    joint_control_base::ConstrainedJointsCmd merged;
+    merged.names = default_constraints.names;
+    merged.elements.assign(N_DOF, base::JointState());
+    merged.motion_constraints.assign(N_DOF, joint_control_base::MotionConstraint());
+    const base::JointState* elements = merged.elements.data();
+    const joint_control_base::MotionConstraint* constraints = merged.motion_constraints.data();
+
+    joint_control_base::ConstrainedJointsCmd partial = partialTarget("joint_1", 0.8);
+    partial.motion_constraints.resize(1);
+    partial.motion_constraints[0].max.speed = 0.6;
+    mergeJointTarget(partial, merged);
+    mergeJointTarget(partialTarget("joint_2", 0.1), merged);
+
+    ASSERT_EQ(N_DOF, merged.size());
+    EXPECT_EQ(elements, merged.elements.data());
+    EXPECT_EQ(constraints, merged.motion_constraints.data());
+    EXPECT_TRUE(base::isNaN(merged[0].position));
+    EXPECT_EQ(0.8, merged[1].position);
+    EXPECT_EQ(0.6, merged.motion_constraints[1].max.speed);
+    EXPECT_EQ(0.1, merged[2].position);
+    EXPECT_TRUE(base::isNaN(merged.motion_constraints[2].max.speed));
+}
+
+}
@@ -0,0 +1,173 @@
+#include <DeadlineTracker.hpp>
+#include <SCurveBackend.hpp>
+#include <gtest/gtest.h>
+
+using namespace trajectory_generation;
+
+namespace{
+
+const double CYCLE_TIME = 0.01;
+const unsigned int MAX_CYCLES = 1000;
+
+/** Single DOF position based OTG with a deadline on a simulated clock, cycled like RMLTask::runSingleCycle() with
+ *  RMLTask::applyDeadline() and RMLTask::evaluateDeadline()*/
+class DeadlineTrackerTest : public testing::Test{
+protected:
+    SCurveBackend backend;
+    RMLPositionInputParameters in;
+    RMLPositionOutputParameters out;
+    RMLPositionFlags flags;
+    DeadlineTracker deadline;
+    base::Time now;             /** Simulated clock, advanced by one cycle time per cycle*/
+    bool target_changed;
+    bool dropped;               /** True if the last cycle dropped the deadline of the previous target*/
+    int result;
+    base::Time arrival;         /** Time at which the motion has ended, null while it is running*/
+
+    DeadlineTrackerTest() : backend(1, CYCLE_TIME), in(1), out(1), now(base::Time::fromSeconds(1000)), target_changed(false),
+                            dropped(false), result(RML_NOT_INITIALIZED){
+        in.SelectionVector->VecData[0] = true;
+        in.MaxVelocityVector->VecData[0] = 1.0;
+        in.MaxAccelerationVector->VecData[0] = 2.0;
+        in.MaxJerkVector->VecData[0] = 20.0;
+        in.CurrentPositionVector->VecData[0] = 0;
+        in.CurrentVelocityVector->VecData[0] = 0;
+        in.CurrentAccelerationVector->VecData[0] = 0;
+        in.TargetVelocityVector->VecData[0] = 0;
+    }
+
+    void setTarget(const double position){
+        in.TargetPositionVector->VecData[0] = position;
+        target_changed = true;
+        arrival = base::Time();
+    }
+
+    void cycle(){
+        now = now + base::Time::fromSeconds(CYCLE_TIME);
+        dropped = deadline.apply(now, target_changed, CYCLE_TIME, in.MinimumSynchronizationTime);
+        target_changed = false;
+        result = backend.RMLPosition(in, &out, flags);
+        ASSERT_GE(result, 0);
+        if(deadline.isActive())
+            deadline.evaluate(now, result, out, CYCLE_TIME, in.MinimumSynchronizationTime);
+        *in.CurrentPositionVector = *out.NewPositionVector;
+        *in.CurrentVelocityVector = *out.NewVelocityVector;
+        *in.CurrentAccelerationVector = *out.NewAccelerationVector;
+        // The motion ends within this cycle, at the remaining execution time
+        if(result == RML_FINAL_STATE_REACHED && arrival.isNull())
+            arrival = now + base::Time::fromSeconds(out.SynchronizationTime);
+    }
+
+    /** Run cycles until the target has been reached*/
+    void runUntilArrival(){
+        for(unsigned int k = 0; k < MAX_CYCLES && arrival.isNull(); k++)
+            cycle();
+        ASSERT_FALSE(arrival.isNull());
+    }
+
+    /** Time-optimal execution time of a motion from the current state to the given target*/
+    double unstretchedTime(const double position){
+        SCurveBackend scratch(1, CYCLE_TIME);
+        RMLPositionInputParameters scratch_in = in;
+        RMLPositionOutputParameters scratch_out(1);
+        scratch_in.TargetPositionVector->VecData[0] = position;
+        scratch_in.MinimumSynchronizationTime = 0;
+        EXPECT_GE(scratch.RMLPosition(scratch_in, &scratch_out, flags), 0);
+        return scratch_out.SynchronizationTime;
+    }
+};
+
+TEST_F(DeadlineTrackerTest, targetArrivesAtTheDeadline){
+    const base::Time arrival_time = now + base::Time::fromSeconds(3.0);
+    ASSERT_LT(unstretchedTime(1.0), 2.0);
+    deadline.request(now, arrival_time);
+    setTarget(1.0);
+    cycle();
+    EXPECT_TRUE(deadline.isActive());
+    EXPECT_EQ(DEADLINE_FEASIBLE, deadline.getStatus().state);
+
+    runUntilArrival();
+    EXPECT_NEAR(0, (arrival - arrival_time).toSeconds(), CYCLE_TIME / 2);
+    EXPECT_NEAR(1.0, out.NewPositionVector->VecData[0], 1e-9);
+    EXPECT_EQ(DEADLINE_REACHED, deadline.getStatus().state);
+    EXPECT_FALSE(deadline.isActive());
+    EXPECT_EQ(0, in.MinimumSynchronizationTime);
+}
+
+TEST_F(DeadlineTrackerTest, deadlineIsArmedByTheNextTarget){
+    setTarget(1.0);
+    for(unsigned int k = 0; k < 10; k++)
+        cycle();
+
+    // A deadline requested during a motion does not affect it
+    const double first_time = unstretchedTime(1.0);
+    const base::Time start = now;
+    const base::Time arrival_time = now + base::Time::fromSeconds(first_time + 3.0);
+    deadline.request(now, arrival_time);
+    runUntilArrival();
+    EXPECT_FALSE(deadline.isActive());
+    EXPECT_TRUE(deadline.isPending());
+    EXPECT_NEAR(first_time, (arrival - start).toSeconds(), CYCLE_TIME);
+    EXPECT_EQ(0, in.MinimumSynchronizationTime);
+
+    // The next target reaches the deadline
+    setTarget(0.0);
+    runUntilArrival();
+    EXPECT_FALSE(deadline.isPending());
+    EXPECT_NEAR(0, (arrival - arrival_time).toSeconds(), CYCLE_TIME / 2);
+    EXPECT_EQ(DEADLINE_REACHED, deadline.getStatus().state);
+}
+
+TEST_F(DeadlineTrackerTest, deadlineIsDroppedWhenTheTargetIsReplaced){
+    deadline.request(now, now + base::Time::fromSeconds(5.0));
+    setTarget(1.0);
+    for(unsigned int k = 0; k < 10; k++)
+        cycle();
+    EXPECT_TRUE(deadline.isActive());
+    EXPECT_GT(in.MinimumSynchronizationTime, 0);
+
+    // The replacing target moves time-optimally
+    const double replaced_time = unstretchedTime(2.0);
+    const base::Time start = now;
+    setTarget(2.0);
+    cycle();
+    EXPECT_TRUE(dropped);
+    EXPECT_FALSE(deadline.isActive());
+    EXPECT_EQ(DEADLINE_NONE, deadline.getStatus().state);
+    EXPECT_EQ(0, in.MinimumSynchronizationTime);
+    runUntilArrival();
+    EXPECT_NEAR(replaced_time, (arrival - start).toSeconds(), CYCLE_TIME);
+}
+
+TEST_F(DeadlineTrackerTest, nullTimeDropsTheDeadline){
+    deadline.request(now, now + base::Time::fromSeconds(5.0));
+    setTarget(1.0);
+    for(unsigned int k = 0; k < 10; k++)
+        cycle();
+    EXPECT_GT(in.MinimumSynchronizationTime, 0);
+
+    deadline.request(now, base::Time());
+    EXPECT_FALSE(deadline.isActive());
+    EXPECT_EQ(DEADLINE_NONE, deadline.getStatus().state);
+    cycle();
+    EXPECT_FALSE(dropped) << "Only a new target reports a dropped deadline";
+    EXPECT_EQ(0, in.MinimumSynchronizationTime);
+}
+
+TEST_F(DeadlineTrackerTest, infeasibleDeadlineIsMissed){
+    const double optimal_time = unstretchedTime(1.0);
+    const base::Time arrival_time = now + base::Time::fromSeconds(optimal_time / 2);
+    deadline.request(now, arrival_time);
+    setTarget(1.0);
+    const base::Time start = now;
+    cycle();
+    EXPECT_EQ(DEADLINE_INFEASIBLE, deadline.getStatus().state);
+
+    // The motion is time-optimal instead
+    runUntilArrival();
+    EXPECT_NEAR(optimal_time, (arrival - start).toSeconds(), CYCLE_TIME);
+    EXPECT_EQ(DEADLINE_MISSED, deadline.getStatus().state);
+    EXPECT_FALSE(deadline.isActive());
+}
+
+}
@@ -0,0 +1,191 @@
+#include <JointTrajectoryGenerator.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+
+using namespace trajectory_generation;
+
+namespace{
+
+const unsigned int N_DOF = 2;
+const double CYCLE_TIME = 0.01;
+const unsigned int MAX_CYCLES = 1000;
+
+class JointTrajectoryGeneratorTest : public testing::Test{
+protected:
+    JointTrajectoryGeneratorConfig config;
+    base::samples::Joints state;
+    joint_control_base::ConstrainedJointsCmd target;
+    base::commands::Joints command;
+
+    /** The S-curve backend is used, so that the results do not depend on the Reflexxes variant*/
+    JointTrajectoryGeneratorTest(){
+        config.cycle_time = CYCLE_TIME;
+        config.otg_backend = OTG_BACKEND_SCURVE;
+        config.motion_constraints.resize(N_DOF);
+        config.motion_constraints.names.resize(N_DOF);
+        for(unsigned int i = 0; i < N_DOF; i++){
+            config.motion_constraints.names[i] = "joint_" + std::to_string(i);
+            config.motion_constraints[i].max.speed        = 1.0;
+            config.motion_constraints[i].max.acceleration = 2.0;
+            config.motion_constraints[i].max_jerk         = 20.0;
+            config.motion_constraints[i].min.position     = -10.0;
+            config.motion_constraints[i].max.position     = 10.0;
+        }
+        state.names = target.names = config.motion_constraints.names;
+        state.elements.resize(N_DOF);
+        target.elements.resize(N_DOF);
+        for(unsigned int i = 0; i < N_DOF; i++)
+            state[i].position = 0;
+    }
+};
+
+TEST_F(JointTrajectoryGeneratorTest, unconfiguredGeneratorRejectsInput){
+    JointPositionGenerator generator;
+    EXPECT_FALSE(generator.isConfigured());
+    EXPECT_EQ(VALIDATION_NOT_CONFIGURED, generator.setCurrentState(state, base::Time::now()));
+    EXPECT_EQ(VALIDATION_NOT_CONFIGURED, generator.setTarget(target));
+    EXPECT_EQ(VALIDATION_NOT_CONFIGURED, generator.getValidationError().status);
+    EXPECT_EQ(RML_NOT_INITIALIZED, generator.step(command));
+}
+
+TEST_F(JointTrajectoryGeneratorTest, invalidConfigurationIsRejected){
+    JointVelocityGenerator generator;
+    JointTrajectoryGeneratorConfig invalid = config;
+    invalid.cycle_time = 0;
+    EXPECT_FALSE(generator.configure(invalid));
+    invalid = config;
+    invalid.motion_constraints.names.pop_back();
+    EXPECT_FALSE(generator.configure(invalid));
+    invalid = config;
+    invalid.max_pos_diff.setConstant(N_DOF + 1, 0.1);
+    EXPECT_FALSE(generator.configure(invalid));
+    EXPECT_FALSE(generator.isConfigured());
+    EXPECT_TRUE(generator.configure(config));
+}
+
+TEST_F(JointTrajectoryGeneratorTest, positionTargetIsReached){
+    JointPositionGenerator generator;
+    ASSERT_TRUE(generator.configure(config));
+    target[0].position = 1.0;
+    target[1].position = -0.5;
+    EXPECT_EQ(RML_NOT_INITIALIZED, generator.step(command));
+    ASSERT_EQ(VALIDATION_OK, generator.setCurrentState(state, base::Time::now()));
+    ASSERT_EQ(VALIDATION_OK, generator.setTarget(target));
+
+    ReflexxesResultValue result = RML_WORKING;
+    for(unsigned int k = 0; k < MAX_CYCLES && result == RML_WORKING; k++)
+        result = generator.step(command);
+    ASSERT_EQ(RML_FINAL_STATE_REACHED, result);
+    ASSERT_EQ(N_DOF, command.size());
+    EXPECT_NEAR(1.0, command[0].position, 1e-6);
+    EXPECT_NEAR(-0.5, command[1].position, 1e-6);
+    EXPECT_NEAR(0.0, command[0].speed, 1e-6);
+}
+
+/** The position limits are handled by the generator, so this does not depend on the Reflexxes variant either*/
+TEST_F(JointTrajectoryGeneratorTest, positionLimitsFollowTheConfiguredBehavior){
+    config.motion_constraints[0].max.position = 0.5;
+    target[0].position = 1.0;
+    target[1].position = -0.5;
+    const PositionalLimitsBehavior behaviors[] = {POSITIONAL_LIMITS_ACTIVELY_PREVENT, POSITIONAL_LIMITS_IGNORE};
+    const double expected[] = {0.5, 1.0};
+    for(unsigned int b = 0; b < 2; b++){
+        config.positional_limits_behavior = behaviors[b];
+        JointPositionGenerator generator;
+        ASSERT_TRUE(generator.configure(config));
+        ASSERT_EQ(VALIDATION_OK, generator.setCurrentState(state, base::Time::now()));
+        ASSERT_EQ(VALIDATION_OK, generator.setTarget(target));
+        EXPECT_EQ(behaviors[b] == POSITIONAL_LIMITS_ACTIVELY_PREVENT, generator.getLimitViolations().test(0));
+        EXPECT_FALSE(generator.getLimitViolations().test(1));
+
+        ReflexxesResultValue result = RML_WORKING;
+        for(unsigned int k = 0; k < MAX_CYCLES && result == RML_WORKING; k++)
+            result = generator.step(command);
+        ASSERT_EQ(RML_FINAL_STATE_REACHED, result);
+        EXPECT_NEAR(expected[b], command[0].position, 1e-6);
+    }
+
+    // Start states beyond the limits are rejected unless the limits are ignored
+    config.positional_limits_behavior = POSITIONAL_LIMITS_ACTIVELY_PREVENT;
+    state[0].position = 0.6;
+    JointPositionGenerator generator;
+    ASSERT_TRUE(generator.configure(config));
+    EXPECT_EQ(VALIDATION_POSITION_LIMITS, generator.setCurrentState(state, base::Time::now()));
+}
+
+TEST_F(JointTrajectoryGeneratorTest, invalidTargetKeepsPreviousTarget){
+    JointPositionGenerator generator;
+    ASSERT_TRUE(generator.configure(config));
+    target[0].position = 1.0;
+    target[1].position = -0.5;
+    ASSERT_EQ(VALIDATION_OK, generator.setTarget(target));
+
+    joint_control_base::ConstrainedJointsCmd invalid = target;
+    invalid.names[1] = "unknown";
+    invalid[0].position = 2.0;
+    EXPECT_EQ(VALIDATION_UNKNOWN_NAME, generator.setTarget(invalid));
+    EXPECT_EQ("unknown", generator.getValidationError().name);
+    EXPECT_EQ(1.0, generator.getInputParameters().TargetPositionVector->VecData[0]);
+
+    invalid = target;
+    invalid[1].position = base::NaN<double>();
+    EXPECT_EQ(VALIDATION_INVALID_POSITION, generator.setTarget(invalid));
+    EXPECT_EQ(-0.5, generator.getInputParameters().TargetPositionVector->VecData[1]);
+}
+
+TEST_F(JointTrajectoryGeneratorTest, embeddedGeneratorOperatesOnCallerParameters){
+    JointVelocityGenerator generator;
+    ASSERT_TRUE(generator.configure(config, false));
+    EXPECT_TRUE(generator.isConfigured());
+    // Without backend, only the overloads that take RML parameters can be used
+    EXPECT_EQ(VALIDATION_NOT_CONFIGURED, generator.setTarget(target));
+
+    RMLVelocityInputParameters in(N_DOF);
+    ViolationMask violations(N_DOF);
+    InputValidationError error;
+    state[0].position = 0.3;
+    state[1].position = -0.2;
+    target[0].speed = 0.5;
+    target[1].speed = -0.25;
+    EXPECT_EQ(VALIDATION_OK, generator.setCurrentState(state, base::Time::now(), in, violations, error));
+    EXPECT_EQ(VALIDATION_OK, generator.setTarget(target, in, violations, error));
+    EXPECT_TRUE(generator.hasCurrentState());
+    EXPECT_TRUE(generator.hasTarget());
+    EXPECT_EQ(0.3, in.CurrentPositionVector->VecData[0]);
+    EXPECT_EQ(-0.2, in.CurrentPositionVector->VecData[1]);
+    EXPECT_EQ(0.5, in.TargetVelocityVector->VecData[0]);
+    EXPECT_EQ(-0.25, in.TargetVelocityVector->VecData[1]);
+    EXPECT_EQ(RML_NOT_INITIALIZED, generator.step(command));
+}
+
+/** Velocity commands as positions on a plant that does not move: The interpolator must stop once it is max_pos_diff ahead of the
+ *  measured position, and continue with the target speed as soon as the plant catches up*/
+TEST_F(JointTrajectoryGeneratorTest, windupCorrectionStopsJointsThatCannotFollow){
+    const double max_pos_diff = 0.1;
+    config.convert_to_position = true;
+    config.max_pos_diff.setConstant(N_DOF, max_pos_diff);
+    JointVelocityGenerator generator;
+    ASSERT_TRUE(generator.configure(config));
+    target[0].speed = 0.5;
+    target[1].speed = 0;
+    ASSERT_EQ(VALIDATION_OK, generator.setCurrentState(state, base::Time::now()));
+    ASSERT_EQ(VALIDATION_OK, generator.setTarget(target));
+
+    const joint_control_base::MotionConstraint& c = config.motion_constraints[0];
+    const double stop_distance = c.max.speed * (c.max.speed / c.max.acceleration + c.max.acceleration / c.max_jerk + CYCLE_TIME);
+    for(unsigned int k = 0; k < MAX_CYCLES; k++){
+        ASSERT_EQ(VALIDATION_OK, generator.setCurrentState(state, base::Time::now()));
+        ASSERT_GE(generator.step(command), 0);
+        EXPECT_LE(command[0].position, max_pos_diff + stop_distance);
+    }
+    EXPECT_NEAR(0.0, command[0].speed, 1e-6);
+    EXPECT_EQ(0.0, generator.getInputParameters().TargetVelocityVector->VecData[0]);
+
+    // The plant catches up
+    state[0].position = command[0].position;
+    ASSERT_EQ(VALIDATION_OK, generator.setCurrentState(state, base::Time::now()));
+    ASSERT_GE(generator.step(command), 0);
+    EXPECT_EQ(0.5, generator.getInputParameters().TargetVelocityVector->VecData[0]);
+}
+
+}
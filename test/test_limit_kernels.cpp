@@ -0,0 +1,127 @@
+#include "ScalarLimitKernels.hpp"
+#include <LimitKernels.hpp>
+#include <base/Float.hpp>
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <cstring>
+
+using namespace trajectory_generation;
+
+namespace{
+
+const double CYCLE_TIME = 0.001;
+
+/** DOF counts below, at and beyond the block size of 64, including partial blocks*/
+const size_t N_DOFS[] = {1, 7, 63, 64, 65, 100, 128, 130};
+
+double uniform(const double lo, const double hi){
+    return lo + (hi - lo) * rand() / RAND_MAX;
+}
+
+/** Random values with NaN and infinite entries and values exactly at the limits*/
+double randomValue(const double limit){
+    switch(rand() % 8){
+    case 0:  return base::NaN<double>();
+    case 1:  return rand() % 2 ? base::infinity<double>() : -base::infinity<double>();
+    case 2:  return rand() % 2 ? limit : -limit;
+    default: return uniform(-2.0 * limit, 2.0 * limit);
+    }
+}
+
+/** Random limits, some of them NaN or infinite (not set)*/
+struct Limits{
+    std::vector<double> min, max;
+    Limits(const size_t n) : min(n), max(n){
+        for(size_t i = 0; i < n; i++){
+            min[i] = -1.0;
+            max[i] = 1.0;
+            if(rand() % 8 == 0)
+                min[i] = rand() % 2 ? base::NaN<double>() : -base::infinity<double>();
+            if(rand() % 8 == 0)
+                max[i] = rand() % 2 ? base::NaN<double>() : base::infinity<double>();
+        }
+    }
+};
+
+/** Bitwise comparison, so that NaN values compare equal*/
+void expectSameValues(const std::vector<double>& expected, const std::vector<double>& actual){
+    for(size_t i = 0; i < expected.size(); i++)
+        EXPECT_EQ(0, memcmp(&expected[i], &actual[i], sizeof(double))) << "DOF " << i << ": " << expected[i] << " != " << actual[i];
+}
+
+void expectSameMask(const std::vector<bool>& expected, const ViolationMask& actual){
+    size_t n_set = 0;
+    for(size_t i = 0; i < expected.size(); i++){
+        EXPECT_EQ(expected[i], actual.test(i)) << "DOF " << i;
+        n_set += expected[i];
+    }
+    // Bits beyond the number of DOF must not be set
+    EXPECT_EQ(n_set, actual.count());
+}
+
+TEST(LimitKernelsTest, clampMatchesScalarLoop){
+    srand(1);
+    for(size_t n : N_DOFS){
+        SCOPED_TRACE(n);
+        for(unsigned int k = 0; k < 20; k++){
+            const Limits limits(n);
+            std::vector<double> values(n);
+            for(size_t i = 0; i < n; i++)
+                values[i] = randomValue(1.0);
+            std::vector<double> expected = values;
+            std::vector<bool> expected_mask(n);
+            ViolationMask mask(n);
+            mask.set(n - 1);
+            scalarClamp(limits.min.data(), limits.max.data(), expected.data(), n, expected_mask);
+            clampToLimits(limits.min.data(), limits.max.data(), values.data(), n, mask);
+            expectSameValues(expected, values);
+            expectSameMask(expected_mask, mask);
+        }
+    }
+}
+
+TEST(LimitKernelsTest, checkMatchesScalarLoop){
+    srand(2);
+    for(size_t n : N_DOFS){
+        SCOPED_TRACE(n);
+        for(unsigned int k = 0; k < 20; k++){
+            const Limits limits(n);
+            std::vector<double> values(n);
+            for(size_t i = 0; i < n; i++)
+                values[i] = randomValue(1.0);
+            const std::vector<double> unchanged = values;
+            std::vector<bool> expected_mask(n);
+            ViolationMask mask(n);
+            mask.set(n - 1);
+            scalarCheck(limits.min.data(), limits.max.data(), values.data(), n, expected_mask);
+            checkLimits(limits.min.data(), limits.max.data(), values.data(), n, mask);
+            expectSameValues(unchanged, values);
+            expectSameMask(expected_mask, mask);
+        }
+    }
+}
+
+TEST(LimitKernelsTest, zeroVelocityMatchesScalarLoop){
+    srand(3);
+    for(size_t n : N_DOFS){
+        SCOPED_TRACE(n);
+        for(unsigned int k = 0; k < 20; k++){
+            const Limits limits(n);
+            std::vector<double> position(n), velocity(n);
+            for(size_t i = 0; i < n; i++){
+                position[i] = randomValue(1.0);
+                velocity[i] = randomValue(10.0);
+            }
+            std::vector<double> expected = velocity;
+            std::vector<bool> expected_mask(n);
+            ViolationMask mask(n);
+            mask.set(n - 1);
+            scalarZeroVelocity(CYCLE_TIME, limits.min.data(), limits.max.data(), position.data(), expected.data(), n, expected_mask);
+            zeroVelocityAtLimits(CYCLE_TIME, limits.min.data(), limits.max.data(), position.data(), velocity.data(), n, mask);
+            expectSameValues(expected, velocity);
+            expectSameMask(expected_mask, mask);
+        }
+    }
+}
+
+}
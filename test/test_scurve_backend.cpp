@@ -0,0 +1,303 @@
+#include <SCurveBackend.hpp>
+#include <OTGMode.hpp>
+#include <base/Float.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdlib>
+
+using namespace trajectory_generation;
+
+namespace{
+
+const double CYCLE_TIME = 0.001;
+const unsigned int MAX_CYCLES = 20000;
+const double EPS = 1e-9;
+
+double uniform(const double lo, const double hi){
+    return lo + (hi - lo) * rand() / RAND_MAX;
+}
+
+/** Duration of a time-optimal rest-to-rest motion over distance d, computed in closed form*/
+double restToRestTime(const double d, const double V, const double A, const double J){
+    // Peak velocity without cruise phase, with and without constant acceleration phase
+    double v_peak = pow(d*d*J/4, 1.0/3.0);
+    if(v_peak*J > A*A)
+        v_peak = A*(-A/J + sqrt(A*A/(J*J) + 4*d/A))/2;
+    if(v_peak > V)
+        v_peak = V;
+    const double t_acc = v_peak*J >= A*A ? v_peak/A + A/J : 2*sqrt(v_peak/J);
+    return 2*t_acc + (d - v_peak*t_acc)/v_peak;
+}
+
+const RMLDoubleVector* maxVelocity(const RMLPositionInputParameters& in){return in.MaxVelocityVector;}
+const RMLDoubleVector* maxVelocity(const RMLVelocityInputParameters& in){return 0;}
+
+/** Result of a motion*/
+struct Motion{
+    unsigned int n_dof;
+    unsigned int cycles;
+    std::vector<double> execution_times;        /** Time until each DOF reaches its target state, as planned in the first cycle*/
+    bool limits_kept;
+    Motion(unsigned int n) : n_dof(n), cycles(0), execution_times(n, 0), limits_kept(true){}
+};
+
+/** Run the backend until the final state is reached, feed back the new state like RMLTask::stepOTG() and check the limits in each cycle*/
+template<class Mode> int run(SCurveBackend& backend, typename Mode::InputParameters& in, typename Mode::OutputParameters& out,
+                             const typename Mode::Flags& flags, Motion& motion){
+    // A DOF that starts above its max. velocity must not get faster than when reducing its acceleration immediately
+    const RMLDoubleVector* max_velocity = maxVelocity(in);
+    std::vector<double> velocity_bound(motion.n_dof, base::infinity<double>());
+    for(unsigned int i = 0; max_velocity && i < motion.n_dof; i++){
+        const double a = in.CurrentAccelerationVector->VecData[i];
+        velocity_bound[i] = std::max(max_velocity->VecData[i], fabs(in.CurrentVelocityVector->VecData[i] + a*fabs(a)/(2*in.MaxJerkVector->VecData[i])));
+    }
+
+    int result = RML_WORKING;
+    for(motion.cycles = 0; motion.cycles < MAX_CYCLES && result == RML_WORKING; motion.cycles++){
+        result = Mode::run(backend, in, out, flags);
+        for(unsigned int i = 0; i < motion.n_dof; i++){
+            const double a_prev = in.CurrentAccelerationVector->VecData[i];
+            const double v = out.NewVelocityVector->VecData[i];
+            const double a = out.NewAccelerationVector->VecData[i];
+            const double J = in.MaxJerkVector->VecData[i];
+            if(fabs(a) > in.MaxAccelerationVector->VecData[i] + EPS || fabs(a - a_prev) > J*CYCLE_TIME*(1 + EPS) || fabs(v) > velocity_bound[i] + EPS)
+                motion.limits_kept = false;
+            if(motion.cycles == 0)
+                motion.execution_times[i] = out.ExecutionTimes->VecData[i];
+        }
+        *in.CurrentPositionVector     = *out.NewPositionVector;
+        *in.CurrentVelocityVector     = *out.NewVelocityVector;
+        *in.CurrentAccelerationVector = *out.NewAccelerationVector;
+    }
+    return result;
+}
+
+template<class Parameters> void setLimits(Parameters& in, const unsigned int i, const double A, const double J){
+    in.SelectionVector->VecData[i]           = true;
+    in.MaxAccelerationVector->VecData[i]     = A;
+    in.MaxJerkVector->VecData[i]             = J;
+    in.CurrentPositionVector->VecData[i]     = 0;
+    in.CurrentVelocityVector->VecData[i]     = 0;
+    in.CurrentAccelerationVector->VecData[i] = 0;
+    in.TargetVelocityVector->VecData[i]      = 0;
+}
+
+}
+
+TEST(SCurveBackendTest, restToRestMotionsAreTimeOptimal){
+    // Distances cover motions without constant acceleration phase, without cruise phase and with all seven phases
+    const double distances[] = {0.001, 0.02, 0.3, 1.0, 5.0};
+    for(double d : distances){
+        SCurveBackend backend(1, CYCLE_TIME);
+        RMLPositionInputParameters in(1);
+        RMLPositionOutputParameters out(1);
+        RMLPositionFlags flags;
+        setLimits(in, 0, 2.0, 20.0);
+        in.MaxVelocityVector->VecData[0] = 1.0;
+        in.TargetPositionVector->VecData[0] = -d;
+
+        ASSERT_EQ(RML_WORKING, backend.RMLPosition(in, &out, flags));
+        EXPECT_NEAR(restToRestTime(d, 1.0, 2.0, 20.0), out.ExecutionTimes->VecData[0], 1e-9) << "distance " << d;
+    }
+}
+
+TEST(SCurveBackendTest, randomMotionsReachTheTargetStateWithinTheLimits){
+    const unsigned int n_dof = 6;
+    srand(3);
+    for(unsigned int m = 0; m < 300; m++){
+        SCurveBackend backend(n_dof, CYCLE_TIME);
+        RMLPositionInputParameters in(n_dof);
+        RMLPositionOutputParameters out(n_dof);
+        RMLPositionFlags flags;
+        flags.SynchronizationBehavior = m % 2 ? RMLFlags::ONLY_TIME_SYNCHRONIZATION : RMLFlags::NO_SYNCHRONIZATION;
+        for(unsigned int i = 0; i < n_dof; i++){
+            const double V = uniform(0.5, 2.0), A = uniform(1.0, 5.0), J = uniform(5.0, 500.0);
+            setLimits(in, i, A, J);
+            in.MaxVelocityVector->VecData[i]         = V;
+            in.CurrentPositionVector->VecData[i]     = uniform(-1.0, 1.0);
+            in.CurrentVelocityVector->VecData[i]     = uniform(-V, V);
+            in.CurrentAccelerationVector->VecData[i] = uniform(-A, A);
+            in.TargetPositionVector->VecData[i]      = uniform(-1.0, 1.0);
+            in.TargetVelocityVector->VecData[i]      = m % 3 ? uniform(-V, V) : 0;
+        }
+        RMLPositionInputParameters target(in);
+
+        Motion motion(n_dof);
+        ASSERT_EQ(RML_FINAL_STATE_REACHED, run<PositionMode>(backend, in, out, flags, motion)) << "motion " << m;
+        EXPECT_TRUE(motion.limits_kept) << "motion " << m;
+        for(unsigned int i = 0; i < n_dof; i++){
+            // The DOF moves on with the target velocity after the final state has been reached
+            const double p_final = target.TargetPositionVector->VecData[i] +
+                                   target.TargetVelocityVector->VecData[i]*(motion.cycles*CYCLE_TIME - motion.execution_times[i]);
+            EXPECT_NEAR(p_final, out.NewPositionVector->VecData[i], 1e-6) << "motion " << m << ", DOF " << i;
+            EXPECT_NEAR(target.TargetVelocityVector->VecData[i], out.NewVelocityVector->VecData[i], 1e-9);
+            EXPECT_NEAR(0, out.NewAccelerationVector->VecData[i], 1e-9);
+        }
+    }
+}
+
+TEST(SCurveBackendTest, velocityChangesReachTheTargetVelocityWithinTheLimits){
+    const unsigned int n_dof = 6;
+    srand(4);
+    for(unsigned int m = 0; m < 300; m++){
+        SCurveBackend backend(n_dof, CYCLE_TIME);
+        RMLVelocityInputParameters in(n_dof);
+        RMLVelocityOutputParameters out(n_dof);
+        RMLVelocityFlags flags;
+        flags.SynchronizationBehavior = RMLFlags::ONLY_TIME_SYNCHRONIZATION;
+        for(unsigned int i = 0; i < n_dof; i++){
+            const double A = uniform(1.0, 5.0), J = uniform(5.0, 500.0);
+            setLimits(in, i, A, J);
+            in.CurrentVelocityVector->VecData[i]     = uniform(-1.0, 1.0);
+            in.CurrentAccelerationVector->VecData[i] = uniform(-A, A);
+            in.TargetVelocityVector->VecData[i]      = uniform(-1.0, 1.0);
+        }
+        RMLVelocityInputParameters target(in);
+
+        Motion motion(n_dof);
+        ASSERT_EQ(RML_FINAL_STATE_REACHED, run<VelocityMode>(backend, in, out, flags, motion)) << "motion " << m;
+        EXPECT_TRUE(motion.limits_kept) << "motion " << m;
+        for(unsigned int i = 0; i < n_dof; i++){
+            EXPECT_NEAR(target.TargetVelocityVector->VecData[i], out.NewVelocityVector->VecData[i], 1e-9);
+            EXPECT_NEAR(0, out.NewAccelerationVector->VecData[i], 1e-9);
+        }
+    }
+}
+
+TEST(SCurveBackendTest, timeSynchronizationStretchesTheFasterDofs){
+    const unsigned int n_dof = 3;
+    SCurveBackend backend(n_dof, CYCLE_TIME);
+    RMLPositionInputParameters in(n_dof);
+    RMLPositionOutputParameters out(n_dof);
+    RMLPositionFlags flags;
+    flags.SynchronizationBehavior = RMLFlags::ONLY_TIME_SYNCHRONIZATION;
+    const double targets[] = {1.0, -0.2, 0.05};
+    for(unsigned int i = 0; i < n_dof; i++){
+        setLimits(in, i, 2.0 + i, 20.0);
+        in.MaxVelocityVector->VecData[i] = 1.0;
+        in.TargetPositionVector->VecData[i] = targets[i];
+    }
+
+    Motion motion(n_dof);
+    ASSERT_EQ(RML_FINAL_STATE_REACHED, run<PositionMode>(backend, in, out, flags, motion));
+    EXPECT_TRUE(motion.limits_kept);
+    const double slowest = restToRestTime(1.0, 1.0, 2.0, 20.0);
+    for(unsigned int i = 0; i < n_dof; i++){
+        EXPECT_NEAR(slowest, motion.execution_times[i], 1e-9) << "DOF " << i;
+        EXPECT_NEAR(targets[i], out.NewPositionVector->VecData[i], 1e-9);
+    }
+}
+
+TEST(SCurveBackendTest, stretchWithinAnInoperativeTimeIntervalIsPostponed){
+    // Braking to a lower peak velocity first travels too far for durations between about 0.575 and 0.668 s
+    SCurveBackend backend(1, CYCLE_TIME);
+    RMLPositionInputParameters in(1);
+    RMLPositionOutputParameters out(1);
+    RMLPositionFlags flags;
+    flags.SynchronizationBehavior = RMLFlags::ONLY_TIME_SYNCHRONIZATION;
+    setLimits(in, 0, 3.46975, 20.917);
+    in.MaxVelocityVector->VecData[0] = 1.47038;
+    in.CurrentPositionVector->VecData[0] = 0.474827691;
+    in.CurrentVelocityVector->VecData[0] = 1.16872469;
+    in.TargetPositionVector->VecData[0] = 0.848937209;
+    in.MinimumSynchronizationTime = 0.62;
+
+    int result = RML_WORKING;
+    for(unsigned int c = 0; c < MAX_CYCLES && result == RML_WORKING; c++){
+        // The DOF does not overshoot and jump back to the target at the end of the motion
+        result = backend.RMLPosition(in, &out, flags);
+        if(c == 0)
+            EXPECT_GT(out.SynchronizationTime, 0.66);
+        EXPECT_LE(fabs(out.NewPositionVector->VecData[0] - in.CurrentPositionVector->VecData[0]), 1.47038*CYCLE_TIME) << "cycle " << c;
+        *in.CurrentPositionVector     = *out.NewPositionVector;
+        *in.CurrentVelocityVector     = *out.NewVelocityVector;
+        *in.CurrentAccelerationVector = *out.NewAccelerationVector;
+    }
+    ASSERT_EQ(RML_FINAL_STATE_REACHED, result);
+    EXPECT_NEAR(0.848937209, out.NewPositionVector->VecData[0], 1e-9);
+    EXPECT_NEAR(0, out.NewVelocityVector->VecData[0], 1e-9);
+}
+
+TEST(SCurveBackendTest, collinearMotionsArePhaseSynchronized){
+    const unsigned int n_dof = 3;
+    SCurveBackend backend(n_dof, CYCLE_TIME);
+    RMLPositionInputParameters in(n_dof);
+    RMLPositionOutputParameters out(n_dof);
+    RMLPositionFlags flags;
+    flags.SynchronizationBehavior = RMLFlags::ONLY_PHASE_SYNCHRONIZATION;
+    const double start[] = {0.1, 0.2, -0.3}, direction[] = {1.0, -0.5, 0.25};
+    for(unsigned int i = 0; i < n_dof; i++){
+        setLimits(in, i, 2.0, 20.0 + i);
+        in.MaxVelocityVector->VecData[i] = 1.0;
+        in.CurrentPositionVector->VecData[i] = start[i];
+        in.CurrentVelocityVector->VecData[i] = 0.3*direction[i];
+        in.TargetPositionVector->VecData[i] = start[i] + direction[i];
+    }
+
+    for(unsigned int c = 0; c < MAX_CYCLES; c++){
+        const int result = backend.RMLPosition(in, &out, flags);
+        ASSERT_GE(result, 0);
+        EXPECT_TRUE(out.TrajectoryIsPhaseSynchronized);
+        // All DOF are on the straight line from start to target
+        const double s = (out.NewPositionVector->VecData[0] - start[0])/direction[0];
+        for(unsigned int i = 1; i < n_dof; i++)
+            EXPECT_NEAR(start[i] + s*direction[i], out.NewPositionVector->VecData[i], 1e-9);
+        *in.CurrentPositionVector     = *out.NewPositionVector;
+        *in.CurrentVelocityVector     = *out.NewVelocityVector;
+        *in.CurrentAccelerationVector = *out.NewAccelerationVector;
+        if(result == RML_FINAL_STATE_REACHED)
+            break;
+    }
+    for(unsigned int i = 0; i < n_dof; i++)
+        EXPECT_NEAR(start[i] + direction[i], out.NewPositionVector->VecData[i], 1e-9);
+
+    // Velocity and distance to the target are not collinear: Phase synchronization is not possible
+    in.CurrentVelocityVector->VecData[0] = 0.5;
+    in.TargetPositionVector->VecData[1] = 0;
+    EXPECT_EQ(RML_ERROR_NO_PHASE_SYNCHRONIZATION, backend.RMLPosition(in, &out, flags));
+    flags.SynchronizationBehavior = RMLFlags::PHASE_SYNCHRONIZATION_IF_POSSIBLE;
+    EXPECT_EQ(RML_WORKING, backend.RMLPosition(in, &out, flags));
+    EXPECT_FALSE(out.TrajectoryIsPhaseSynchronized);
+}
+
+TEST(SCurveBackendTest, invalidTargetVelocityIsRejected){
+    SCurveBackend backend(1, CYCLE_TIME);
+    RMLPositionInputParameters in(1);
+    RMLPositionOutputParameters out(1);
+    setLimits(in, 0, 2.0, 20.0);
+    in.MaxVelocityVector->VecData[0] = 1.0;
+    in.TargetPositionVector->VecData[0] = 1.0;
+    in.TargetVelocityVector->VecData[0] = 1.5;
+    EXPECT_EQ(RML_ERROR_INVALID_INPUT_VALUES, backend.RMLPosition(in, &out, RMLPositionFlags()));
+}
+
+TEST(SCurveBackendTest, velocityBasedMotionStopsAtThePositionLimits){
+    SCurveBackend backend(1, CYCLE_TIME);
+    backend.setPositionLimits(std::vector<double>(1, -0.5), std::vector<double>(1, 0.5), POSITIONAL_LIMITS_ACTIVELY_PREVENT);
+    RMLVelocityInputParameters in(1);
+    RMLVelocityOutputParameters out(1);
+    setLimits(in, 0, 2.0, 20.0);
+    in.TargetVelocityVector->VecData[0] = 1.0;
+
+    double max_position = 0;
+    for(unsigned int c = 0; c < 3000; c++){
+        ASSERT_GE(backend.RMLVelocity(in, &out, RMLVelocityFlags()), 0);
+        max_position = std::max(max_position, out.NewPositionVector->VecData[0]);
+        *in.CurrentPositionVector     = *out.NewPositionVector;
+        *in.CurrentVelocityVector     = *out.NewVelocityVector;
+        *in.CurrentAccelerationVector = *out.NewAccelerationVector;
+    }
+    EXPECT_LE(max_position, 0.5);
+    EXPECT_NEAR(0.5, out.NewPositionVector->VecData[0], 0.01);
+    EXPECT_NEAR(0, out.NewVelocityVector->VecData[0], 1e-9);
+
+    // Moving away from the limit is possible
+    in.TargetVelocityVector->VecData[0] = -1.0;
+    for(unsigned int c = 0; c < 100; c++){
+        ASSERT_GE(backend.RMLVelocity(in, &out, RMLVelocityFlags()), 0);
+        *in.CurrentPositionVector     = *out.NewPositionVector;
+        *in.CurrentVelocityVector     = *out.NewVelocityVector;
+        *in.CurrentAccelerationVector = *out.NewAccelerationVector;
+    }
+    EXPECT_LT(out.NewVelocityVector->VecData[0], 0);
+}
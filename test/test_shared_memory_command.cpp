@@ -0,0 +1,125 @@
+#include <SharedMemoryCommand.hpp>
+#include <base/Float.hpp>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sstream>
+
+using namespace trajectory_generation;
+
+namespace{
+
+/** Unique segment name per test, so that tests do not interfere with each other or with running tasks*/
+std::string segmentName(const std::string& test){
+    std::stringstream ss;
+    ss << "/trajectory_generation_test_" << test << "_" << getpid();
+    return ss.str();
+}
+
+std::vector<std::string> jointNames(){
+    std::vector<std::string> names;
+    names.push_back("joint_1");
+    names.push_back("joint_2");
+    names.push_back("joint_3");
+    return names;
+}
+
+}
+
+TEST(SharedMemoryCommand, writeAndRead){
+    const std::string name = segmentName("write_read");
+    SharedCommandWriter writer;
+    ASSERT_TRUE(writer.open(name, jointNames()));
+
+    SharedCommandReader reader;
+    ASSERT_TRUE(reader.open(name));
+    ASSERT_EQ(3u, reader.size());
+    EXPECT_EQ(jointNames(), reader.names());
+
+    double pos[3], vel[3], acc[3];
+    base::Time time;
+    EXPECT_FALSE(reader.read(pos, vel, acc, time)) << "No command has been written yet";
+
+    const double wpos[3] = {0.1, 0.2, 0.3}, wvel[3] = {1, 2, 3}, wacc[3] = {-1, -2, -3};
+    const base::Time wtime = base::Time::fromMicroseconds(123456789);
+    writer.write(wpos, wvel, wacc, wtime);
+    ASSERT_TRUE(reader.read(pos, vel, acc, time));
+    for(int i = 0; i < 3; i++){
+        EXPECT_EQ(wpos[i], pos[i]);
+        EXPECT_EQ(wvel[i], vel[i]);
+        EXPECT_EQ(wacc[i], acc[i]);
+    }
+    EXPECT_EQ(wtime, time);
+    EXPECT_FALSE(reader.read(pos, vel, acc, time)) << "The same command must not be returned twice";
+}
+
+TEST(SharedMemoryCommand, refuseSegmentOfOtherWriter){
+    const std::string name = segmentName("conflict");
+    SharedCommandWriter writer;
+    ASSERT_TRUE(writer.open(name, jointNames()));
+
+    // A second writer must neither take over nor remove the segment of a live writer
+    {
+        SharedCommandWriter other;
+        EXPECT_FALSE(other.open(name, jointNames()));
+    }
+    SharedCommandReader reader;
+    ASSERT_TRUE(reader.open(name));
+    const double pos[3] = {1, 2, 3}, vel[3] = {0, 0, 0}, acc[3] = {0, 0, 0};
+    writer.write(pos, vel, acc, base::Time::fromSeconds(1));
+    double rpos[3], rvel[3], racc[3];
+    base::Time time;
+    EXPECT_TRUE(reader.read(rpos, rvel, racc, time));
+}
+
+TEST(SharedMemoryCommand, refuseForeignSegment){
+    // Segments that have not been created by a writer are never removed
+    const std::string name = segmentName("foreign");
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(0, ftruncate(fd, 4096));
+    close(fd);
+
+    SharedCommandWriter writer;
+    EXPECT_FALSE(writer.open(name, jointNames()));
+    fd = shm_open(name.c_str(), O_RDONLY, 0);
+    EXPECT_GE(fd, 0);
+    close(fd);
+    shm_unlink(name.c_str());
+}
+
+TEST(SharedMemoryCommand, replaceSegmentOfCrashedWriter){
+    const std::string name = segmentName("crashed");
+    // Child process creates the segment and exits without removing it
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if(pid == 0){
+        SharedCommandWriter writer;
+        _exit(writer.open(name, jointNames()) ? 0 : 1);
+    }
+    int status;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_EQ(0, WEXITSTATUS(status));
+
+    std::vector<std::string> names = jointNames();
+    names.push_back("joint_4");
+    SharedCommandWriter writer;
+    ASSERT_TRUE(writer.open(name, names));
+    SharedCommandReader reader;
+    ASSERT_TRUE(reader.open(name));
+    EXPECT_EQ(4u, reader.size());
+}
+
+TEST(SharedMemoryCommand, reopenAfterClose){
+    const std::string name = segmentName("reopen");
+    SharedCommandWriter writer;
+    ASSERT_TRUE(writer.open(name, jointNames()));
+    writer.close();
+
+    SharedCommandReader reader;
+    EXPECT_FALSE(reader.open(name)) << "close() has to remove the segment";
+    ASSERT_TRUE(writer.open(name, jointNames()));
+    EXPECT_TRUE(reader.open(name));
+}
@@ -0,0 +1,205 @@
+#include <SyncGroup.hpp>
+#include <SCurveBackend.hpp>
+#include <gtest/gtest.h>
+
+using namespace trajectory_generation;
+
+namespace{
+
+const double CYCLE_TIME = 0.01;
+const unsigned int MAX_CYCLES = 1000;
+
+TEST(SyncGroupTest, joinAndLeave){
+    int slots[SyncGroup::MAX_MEMBERS];
+    SyncGroup* group = SyncGroup::join("join_and_leave", slots[0]);
+    ASSERT_TRUE(group);
+    EXPECT_EQ("join_and_leave", group->getName());
+    for(int i = 1; i < SyncGroup::MAX_MEMBERS; i++)
+        EXPECT_EQ(group, SyncGroup::join("join_and_leave", slots[i]));
+    for(int i = 0; i < SyncGroup::MAX_MEMBERS; i++)
+        EXPECT_EQ(i, slots[i]);
+
+    // The group is full, a free slot is reused
+    int slot;
+    EXPECT_FALSE(SyncGroup::join("join_and_leave", slot));
+    EXPECT_EQ(-1, slot);
+    SyncGroup::leave(group, 3);
+    EXPECT_EQ(group, SyncGroup::join("join_and_leave", slot));
+    EXPECT_EQ(3, slot);
+
+    // Leaving twice or with an invalid slot has no effect
+    SyncGroup::leave(group, 3);
+    SyncGroup::leave(group, 3);
+    SyncGroup::leave(group, -1);
+    SyncGroup::leave(group, SyncGroup::MAX_MEMBERS);
+    for(int i = 0; i < SyncGroup::MAX_MEMBERS; i++){
+        if(i != 3)
+            SyncGroup::leave(group, i);
+    }
+
+    // Other groups are independent
+    SyncGroupMember member;
+    EXPECT_FALSE(member.isJoined());
+    EXPECT_TRUE(member.join("join_and_leave_other"));
+    EXPECT_TRUE(member.isJoined());
+    member.leave();
+    EXPECT_FALSE(member.isJoined());
+}
+
+TEST(SyncGroupTest, latestArrivalIgnoresPastArrivals){
+    int slot_a, slot_b;
+    SyncGroup* group = SyncGroup::join("latest_arrival", slot_a);
+    ASSERT_TRUE(group);
+    ASSERT_EQ(group, SyncGroup::join("latest_arrival", slot_b));
+
+    const base::Time now = base::Time::fromSeconds(100);
+    EXPECT_TRUE(group->latestArrival(now).isNull());
+    group->publish(slot_a, now + base::Time::fromSeconds(1));
+    group->publish(slot_b, now + base::Time::fromSeconds(2));
+    EXPECT_EQ(now + base::Time::fromSeconds(2), group->latestArrival(now));
+    EXPECT_EQ(now + base::Time::fromSeconds(2), group->latestArrival(now + base::Time::fromSeconds(1.5)));
+    EXPECT_TRUE(group->latestArrival(now + base::Time::fromSeconds(2)).isNull());
+
+    // The arrival time of a member that leaves is discarded
+    SyncGroup::leave(group, slot_b);
+    EXPECT_EQ(now + base::Time::fromSeconds(1), group->latestArrival(now));
+    SyncGroup::leave(group, slot_a);
+}
+
+/** One member of a sync group with a single DOF, cycled like RMLTask::runSingleCycle() with RMLTask::synchronizeWithGroup()*/
+struct Member{
+    SCurveBackend backend, sync_backend;
+    RMLPositionInputParameters in;
+    RMLPositionOutputParameters out, sync_output;
+    RMLPositionFlags flags;
+    SyncGroupMember sync;
+    bool target_changed;
+    int result;
+    base::Time arrival;     /** Time at which the motion has ended, null while it is running*/
+
+    Member(const double max_velocity) : backend(1, CYCLE_TIME), sync_backend(1, CYCLE_TIME), in(1), out(1), sync_output(1),
+                                        target_changed(false), result(RML_NOT_INITIALIZED){
+        in.SelectionVector->VecData[0] = true;
+        in.MaxVelocityVector->VecData[0] = max_velocity;
+        in.MaxAccelerationVector->VecData[0] = 2.0;
+        in.MaxJerkVector->VecData[0] = 20.0;
+        in.CurrentPositionVector->VecData[0] = 0;
+        in.CurrentVelocityVector->VecData[0] = 0;
+        in.CurrentAccelerationVector->VecData[0] = 0;
+        in.TargetVelocityVector->VecData[0] = 0;
+    }
+
+    void setTarget(const double position){
+        in.TargetPositionVector->VecData[0] = position;
+        target_changed = true;
+        arrival = base::Time();
+    }
+
+    void cycle(const base::Time& now){
+        if(target_changed){
+            in.MinimumSynchronizationTime = 0;
+            ASSERT_GE(sync_backend.RMLPosition(in, &sync_output, flags), 0);
+            sync.publish(now, sync_output.SynchronizationTime);
+        }
+        sync.update(now, !target_changed && result == RML_FINAL_STATE_REACHED, CYCLE_TIME / 2, in.MinimumSynchronizationTime);
+        target_changed = false;
+        result = backend.RMLPosition(in, &out, flags);
+        ASSERT_GE(result, 0);
+        *in.CurrentPositionVector = *out.NewPositionVector;
+        *in.CurrentVelocityVector = *out.NewVelocityVector;
+        *in.CurrentAccelerationVector = *out.NewAccelerationVector;
+        // The motion ends within this cycle, at the remaining execution time
+        if(result == RML_FINAL_STATE_REACHED && arrival.isNull())
+            arrival = now + base::Time::fromSeconds(out.SynchronizationTime);
+    }
+};
+
+/** Cycle both members until both have reached their targets. Returns the time after the last cycle*/
+base::Time runUntilArrival(Member& fast, Member& slow, base::Time now){
+    for(unsigned int k = 0; k < MAX_CYCLES && (fast.arrival.isNull() || slow.arrival.isNull()); k++){
+        fast.cycle(now);
+        slow.cycle(now);
+        now = now + base::Time::fromSeconds(CYCLE_TIME);
+    }
+    EXPECT_FALSE(fast.arrival.isNull());
+    EXPECT_FALSE(slow.arrival.isNull());
+    return now;
+}
+
+/** Execution time of a motion of member over the given distance without synchronization*/
+double unsynchronizedTime(const double max_velocity, const double distance){
+    Member member(max_velocity);
+    member.setTarget(distance);
+    member.in.MinimumSynchronizationTime = 0;
+    EXPECT_GE(member.sync_backend.RMLPosition(member.in, &member.sync_output, member.flags), 0);
+    return member.sync_output.SynchronizationTime;
+}
+
+TEST(SyncGroupTest, membersWithDifferentExecutionTimesArriveTogether){
+    // The slow member is cycled after the fast one, so the fast member only sees its arrival time in the next cycle
+    Member fast(2.0), slow(0.5);
+    ASSERT_TRUE(fast.sync.join("arrive_together"));
+    ASSERT_TRUE(slow.sync.join("arrive_together"));
+    const double fast_time = unsynchronizedTime(2.0, 1.0), slow_time = unsynchronizedTime(0.5, 1.0);
+    ASSERT_GT(slow_time - fast_time, 0.5);
+
+    base::Time now = base::Time::fromSeconds(1000);
+    const base::Time start = now;
+    fast.setTarget(1.0);
+    slow.setTarget(1.0);
+    now = runUntilArrival(fast, slow, now);
+    EXPECT_LE(fabs((fast.arrival - slow.arrival).toSeconds()), CYCLE_TIME / 2);
+    EXPECT_NEAR(slow_time, (slow.arrival - start).toSeconds(), CYCLE_TIME);
+    EXPECT_NEAR(1.0, fast.out.NewPositionVector->VecData[0], 1e-9);
+    EXPECT_NEAR(1.0, slow.out.NewPositionVector->VecData[0], 1e-9);
+
+    // Targets set in different cycles: The member that starts later determines the arrival
+    fast.setTarget(0.0);
+    fast.cycle(now);
+    slow.cycle(now);
+    now = now + base::Time::fromSeconds(CYCLE_TIME);
+    const base::Time slow_start = now;
+    slow.setTarget(0.0);
+    now = runUntilArrival(fast, slow, now);
+    EXPECT_LE(fabs((fast.arrival - slow.arrival).toSeconds()), CYCLE_TIME / 2);
+    EXPECT_NEAR(slow_time, (slow.arrival - slow_start).toSeconds(), CYCLE_TIME);
+}
+
+TEST(SyncGroupTest, stretchIsDroppedOnceTheTargetsAreReached){
+    Member fast(2.0), slow(0.5);
+    ASSERT_TRUE(fast.sync.join("stretch_dropped"));
+    ASSERT_TRUE(slow.sync.join("stretch_dropped"));
+    base::Time now = base::Time::fromSeconds(1000);
+    fast.setTarget(1.0);
+    slow.setTarget(1.0);
+    for(unsigned int k = 0; k < 10; k++){
+        fast.cycle(now);
+        slow.cycle(now);
+        now = now + base::Time::fromSeconds(CYCLE_TIME);
+    }
+    EXPECT_GT(fast.in.MinimumSynchronizationTime, 0);
+    EXPECT_EQ(0, slow.in.MinimumSynchronizationTime);
+
+    // Once the group target has been reached, the stretch is dropped
+    now = runUntilArrival(fast, slow, now);
+    EXPECT_EQ(0, fast.in.MinimumSynchronizationTime);
+    fast.cycle(now);
+    slow.cycle(now);
+    now = now + base::Time::fromSeconds(CYCLE_TIME);
+    EXPECT_EQ(0, fast.in.MinimumSynchronizationTime);
+    EXPECT_EQ(0, slow.in.MinimumSynchronizationTime);
+
+    // A new motion of the fast member alone is not stretched
+    const double fast_time = unsynchronizedTime(2.0, 1.0);
+    const base::Time start = now;
+    fast.setTarget(0.0);
+    for(unsigned int k = 0; k < MAX_CYCLES && fast.arrival.isNull(); k++){
+        fast.cycle(now);
+        slow.cycle(now);
+        now = now + base::Time::fromSeconds(CYCLE_TIME);
+    }
+    EXPECT_EQ(0, fast.in.MinimumSynchronizationTime);
+    EXPECT_NEAR(fast_time, (fast.arrival - start).toSeconds(), CYCLE_TIME);
+}
+
+}
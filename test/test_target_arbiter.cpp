@@ -0,0 +1,96 @@
+#include <TargetArbiter.hpp>
+#include <gtest/gtest.h>
+
+using namespace trajectory_generation;
+
+namespace{
+
+const double TIMEOUT = 0.1;
+
+class TargetArbiterTest : public testing::Test{
+protected:
+    TargetArbitrationConfig config;
+    TargetArbiter arbiter;
+    base::Time start;
+
+    /** constrained_target has the higher priority, e.g. teleoperation overriding an autonomous motion on target*/
+    TargetArbiterTest() : start(base::Time::fromSeconds(100)){
+        config.enabled = true;
+        config.target_priority = 0;
+        config.constrained_target_priority = 1;
+        config.target_timeout = config.constrained_target_timeout = TIMEOUT;
+    }
+
+    base::Time at(const double seconds) const {return start + base::Time::fromSeconds(seconds);}
+};
+
+TEST_F(TargetArbiterTest, timeoutsMustBeFiniteIfEnabled){
+    EXPECT_TRUE(arbiter.configure(config));
+    TargetArbitrationConfig invalid = config;
+    invalid.target_timeout = base::infinity<double>();
+    EXPECT_FALSE(arbiter.configure(invalid));
+    invalid = config;
+    invalid.constrained_target_timeout = base::NaN<double>();
+    EXPECT_FALSE(arbiter.configure(invalid));
+    invalid.constrained_target_timeout = 0;
+    EXPECT_FALSE(arbiter.configure(invalid));
+    invalid.enabled = false;
+    EXPECT_TRUE(arbiter.configure(invalid));
+    EXPECT_FALSE(arbiter.isEnabled());
+}
+
+TEST_F(TargetArbiterTest, higherPriorityOverridesAndHandsBack){
+    ASSERT_TRUE(arbiter.configure(config));
+    EXPECT_EQ(TARGET_SOURCE_NONE, arbiter.select(at(0)));
+
+    arbiter.addSample(TARGET_SOURCE_TARGET, at(0));
+    EXPECT_EQ(TARGET_SOURCE_TARGET, arbiter.select(at(0)));
+
+    arbiter.addSample(TARGET_SOURCE_TARGET, at(0.05));
+    arbiter.addSample(TARGET_SOURCE_CONSTRAINED_TARGET, at(0.05));
+    EXPECT_EQ(TARGET_SOURCE_CONSTRAINED_TARGET, arbiter.select(at(0.05)));
+    EXPECT_EQ(TARGET_SOURCE_TARGET, arbiter.getStatus().previous_source);
+
+    // The lower priority source keeps publishing and takes over once the higher priority one times out
+    arbiter.addSample(TARGET_SOURCE_TARGET, at(0.2));
+    EXPECT_EQ(TARGET_SOURCE_TARGET, arbiter.select(at(0.2)));
+    EXPECT_EQ(TARGET_SOURCE_CONSTRAINED_TARGET, arbiter.getStatus().previous_source);
+    EXPECT_EQ(3u, arbiter.getStatus().handovers);
+}
+
+/** A handover never resumes a sample that is older than the timeout of its source*/
+TEST_F(TargetArbiterTest, outdatedSourceIsNotResumed){
+    ASSERT_TRUE(arbiter.configure(config));
+    arbiter.addSample(TARGET_SOURCE_TARGET, at(0));
+    arbiter.addSample(TARGET_SOURCE_CONSTRAINED_TARGET, at(0));
+    EXPECT_EQ(TARGET_SOURCE_CONSTRAINED_TARGET, arbiter.select(at(0)));
+
+    arbiter.addSample(TARGET_SOURCE_CONSTRAINED_TARGET, at(0.5));
+    EXPECT_EQ(TARGET_SOURCE_CONSTRAINED_TARGET, arbiter.select(at(0.5)));
+    EXPECT_EQ(TARGET_SOURCE_NONE, arbiter.select(at(0.5 + 2 * TIMEOUT)));
+    EXPECT_EQ(TARGET_SOURCE_CONSTRAINED_TARGET, arbiter.getStatus().previous_source);
+}
+
+TEST_F(TargetArbiterTest, equalPriorityKeepsActiveSource){
+    config.target_priority = config.constrained_target_priority;
+    ASSERT_TRUE(arbiter.configure(config));
+    arbiter.addSample(TARGET_SOURCE_CONSTRAINED_TARGET, at(0));
+    EXPECT_EQ(TARGET_SOURCE_CONSTRAINED_TARGET, arbiter.select(at(0)));
+    arbiter.addSample(TARGET_SOURCE_TARGET, at(0.05));
+    arbiter.addSample(TARGET_SOURCE_CONSTRAINED_TARGET, at(0.05));
+    EXPECT_EQ(TARGET_SOURCE_CONSTRAINED_TARGET, arbiter.select(at(0.05)));
+    EXPECT_EQ(1u, arbiter.getStatus().handovers);
+}
+
+/** configure() resets the state, so that a restarted task does not resume the samples of the previous run*/
+TEST_F(TargetArbiterTest, configureResetsState){
+    ASSERT_TRUE(arbiter.configure(config));
+    arbiter.addSample(TARGET_SOURCE_TARGET, at(0));
+    EXPECT_EQ(TARGET_SOURCE_TARGET, arbiter.select(at(0)));
+    ASSERT_TRUE(arbiter.configure(config));
+    EXPECT_EQ(TARGET_SOURCE_NONE, arbiter.getStatus().active_source);
+    EXPECT_EQ(0u, arbiter.getStatus().handovers);
+    EXPECT_EQ(TARGET_SOURCE_NONE, arbiter.select(at(0)));
+}
+
+}
@@ -0,0 +1,159 @@
+#include <TrajectoryCache.hpp>
+#include <gtest/gtest.h>
+#include <string.h>
+
+using namespace trajectory_generation;
+
+namespace{
+
+const unsigned int N_DOF = 2;
+const double CYCLE_TIME = 0.01;
+const unsigned int MAX_CYCLES = 10000;
+
+/** Sampled output of a motion*/
+struct Motion{
+    std::vector<double> positions;
+    std::vector<double> velocities;
+    std::vector<int> results;
+};
+
+class TrajectoryCacheTest : public testing::Test{
+protected:
+    TrajectoryCache* cache;
+    RMLPositionInputParameters in;
+    RMLPositionOutputParameters out;
+    RMLPositionFlags flags;
+
+    TrajectoryCacheTest() : cache(0), in(N_DOF), out(N_DOF){
+        for(unsigned int i = 0; i < N_DOF; i++){
+            in.SelectionVector->VecData[i]           = true;
+            in.MaxVelocityVector->VecData[i]         = 1.0;
+            in.MaxAccelerationVector->VecData[i]     = 2.0;
+            in.MaxJerkVector->VecData[i]             = 10.0;
+            in.CurrentPositionVector->VecData[i]     = 0;
+            in.CurrentVelocityVector->VecData[i]     = 0;
+            in.CurrentAccelerationVector->VecData[i] = 0;
+            in.TargetVelocityVector->VecData[i]      = 0;
+        }
+    }
+    ~TrajectoryCacheTest(){
+        delete cache;
+    }
+
+    void createCache(const unsigned int size){
+        TrajectoryCacheConfig config;
+        config.size = size;
+        config.max_samples = MAX_CYCLES;
+        config.quantization = 1e-6;
+        cache = new TrajectoryCache(createOTGBackend(OTG_BACKEND_SCURVE, N_DOF, CYCLE_TIME), N_DOF, config);
+    }
+
+    /** Run the motion to the given target until the final state is reached (at most max_cycles) and feed back the output*/
+    Motion moveTo(const double target, const unsigned int max_cycles = MAX_CYCLES){
+        Motion motion;
+        for(unsigned int i = 0; i < N_DOF; i++)
+            in.TargetPositionVector->VecData[i] = target * (i + 1);
+        for(unsigned int k = 0; k < max_cycles; k++){
+            const int result = cache->RMLPosition(in, &out, flags);
+            motion.results.push_back(result);
+            for(unsigned int i = 0; i < N_DOF; i++){
+                motion.positions.push_back(out.NewPositionVector->VecData[i]);
+                motion.velocities.push_back(out.NewVelocityVector->VecData[i]);
+            }
+            *in.CurrentPositionVector     = *out.NewPositionVector;
+            *in.CurrentVelocityVector     = *out.NewVelocityVector;
+            *in.CurrentAccelerationVector = *out.NewAccelerationVector;
+            if(result != RML_WORKING)
+                break;
+        }
+        return motion;
+    }
+
+    /** Run the motion from the given position (at rest) to the given target*/
+    Motion moveFrom(const double start, const double target){
+        for(unsigned int i = 0; i < N_DOF; i++){
+            in.CurrentPositionVector->VecData[i]     = start;
+            in.CurrentVelocityVector->VecData[i]     = 0;
+            in.CurrentAccelerationVector->VecData[i] = 0;
+        }
+        return moveTo(target);
+    }
+};
+
+}
+
+TEST_F(TrajectoryCacheTest, playbackMatchesComputation){
+    createCache(4);
+    const Motion computed = moveTo(1.0);
+    ASSERT_EQ(RML_FINAL_STATE_REACHED, computed.results.back());
+    moveTo(0.0);
+    EXPECT_EQ(0u, cache->getStats().hits);
+    EXPECT_EQ(2u, cache->getStats().entries);
+
+    // Same motion from exactly the same start state: Played back without any deviation
+    const Motion played = moveTo(1.0);
+    EXPECT_EQ(1u, cache->getStats().hits);
+    EXPECT_EQ(computed.results, played.results);
+    EXPECT_EQ(computed.positions, played.positions);
+    EXPECT_EQ(computed.velocities, played.velocities);
+}
+
+TEST_F(TrajectoryCacheTest, startStateMustMatchExactly){
+    createCache(4);
+    moveTo(1.0);
+    moveTo(0.0);
+
+    // A start state that only matches after quantization must not be played back, the first sample would jump
+    in.CurrentPositionVector->VecData[0] += 1e-9;
+    const Motion motion = moveTo(1.0);
+    EXPECT_EQ(0u, cache->getStats().hits);
+    EXPECT_EQ(RML_FINAL_STATE_REACHED, motion.results.back());
+}
+
+TEST_F(TrajectoryCacheTest, constraintsMustMatchExactly){
+    createCache(4);
+    moveTo(1.0);
+    moveTo(0.0);
+
+    // A target that only matches after quantization is played back, the remaining distance is covered by the wrapped backend
+    const Motion played = moveTo(1.0 + 1e-9);
+    EXPECT_EQ(1u, cache->getStats().hits);
+    EXPECT_EQ(RML_FINAL_STATE_REACHED, played.results.back());
+    moveTo(0.0);
+    EXPECT_EQ(2u, cache->getStats().hits);
+
+    // A slightly lower velocity limit must not be played back, the cached trajectory would violate it
+    in.MaxVelocityVector->VecData[0] -= 1e-9;
+    const Motion motion = moveTo(1.0);
+    EXPECT_EQ(2u, cache->getStats().hits);
+    EXPECT_EQ(RML_FINAL_STATE_REACHED, motion.results.back());
+}
+
+TEST_F(TrajectoryCacheTest, interruptedMotionIsNotStored){
+    createCache(4);
+    moveTo(1.0, 10);
+    moveTo(0.0);
+    EXPECT_EQ(1u, cache->getStats().entries) << "Only the completed motion must be stored";
+}
+
+TEST_F(TrajectoryCacheTest, leastRecentlyUsedEntryIsReplaced){
+    createCache(2);
+    moveFrom(0.0, 1.0);
+    moveFrom(0.0, 2.0);
+    moveFrom(0.0, 1.0);
+    EXPECT_EQ(1u, cache->getStats().hits);
+
+    // The motion to 2.0 is the least recently used one now
+    moveFrom(0.0, 3.0);
+    EXPECT_EQ(1u, cache->getStats().evictions);
+    const Motion played = moveFrom(0.0, 1.0);
+    EXPECT_EQ(2u, cache->getStats().hits);
+    EXPECT_EQ(RML_FINAL_STATE_REACHED, played.results.back());
+    const Motion computed = moveFrom(0.0, 2.0);
+    EXPECT_EQ(2u, cache->getStats().hits);
+
+    // The buffers of replaced entries are reused for recording, stored entries must stay intact
+    const Motion replayed = moveFrom(0.0, 2.0);
+    EXPECT_EQ(3u, cache->getStats().hits);
+    EXPECT_EQ(computed.positions, replayed.positions);
+}
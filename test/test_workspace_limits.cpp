@@ -0,0 +1,148 @@
+#include <WorkspaceLimits.hpp>
+#include <gtest/gtest.h>
+
+using namespace trajectory_generation;
+
+namespace{
+
+WorkspaceHalfspace halfspace(const base::Vector3d& normal, const double offset){
+    WorkspaceHalfspace h;
+    h.normal = normal;
+    h.offset = offset;
+    return h;
+}
+
+WorkspaceSphere sphere(const base::Vector3d& center, const double radius, const bool keep_out){
+    WorkspaceSphere s;
+    s.center = center;
+    s.radius = radius;
+    s.keep_out = keep_out;
+    return s;
+}
+
+/** Project p and check that the result is feasible and close to expected*/
+void expectProjection(WorkspaceLimits& limits, const base::Vector3d& p, const base::Vector3d& expected, const double tolerance){
+    base::Vector3d q = p;
+    ASSERT_TRUE(limits.project(q));
+    EXPECT_TRUE(limits.contains(q));
+    EXPECT_LT((q - expected).norm(), tolerance) << "Projected " << p.transpose() << " to " << q.transpose()
+                                               << ", expected " << expected.transpose();
+}
+
+TEST(WorkspaceLimitsTest, invalidConstraintsAreRejected){
+    WorkspaceLimits limits;
+    WorkspaceConstraints constraints;
+    EXPECT_TRUE(limits.configure(constraints));
+    EXPECT_TRUE(limits.empty());
+
+    constraints.halfspaces.push_back(halfspace(base::Vector3d::Zero(), 1.0));
+    EXPECT_FALSE(limits.configure(constraints));
+    constraints.halfspaces[0] = halfspace(base::Vector3d::UnitX(), 1.0);
+    EXPECT_TRUE(limits.configure(constraints));
+    EXPECT_FALSE(limits.empty());
+
+    constraints.spheres.push_back(sphere(base::Vector3d::Zero(), 0.0, false));
+    EXPECT_FALSE(limits.configure(constraints));
+    constraints.spheres[0].radius = 1.0;
+    constraints.tolerance = 0;
+    EXPECT_FALSE(limits.configure(constraints));
+    constraints.tolerance = 1e-6;
+    constraints.max_iterations = 0;
+    EXPECT_FALSE(limits.configure(constraints));
+}
+
+TEST(WorkspaceLimitsTest, singleConstraintIsProjectedInClosedForm){
+    WorkspaceLimits limits;
+    WorkspaceConstraints constraints;
+    // Normals need not be normalized
+    constraints.halfspaces.push_back(halfspace(base::Vector3d(2, 0, 0), 2.0));
+    constraints.spheres.push_back(sphere(base::Vector3d::Zero(), 5.0, false));
+    // A single iteration would not be enough for Dykstra
+    constraints.max_iterations = 1;
+    ASSERT_TRUE(limits.configure(constraints));
+
+    EXPECT_TRUE(limits.contains(base::Vector3d(0.5, 1, 1)));
+    expectProjection(limits, base::Vector3d(0.5, 1, 1), base::Vector3d(0.5, 1, 1), 1e-12);
+    expectProjection(limits, base::Vector3d(3, 1, -1), base::Vector3d(1, 1, -1), 1e-12);
+    expectProjection(limits, base::Vector3d(0, 0, 10), base::Vector3d(0, 0, 5), 1e-12);
+    expectProjection(limits, base::Vector3d(-6, 8, 0), base::Vector3d(-3, 4, 0), 1e-12);
+}
+
+TEST(WorkspaceLimitsTest, intersectingHalfspacesAreProjectedWithDykstra){
+    WorkspaceLimits limits;
+    WorkspaceConstraints constraints;
+    constraints.halfspaces.push_back(halfspace(base::Vector3d::UnitX(), 1.0));
+    constraints.halfspaces.push_back(halfspace(base::Vector3d(-1, 1, 0), 0.0));
+    ASSERT_TRUE(limits.configure(constraints));
+
+    // Both violated: The closest feasible point is on the edge where both intersect
+    expectProjection(limits, base::Vector3d(3, 4, 2), base::Vector3d(1, 1, 2), 1e-5);
+    // Only the second one violated, but its closed-form projection (1.95, 1.95) violates the first one
+    expectProjection(limits, base::Vector3d(0.9, 3, 0), base::Vector3d(1, 1, 0), 1e-5);
+}
+
+TEST(WorkspaceLimitsTest, intersectingSpheresAreProjectedWithDykstra){
+    WorkspaceLimits limits;
+    WorkspaceConstraints constraints;
+    constraints.spheres.push_back(sphere(base::Vector3d(-0.5, 0, 0), 1.0, false));
+    constraints.spheres.push_back(sphere(base::Vector3d(0.5, 0, 0), 1.0, false));
+    ASSERT_TRUE(limits.configure(constraints));
+
+    // The closest feasible point of the lens is on the intersection circle of both spheres. The first Dykstra pass already
+    // yields a feasible position, which is still far from it
+    expectProjection(limits, base::Vector3d(0, 2, 0), base::Vector3d(0, sqrt(0.75), 0), 1e-3);
+
+    // Sphere and half space
+    constraints.spheres.pop_back();
+    constraints.halfspaces.push_back(halfspace(base::Vector3d::UnitZ(), 0.5));
+    ASSERT_TRUE(limits.configure(constraints));
+    expectProjection(limits, base::Vector3d(-0.5, 0, 2), base::Vector3d(-0.5, 0, 0.5), 1e-5);
+}
+
+TEST(WorkspaceLimitsTest, positionIsPushedOutOfKeepOutSpheres){
+    WorkspaceLimits limits;
+    WorkspaceConstraints constraints;
+    constraints.spheres.push_back(sphere(base::Vector3d::Zero(), 1.0, true));
+    ASSERT_TRUE(limits.configure(constraints));
+
+    EXPECT_FALSE(limits.contains(base::Vector3d(0.5, 0, 0)));
+    EXPECT_TRUE(limits.contains(base::Vector3d(1.5, 0, 0)));
+    expectProjection(limits, base::Vector3d(0.5, 0, 0), base::Vector3d(1, 0, 0), 1e-12);
+    expectProjection(limits, base::Vector3d(0, -0.3, 0.4), base::Vector3d(0, -0.6, 0.8), 1e-12);
+
+    // Keep-out sphere at the border of a box: Pushed out of the sphere and projected back into the box
+    constraints.halfspaces.push_back(halfspace(base::Vector3d::UnitX(), 1.0));
+    constraints.spheres[0].center = base::Vector3d(1, 0, 0);
+    constraints.spheres[0].radius = 0.5;
+    ASSERT_TRUE(limits.configure(constraints));
+    base::Vector3d q(0.9, 0.1, 0);
+    ASSERT_TRUE(limits.project(q));
+    EXPECT_TRUE(limits.contains(q));
+    EXPECT_LE(q.x(), 1.0 + constraints.tolerance);
+    EXPECT_GE((q - constraints.spheres[0].center).norm(), 0.5 - constraints.tolerance);
+}
+
+TEST(WorkspaceLimitsTest, positionsThatCannotBeProjectedAreRejected){
+    WorkspaceLimits limits;
+    WorkspaceConstraints constraints;
+    constraints.spheres.push_back(sphere(base::Vector3d(1, 2, 3), 1.0, true));
+    ASSERT_TRUE(limits.configure(constraints));
+
+    // At the center of a keep-out sphere, the direction is undefined. The position is not modified
+    base::Vector3d p(1, 2, 3);
+    EXPECT_FALSE(limits.project(p));
+    EXPECT_EQ(base::Vector3d(1, 2, 3), p);
+    p = base::Vector3d(base::NaN<double>(), 0, 0);
+    EXPECT_FALSE(limits.project(p));
+
+    // Constraints without intersection
+    constraints.spheres.clear();
+    constraints.halfspaces.push_back(halfspace(base::Vector3d::UnitX(), 0.0));
+    constraints.halfspaces.push_back(halfspace(-base::Vector3d::UnitX(), -1.0));
+    ASSERT_TRUE(limits.configure(constraints));
+    p = base::Vector3d(0.5, 0, 0);
+    EXPECT_FALSE(limits.project(p));
+    EXPECT_EQ(base::Vector3d(0.5, 0, 0), p);
+}
+
+}
@@ -0,0 +1,140 @@
+/** Replays a recorded worst case of the OTG cycle (WCETRecord::input, see wcet_tracking property) outside of the component: The input is
+ *  converted back to the RML types (inputParams2RmlTypes()) and passed to a freshly created OTG backend, so that each repetition computes
+ *  the trajectory from scratch like the recorded cycle. Prints the result value and the mean and max. computation time.
+ *
+ *  The input file contains one line per field of ReflexxesInputParameters: The field name followed by its values, separated by whitespace,
+ *  e.g. "current_position_vector 0.1 -0.3 nan". scripts/fuzz_wcet.rb --replay writes these files from the saved seeds.
+ *
+ *  Usage: wcet_replay <position|velocity> <reflexxes|scurve> <ignore|prevent> <synchronization behavior> <cycle time> <input file> [repetitions]
+ *         The synchronization behavior is the numeric value of RMLFlags::SyncBehaviorEnum, "prevent" selects POSITIONAL_LIMITS_ACTIVELY_PREVENT*/
+
+#include "BenchmarkTimer.hpp"
+#include <OTGBackend.hpp>
+#include <OTGMode.hpp>
+#include <Conversions.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace trajectory_generation;
+
+namespace{
+
+/** Read the fields of the input file. Values are parsed with strtod, so that nan and inf are accepted*/
+bool readInput(const char* file, std::map<std::string, std::vector<double> >& fields){
+    std::ifstream stream(file);
+    if(!stream){
+        printf("Cannot open %s\n", file);
+        return false;
+    }
+    std::string line;
+    while(std::getline(stream, line)){
+        std::istringstream tokens(line);
+        std::string name, token;
+        if(!(tokens >> name))
+            continue;
+        std::vector<double>& values = fields[name];
+        while(tokens >> token)
+            values.push_back(strtod(token.c_str(), 0));
+    }
+    return true;
+}
+
+bool toInputParams(const std::map<std::string, std::vector<double> >& fields, ReflexxesInputParameters& input){
+    std::map<std::string, std::vector<double> >::const_iterator it = fields.find("current_position_vector");
+    if(it == fields.end() || it->second.empty()){
+        printf("Input does not contain the current position\n");
+        return false;
+    }
+    const size_t n_dof = it->second.size();
+    input = ReflexxesInputParameters(n_dof);
+
+    std::vector<double>* vectors[] = {&input.current_position_vector, &input.current_velocity_vector, &input.current_acceleration_vector,
+                                      &input.max_position_vector, &input.min_position_vector, &input.max_velocity_vector,
+                                      &input.max_acceleration_vector, &input.max_jerk_vector, &input.target_position_vector,
+                                      &input.target_velocity_vector};
+    const char* vector_names[] = {"current_position_vector", "current_velocity_vector", "current_acceleration_vector", "max_position_vector",
+                                  "min_position_vector", "max_velocity_vector", "max_acceleration_vector", "max_jerk_vector",
+                                  "target_position_vector", "target_velocity_vector"};
+    for(size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++){
+        it = fields.find(vector_names[i]);
+        if(it == fields.end())
+            continue;
+        if(it->second.size() != n_dof){
+            printf("%s has %i entries, but the current position has %i\n", vector_names[i], (int)it->second.size(), (int)n_dof);
+            return false;
+        }
+        *vectors[i] = it->second;
+    }
+    it = fields.find("selection_vector");
+    for(size_t i = 0; i < n_dof; i++)
+        input.selection_vector[i] = it == fields.end() || (i < it->second.size() && it->second[i] != 0);
+    it = fields.find("min_synchronization_time");
+    if(it != fields.end() && !it->second.empty())
+        input.min_synchronization_time = it->second[0];
+    it = fields.find("override_value");
+    if(it != fields.end() && !it->second.empty())
+        input.override_value = it->second[0];
+    return true;
+}
+
+template<class Mode> int replay(const ReflexxesInputParameters& input, const OTGBackendType backend_type, const PositionalLimitsBehavior limits_behavior,
+                                const int sync_behavior, const double cycle_time, const unsigned int repetitions){
+    const size_t n_dof = input.current_position_vector.size();
+    typename Mode::InputParameters in(n_dof);
+    typename Mode::OutputParameters out(n_dof);
+    typename Mode::Flags flags;
+    flags.SynchronizationBehavior = sync_behavior;
+#ifdef USING_REFLEXXES_TYPE_IV
+    flags.PositionalLimitsBehavior = limits_behavior;
+#endif
+    inputParams2RmlTypes(input, in);
+
+    std::vector<double> min_position(n_dof), max_position(n_dof);
+    for(size_t i = 0; i < n_dof; i++){
+        min_position[i] = base::isNaN(input.min_position_vector[i]) ? -base::infinity<double>() : input.min_position_vector[i];
+        max_position[i] = base::isNaN(input.max_position_vector[i]) ?  base::infinity<double>() : input.max_position_vector[i];
+    }
+
+    BenchmarkStats stats;
+    int result = RML_NOT_INITIALIZED;
+    for(unsigned int k = 0; k < repetitions; k++){
+        // A new backend per repetition, so that the trajectory is always computed from scratch (unchanged input is not recomputed)
+        OTGBackend* backend = createOTGBackend(backend_type, n_dof, cycle_time);
+        backend->setPositionLimits(min_position, max_position, limits_behavior);
+        BenchmarkTimer timer;
+        result = Mode::run(*backend, in, out, flags);
+        stats.add(timer.elapsed());
+        delete backend;
+    }
+    printf("result %i mean %f ms max %f ms\n", result, stats.mean() * 1e3, stats.max * 1e3);
+    return 0;
+}
+
+}
+
+int main(int argc, char** argv){
+    if(argc < 7){
+        printf("Usage: %s <position|velocity> <reflexxes|scurve> <ignore|prevent> <synchronization behavior> <cycle time> <input file> [repetitions]\n", argv[0]);
+        return 1;
+    }
+    const bool position_based = strcmp(argv[1], "position") == 0;
+    const OTGBackendType backend_type = strcmp(argv[2], "scurve") == 0 ? OTG_BACKEND_SCURVE : OTG_BACKEND_REFLEXXES;
+    const PositionalLimitsBehavior limits_behavior = strcmp(argv[3], "prevent") == 0 ? POSITIONAL_LIMITS_ACTIVELY_PREVENT : POSITIONAL_LIMITS_IGNORE;
+    const int sync_behavior = atoi(argv[4]);
+    const double cycle_time = atof(argv[5]);
+    const unsigned int repetitions = argc > 7 ? atoi(argv[7]) : 100;
+
+    std::map<std::string, std::vector<double> > fields;
+    ReflexxesInputParameters input;
+    if(!readInput(argv[6], fields) || !toInputParams(fields, input))
+        return 1;
+    if(position_based)
+        return replay<PositionMode>(input, backend_type, limits_behavior, sync_behavior, cycle_time, repetitions);
+    return replay<VelocityMode>(input, backend_type, limits_behavior, sync_behavior, cycle_time, repetitions);
+}
@@ -2,7 +2,11 @@
 #define trajectory_generation_TYPES_HPP
 
 #include <vector>
+#include <string>
+#include <stdint.h>
 #include <base/Float.hpp>
+#include <base/Time.hpp>
+#include <base/Eigen.hpp>
 
 namespace trajectory_generation {
 
@@ -13,6 +17,12 @@ enum PositionalLimitsBehavior{
     POSITIONAL_LIMITS_ACTIVELY_PREVENT /** Reflexxes will make a smooth transition at the bounds and prevent exceededing them*/
 };
 
+/** Online trajectory generation algorithm used by the RML tasks*/
+enum OTGBackendType{
+    OTG_BACKEND_REFLEXXES, /** Reflexxes Motion Libraries (Type II or Type IV, depending on which version is linked)*/
+    OTG_BACKEND_SCURVE     /** Built-in jerk-limited S-curve generator. Supports position limits without Reflexxes Type IV*/
+};
+
 /** Result values of the Online Trajectory Generation algorithm. See reflexxes/ReflexxesAPI.h for further details*/
 enum ReflexxesResultValue{
     RML_WORKING	                            =  0,   /** The Online Trajectory Generation algorithm is working; the final state of motion has not been reached yet.*/
@@ -32,6 +42,248 @@ enum ReflexxesResultValue{
     RML_NOT_INITIALIZED                     = -200  /** RML has never been called*/
 };
 
+/** Result of the validation of an input sample (current state or target)*/
+enum ValidationStatus{
+    VALIDATION_OK,
+    VALIDATION_INVALID_SIZE,        /** Number of names and elements of the sample do not match*/
+    VALIDATION_UNKNOWN_NAME,        /** Element of the sample has not been configured in the motion constraints*/
+    VALIDATION_MISSING_ELEMENT,     /** Element has been configured in the motion constraints, but is missing in the sample*/
+    VALIDATION_INVALID_POSITION,    /** Position (or orientation) entry is NaN*/
+    VALIDATION_INVALID_SPEED,       /** Speed entry is NaN*/
+    VALIDATION_POSITION_LIMITS,     /** Position is outside of the position limits*/
+    VALIDATION_INVALID_MAX_SPEED,   /** Max. speed of the given motion constraint is invalid (<= 0 or NaN)*/
+    VALIDATION_INVALID_MAX_ACCELERATION, /** Max. acceleration of the given motion constraint is invalid (<= 0 or NaN)*/
+    VALIDATION_INVALID_MAX_JERK,    /** Max. jerk of the given motion constraint is invalid (<= 0 or NaN)*/
+    VALIDATION_INVALID_POSITION_LIMITS, /** Min. position of the given motion constraint is not smaller than max. position*/
+    VALIDATION_WORKSPACE_LIMITS,    /** Target position cannot be projected onto the Cartesian workspace*/
+    VALIDATION_INVALID_DERATING_FACTOR, /** Derating factor is not within (0,1] or NaN*/
+    VALIDATION_NOT_CONFIGURED,      /** The receiver has not been configured yet*/
+    VALIDATION_CONFLICTING_TARGETS  /** Both target ports have data, but neither target arbitration nor target merging is enabled*/
+};
+
+/** State of the requested arrival time (deadline) of the current motion*/
+enum DeadlineState{
+    DEADLINE_NONE,       /** No deadline is active, e.g. because it has been cleared or its target has been replaced*/
+    DEADLINE_FEASIBLE,   /** The target will be reached at the deadline*/
+    DEADLINE_INFEASIBLE, /** The target cannot be reached until the deadline under the current motion constraints. The motion is time-optimal instead*/
+    DEADLINE_MISSED,     /** The deadline has passed before the target has been reached. The deadline has been dropped*/
+    DEADLINE_REACHED,    /** The target has been reached at the deadline. The deadline has been dropped*/
+    DEADLINE_REJECTED    /** The deadline cannot be applied (velocity based task or sync group configured)*/
+};
+
+/** Status of the requested arrival time of the current motion*/
+struct DeadlineStatus{
+    base::Time time;             /** Time of the evaluation*/
+    base::Time arrival_time;     /** Requested arrival time*/
+    base::Time expected_arrival; /** Time at which the target will be reached according to the current trajectory*/
+    double slack;                /** Requested minus expected arrival time in seconds. Negative if the target will be reached too late*/
+    DeadlineState state;
+    DeadlineStatus() : slack(base::NaN<double>()), state(DEADLINE_NONE){}
+};
+
+/** Description of an input sample that has been rejected*/
+struct InputValidationError{
+    base::Time time;          /** Time at which the sample has been rejected*/
+    std::string port;         /** Name of the input port on which the sample has been received*/
+    ValidationStatus status;  /** Reason for the rejection. Determines the field of the sample that is invalid*/
+    std::string name;         /** Name of the offending element, i.e. joint name or Cartesian DOF (x,y,z,yaw,pitch,roll)*/
+    double value;             /** Offending value*/
+    InputValidationError() : status(VALIDATION_OK), value(base::NaN<double>()){}
+};
+
+/** Configuration of the continuous state feedback. If enabled, every new measured state is fused into the interpolator state,
+ *  not only the first one.*/
+struct StateFeedbackConfig{
+    bool enabled;             /** Enable continuous state feedback*/
+    double position_gain;     /** Blending factor in [0,1] for the position: 0 ignores the measurement, 1 replaces the interpolator position*/
+    double velocity_gain;     /** Blending factor in [0,1] for velocity and acceleration. Only applied to elements with valid measured speed*/
+    double deadband;          /** Position deviations smaller than this are not corrected, e.g. to ignore sensor noise*/
+    double latency;           /** Additional delay in seconds between the measurement and its timestamp, e.g. bus latency*/
+    double max_extrapolation; /** Measurements older than this (in seconds, including latency) are ignored*/
+    StateFeedbackConfig() : enabled(false), position_gain(1.0), velocity_gain(0.0), deadband(0.0), latency(0.0), max_extrapolation(0.1){}
+};
+
+/** Input ports of a joint space task that can provide the target*/
+enum TargetSource{
+    TARGET_SOURCE_NONE,               /** No source is active*/
+    TARGET_SOURCE_TARGET,             /** target port*/
+    TARGET_SOURCE_CONSTRAINED_TARGET  /** constrained_target port*/
+};
+
+/** Configuration of the arbitration between the target and constrained_target ports. In each cycle, the source with the highest
+ *  priority that has received a sample within its timeout is active, only its samples are applied.*/
+struct TargetArbitrationConfig{
+    bool enabled;                       /** Enable the arbitration. Otherwise only one of the two ports may be used*/
+    int target_priority;                /** Priority of the target port. Higher value wins, on equal priority the active source is kept*/
+    int constrained_target_priority;    /** Priority of the constrained_target port*/
+    double target_timeout;              /** The target port is inactive if its last sample is older than this (seconds). Must be positive and finite*/
+    double constrained_target_timeout;  /** Same for the constrained_target port*/
+    TargetArbitrationConfig() : enabled(false), target_priority(0), constrained_target_priority(1),
+        target_timeout(0.1), constrained_target_timeout(0.1){}
+};
+
+/** State of the target arbitration*/
+struct TargetArbitrationStatus{
+    base::Time time;
+    TargetSource active_source;         /** Source whose samples are currently applied*/
+    TargetSource previous_source;       /** Source that was active before the last handover*/
+    uint64_t handovers;                 /** Number of changes of the active source since configuration*/
+    TargetArbitrationStatus() : active_source(TARGET_SOURCE_NONE), previous_source(TARGET_SOURCE_NONE), handovers(0){}
+};
+
+/** Configuration of the trajectory cache. Memory for size * max_samples * 3 * n_dof values is allocated at configuration time*/
+struct TrajectoryCacheConfig{
+    unsigned int size;        /** Max. number of cached trajectories. 0 disables the cache*/
+    unsigned int max_samples; /** Max. number of cycles per cached trajectory. Longer trajectories are not cached*/
+    double quantization;      /** Resolution used to compare target positions and velocities. Start states, constraints and limits have to match exactly*/
+    TrajectoryCacheConfig() : size(0), max_samples(1000), quantization(1e-6){}
+};
+
+/** Configuration of the warm-up phase, which avoids latency spikes in the first cycles after start*/
+struct WarmUpConfig{
+    unsigned int cycles; /** Number of dummy OTG cycles that are run in startHook() on the configured motion constraints. 0 disables the dummy cycles*/
+    bool lock_memory;    /** Lock all current and future pages of the process into RAM (mlockall) in configureHook(). Affects the whole process
+                             and requires the CAP_IPC_LOCK capability or a sufficient RLIMIT_MEMLOCK. The pages are unlocked again (munlockall,
+                             also process wide) in cleanupHook()*/
+    WarmUpConfig() : cycles(0), lock_memory(false){}
+};
+
+/** Configuration of the online derating of the motion constraints*/
+struct DeratingConfig{
+    double time_constant; /** Time constant in seconds of the first-order filter that smoothes incoming derating factors. 0 applies new factors immediately*/
+    double min_factor;    /** Lower bound of the applied factors, so that the motion constraints never drop to zero*/
+    double resolution;    /** Changes of the smoothed factor smaller than this do not update the motion constraints*/
+    DeratingConfig() : time_constant(0.5), min_factor(0.1), resolution(1e-3){}
+};
+
+/** Derating factors for the max. speed, acceleration and jerk of individual elements, e.g. computed from drive temperature or current*/
+struct DeratingFactors{
+    base::Time time;
+    std::vector<std::string> names; /** Element names. Have to be a subset of the names in the motion_constraints property*/
+    std::vector<double> factors;    /** Scale factors in (0,1]. 1 means no derating*/
+};
+
+/** Behavior if the OTG algorithm returns an error*/
+enum OTGFallbackMode{
+    OTG_FALLBACK_NONE,        /** No fallback, the task goes into the RML_ERROR state*/
+    OTG_FALLBACK_INDEPENDENT, /** Move each element independently (without synchronization) towards its target using the built-in S-curve generator.
+                                  If this fails as well, perform a controlled stop*/
+    OTG_FALLBACK_STOP         /** Controlled stop: Decelerate all elements to zero speed within the max. acceleration and jerk (built-in S-curve generator)*/
+};
+
+/** Status of the fallback stage, which keeps generating commands if the OTG algorithm fails*/
+struct OTGFallbackStatus{
+    base::Time time;
+    bool active;                 /** True if the command of the current cycle has been generated by the fallback*/
+    OTGFallbackMode mode;        /** Fallback that generated the command of the current cycle, OTG_FALLBACK_NONE if not active*/
+    ReflexxesResultValue error;  /** Result of the OTG algorithm that triggered the fallback the last time*/
+    uint64_t activations;        /** Number of transitions from normal operation to the fallback*/
+    uint64_t fallback_cycles;    /** Number of cycles in which the command has been generated by the fallback*/
+    uint64_t cycles;             /** Total number of OTG cycles*/
+    double fallback_rate;        /** fallback_cycles / cycles*/
+    OTGFallbackStatus() : active(false), mode(OTG_FALLBACK_NONE), error(RML_NOT_INITIALIZED), activations(0), fallback_cycles(0), cycles(0), fallback_rate(0){}
+};
+
+/** Dynamic model of the simulated plant (see PlantSimulationTask)*/
+enum PlantModelType{
+    PLANT_IDEAL,              /** The plant follows the commanded position exactly*/
+    PLANT_FIRST_ORDER_LAG,    /** The plant position follows the commanded position with a first-order lag*/
+    PLANT_SATURATING,         /** The plant follows the commanded position, but its speed is limited*/
+    PLANT_COMPLIANT_OFFSET    /** The plant follows the commanded position plus a constant offset, e.g. a compliant robot held by a human*/
+};
+
+/** Configuration of the simulated plant*/
+struct PlantModelConfig{
+    PlantModelType type;
+    base::VectorXd initial_position; /** Initial joint positions of the plant. Empty means all zero*/
+    double time_constant;            /** PLANT_FIRST_ORDER_LAG only: Time constant in seconds*/
+    double max_speed;                /** PLANT_SATURATING only: Max. speed of all joints*/
+    base::VectorXd offset;           /** PLANT_COMPLIANT_OFFSET only: Position offset per joint*/
+    double offset_delay;             /** PLANT_COMPLIANT_OFFSET only: Time in seconds after the first command at which the offset is applied*/
+    PlantModelConfig() : type(PLANT_IDEAL), time_constant(0.1), max_speed(1.0), offset_delay(0.0){}
+};
+
+/** Results of the closed-loop plant simulation. Ratios are taken over all joints and cycles, values > 1 mean that the corresponding
+ *  limit has been violated*/
+struct PlantSimulationResult{
+    base::Time time;
+    uint64_t cycles;                   /** Number of evaluated commands*/
+    uint64_t violations;               /** Number of cycles in which any check failed (by more than the configured tolerance)*/
+    uint64_t position_limit_violations;/** Number of cycles in which a commanded position was outside of the position limits*/
+    double max_speed_ratio;            /** Max. |commanded speed| / max. speed*/
+    double max_acceleration_ratio;     /** Max. |commanded acceleration| / max. acceleration*/
+    double max_speed_step_ratio;       /** Max. change of the commanded speed between two cycles / (max. acceleration * cycle time). Measures the continuity of the speed*/
+    double max_position_step_error;    /** Max. deviation of the commanded position change from the integrated commanded speed. Measures the continuity of the position*/
+    double max_jerk_ratio;             /** Max. change of the commanded acceleration between two cycles / (max. jerk * cycle time). Measures the continuity of the acceleration*/
+    double max_tracking_error;         /** Max. |commanded position - plant position|, i.e. the windup of the interpolator w.r.t. the plant*/
+    double mean_computation_time;      /** Mean computation time of the interpolator in seconds*/
+    double max_computation_time;       /** Max. computation time of the interpolator in seconds*/
+    PlantSimulationResult() : cycles(0), violations(0), position_limit_violations(0), max_speed_ratio(0), max_acceleration_ratio(0), max_speed_step_ratio(0),
+        max_position_step_error(0), max_jerk_ratio(0), max_tracking_error(0), mean_computation_time(0), max_computation_time(0){}
+};
+
+/** Statistics of the trajectory cache*/
+struct TrajectoryCacheStats{
+    base::Time time;
+    uint64_t hits;      /** Number of new motions that have been played back from the cache*/
+    uint64_t misses;    /** Number of new motions that had to be calculated*/
+    uint64_t evictions; /** Number of cached trajectories that have been replaced*/
+    uint64_t entries;   /** Number of cached trajectories*/
+    double hit_rate;    /** hits / (hits + misses)*/
+    TrajectoryCacheStats() : hits(0), misses(0), evictions(0), entries(0), hit_rate(0){}
+};
+
+/** Half space of the Cartesian workspace. Feasible positions p fulfill normal.dot(p) <= offset*/
+struct WorkspaceHalfspace{
+    base::Vector3d normal;
+    double offset;
+};
+
+/** Spherical region of the Cartesian workspace*/
+struct WorkspaceSphere{
+    base::Vector3d center;
+    double radius;
+    bool keep_out;  /** If true, positions inside the sphere are infeasible (e.g. around the robot base). Otherwise positions outside are infeasible*/
+};
+
+/** Constraints on the target position of Cartesian tasks. The feasible workspace is the intersection of all half spaces and
+ *  spheres. The half spaces describe a convex polytope, e.g. a box with 6 half spaces. Orientations are not constrained.*/
+struct WorkspaceConstraints{
+    std::vector<WorkspaceHalfspace> halfspaces;
+    std::vector<WorkspaceSphere> spheres;
+    double tolerance;             /** Constraint violations smaller than this are ignored. Must be positive*/
+    unsigned int max_iterations;  /** Max. number of passes over all constraints for the projection onto intersecting constraints*/
+    WorkspaceConstraints() : tolerance(1e-6), max_iterations(100){}
+};
+
+/** Statistics of the name layout cache of an input port*/
+struct NameLayoutStats{
+    base::Time time;
+    uint64_t hits;    /** Number of samples with unchanged name layout, i.e. the cached mapping could be reused*/
+    uint64_t misses;  /** Number of samples with new name layout, i.e. the mapping had to be recomputed by name search*/
+    NameLayoutStats() : hits(0), misses(0){}
+};
+
+/** Elements that violated or have been modified at their position limits by the last limit handling (initial state check,
+ *  target cropping, velocity zeroing at the limits), see ViolationMask in LimitKernels.hpp*/
+struct LimitViolations{
+    base::Time time;
+    std::vector<std::string> names; /** Element names, in the order of the motion_constraints property*/
+    std::vector<uint8_t> violated;  /** 1 if the element violated or has been modified at its limits, 0 otherwise. Same order as names*/
+    uint32_t count;                 /** Number of violating elements*/
+    LimitViolations() : count(0){}
+};
+
+/** Result of the evaluation of a single candidate target, see the evaluateTargets operation*/
+struct TargetEvaluation{
+    bool feasible;                /** True if the target is valid and can be reached without violating the motion constraints*/
+    double execution_time;        /** Time in seconds to reach the target from the current interpolator state. NaN if not feasible*/
+    ReflexxesResultValue result;  /** Result of the OTG algorithm for this target*/
+    ValidationStatus validation;  /** Result of the target validation, VALIDATION_POSITION_LIMITS if a target position is beyond the position limits
+                                   *  (unless POSITIONAL_LIMITS_IGNORE). If not VALIDATION_OK, the OTG algorithm has not been called*/
+    TargetEvaluation() : feasible(false), execution_time(base::NaN<double>()), result(RML_NOT_INITIALIZED), validation(VALIDATION_OK){}
+};
+
 /** Debug: Input parameters of the reflexxes OTG algorithm*/
 struct ReflexxesInputParameters{
     ReflexxesInputParameters(){}
@@ -65,6 +317,65 @@ struct ReflexxesInputParameters{
     double override_value; /** only reflexxes typeIV*/
 };
 
+/** Special cases of an OTG cycle, which distinguish the code paths of the worst-case execution time statistics. The path of a cycle is
+ *  the combination (bitwise or) of all cases that apply*/
+enum WCETPathFlags{
+    WCET_NEW_TARGET      = 1,  /** A new target has been accepted, i.e. the trajectory is recalculated*/
+    WCET_POSITION_LIMITS = 2,  /** Elements have been cropped or modified at their position limits (Type IV)*/
+    WCET_SYNCHRONIZATION = 4,  /** The motion is stretched via MinimumSynchronizationTime (sync group, deadline or mixed mode synchronization)*/
+    WCET_DERATING        = 8,  /** The motion constraints have been updated by the derating*/
+    WCET_FALLBACK        = 16, /** The OTG algorithm failed and the command has been generated by the fallback*/
+    WCET_ERROR           = 32  /** The OTG algorithm failed without fallback*/
+};
+
+/** Worst case of one code path of the OTG cycle*/
+struct WCETRecord{
+    std::string path;                /** Names of the special cases of this path separated by '+', e.g. "new_target+position_limits". "steady" if none applies*/
+    uint64_t cycles;                 /** Number of cycles on this path*/
+    double max_computation_time;     /** Worst-case computation time of a cycle on this path in seconds*/
+    base::Time time;                 /** Time stamp of the worst-case cycle*/
+    ReflexxesResultValue result;     /** Result of the OTG algorithm in the worst-case cycle*/
+    ReflexxesInputParameters input;  /** Input of the OTG algorithm in the worst-case cycle, before the step. Can be used as regression seed*/
+    WCETRecord() : cycles(0), max_computation_time(0), result(RML_NOT_INITIALIZED){}
+};
+
+/** Worst-case execution time statistics of the OTG cycle*/
+struct WCETStats{
+    base::Time time;
+    double max_computation_time;      /** Worst-case computation time over all paths in seconds*/
+    std::vector<WCETRecord> paths;    /** All paths, indexed by the combination of WCETPathFlags. Paths that have not been run have 0 cycles*/
+    WCETStats() : max_computation_time(0){}
+};
+
+/** Stages of the OTG cycle, in the order in which they are run*/
+enum CycleStage{
+    STAGE_CURRENT_STATE,     /** Read and convert the current state*/
+    STAGE_TARGET,            /** Read, validate and convert the target*/
+    STAGE_CONSTRAINTS,       /** Derating, synchronization group and deadline*/
+    STAGE_OTG,               /** OTG algorithm incl. fallback and result handling*/
+    STAGE_MONITORING,        /** Deadline evaluation, trajectory cache statistics and query snapshot*/
+    STAGE_WRITE_COMMAND,     /** Conversion and output of the command and the shared memory command*/
+    STAGE_DEBUG_OUTPUT,      /** Conversion and output of the RML input/output parameters*/
+    NUMBER_OF_CYCLE_STAGES
+};
+
+/** Timing of one stage of the OTG cycle*/
+struct CycleTraceStage{
+    std::string name;   /** Name of the stage, e.g. "otg"*/
+    double start;       /** Start of the stage relative to the start of the cycle in seconds. NaN if the stage has not been run in this cycle*/
+    double duration;    /** Duration of the stage in seconds. 0 if the stage has not been run in this cycle*/
+    CycleTraceStage() : start(base::NaN<double>()), duration(0){}
+};
+
+/** Per-stage timing of one OTG cycle, see the cycle_tracing property. Stage times are measured on the monotonic clock*/
+struct CycleTrace{
+    base::Time time;                       /** Time stamp of the cycle (simulated clock if enabled)*/
+    base::Time start_time;                 /** Start of the cycle on the system clock*/
+    double duration;                       /** Duration of the whole cycle in seconds*/
+    std::vector<CycleTraceStage> stages;   /** Indexed by CycleStage*/
+    CycleTrace() : duration(0){}
+};
+
 /** Debug: Output parameters of the reflexxes OTG algorithm*/
 struct ReflexxesOutputParameters{
     ReflexxesOutputParameters(){}